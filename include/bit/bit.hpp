@@ -1,5 +1,12 @@
 /**
  * @brief  Bitwise Operations
+ * @note   nlz, ntz, popcount, pext, pdep, byteswapは定数式では移植可能な実装で評価し、
+ *         実行時はコンパイルオプションで有効な命令(lzcnt, tzcnt, popcnt, BMI2)か
+ *         コンパイラの組み込み関数を使います
+ * @note   popcount, pext, pdepは-mpopcnt, -mbmi2が無くても、x86では起動後に
+ *         cpu::current()で検出した命令を関数ポインタ(cpu::dispatcher)経由で使います。
+ *         この場合は呼び出しがインライン展開されないので、ループで多数の値を処理するときは
+ *         bit/bulk.hppやbit/space_filling_curve.hppの配列版を使ってください
  * @note   Reference URL: https://en.wikipedia.org/wiki/Circular_shift
  */
 
@@ -14,11 +21,21 @@
 // Include files
 // ********************************************************************************
 
+#include "cpu/cpu_features.hpp"
 #include <climits>
+#include <cstddef>
 #include <cstdint>
-#include <numeric>
+#include <limits>
 #include <type_traits>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+#define BIT_RUNTIME_DISPATCH 1
+#endif
+
 // ********************************************************************************
 // Begin of namespace
 // ********************************************************************************
@@ -29,26 +46,410 @@ namespace bit {
 // 関数の定義
 // ********************************************************************************
 
+namespace detail {
+
+/**< @brief 符号なし整数型Integerのビット幅 */
+template <typename Integer>
+inline constexpr std::int32_t digits = std::numeric_limits<Integer>::digits;
+
+/**< @brief nlzの移植可能な実装(二分探索) */
+template <typename Integer> constexpr std::int32_t nlz_portable(Integer v) {
+  if (v == 0) {
+    return digits<Integer>;
+  }
+  std::int32_t n = 0;
+  for (std::int32_t s = digits<Integer> / 2; s > 0; s >>= 1) {
+    if ((v >> (digits<Integer> - s)) == 0) { // 上位sビットが全てゼロ
+      v = static_cast<Integer>(v << s);
+      n += s;
+    }
+  }
+  return n;
+}
+
+/**< @brief ntzの移植可能な実装(二分探索) */
+template <typename Integer> constexpr std::int32_t ntz_portable(Integer v) {
+  if (v == 0) {
+    return digits<Integer>;
+  }
+  std::int32_t n = 0;
+  for (std::int32_t s = digits<Integer> / 2; s > 0; s >>= 1) {
+    if ((v & ((Integer(1) << s) - 1)) == 0) { // 下位sビットが全てゼロ
+      v = static_cast<Integer>(v >> s);
+      n += s;
+    }
+  }
+  return n;
+}
+
+/**< @brief popcountの移植可能な実装(SWAR) */
+template <typename Integer>
+constexpr std::int32_t popcount_portable(Integer v) {
+  std::uint64_t x = v;
+  x = x - ((x >> 1) & 0x5555555555555555);
+  x = (x & 0x3333333333333333) + ((x >> 2) & 0x3333333333333333);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0f;
+  return static_cast<std::int32_t>((x * 0x0101010101010101) >> 56);
+}
+
+/**< @brief pextの移植可能な実装(maskの立っているビットを1つずつ調べる) */
+template <typename Integer>
+constexpr Integer pext_portable(Integer x, Integer mask) {
+  Integer r = 0;
+  for (Integer b = 1; mask != 0; b = static_cast<Integer>(b << 1)) {
+    const Integer low = static_cast<Integer>(mask & (0 - mask));
+    if ((x & low) != 0) {
+      r |= b;
+    }
+    mask = static_cast<Integer>(mask & (mask - 1));
+  }
+  return r;
+}
+
+/**< @brief pdepの移植可能な実装(maskの立っているビットを1つずつ調べる) */
+template <typename Integer>
+constexpr Integer pdep_portable(Integer x, Integer mask) {
+  Integer r = 0;
+  for (Integer b = 1; mask != 0; b = static_cast<Integer>(b << 1)) {
+    const Integer low = static_cast<Integer>(mask & (0 - mask));
+    if ((x & b) != 0) {
+      r |= low;
+    }
+    mask = static_cast<Integer>(mask & (mask - 1));
+  }
+  return r;
+}
+
+/**< @brief byteswapの移植可能な実装 */
+template <typename Integer> constexpr Integer byteswap_portable(Integer v) {
+  Integer r = 0;
+  for (std::size_t i = 0; i < sizeof(Integer); i++) {
+    r = static_cast<Integer>((r << 8) | ((v >> (i * 8)) & 0xff));
+  }
+  return r;
+}
+
+/**< @brief popcountのコンパイラの組み込み関数による実装 */
+template <typename Integer> std::int32_t popcount_builtin(Integer v) {
+#if defined(__GNUC__)
+  if constexpr (digits<Integer> <= 32) {
+    return __builtin_popcount(v);
+  } else {
+    return __builtin_popcountll(v);
+  }
+#else
+  return popcount_portable(v);
+#endif
+}
+
+/**< @brief pext, pdepの実行時の移植可能な実装(関数ポインタにするため) */
+template <typename Integer> Integer pext_generic(Integer x, Integer mask) {
+  return pext_portable(x, mask);
+}
+template <typename Integer> Integer pdep_generic(Integer x, Integer mask) {
+  return pdep_portable(x, mask);
+}
+
+#if defined(BIT_RUNTIME_DISPATCH)
+
+/**< @brief popcountのpopcnt命令による実装 */
+template <typename Integer>
+CPU_TARGET("popcnt")
+std::int32_t popcount_popcnt(Integer v) {
+  if constexpr (digits<Integer> <= 32) {
+    return _mm_popcnt_u32(v);
+  } else {
+    return static_cast<std::int32_t>(_mm_popcnt_u64(v));
+  }
+}
+
+/**< @brief pextのBMI2による実装 */
+template <typename Integer>
+CPU_TARGET("bmi2")
+Integer pext_bmi2(Integer x, Integer mask) {
+  if constexpr (digits<Integer> <= 32) {
+    return static_cast<Integer>(_pext_u32(x, mask));
+  } else {
+    return static_cast<Integer>(_pext_u64(x, mask));
+  }
+}
+
+/**< @brief pdepのBMI2による実装 */
+template <typename Integer>
+CPU_TARGET("bmi2")
+Integer pdep_bmi2(Integer x, Integer mask) {
+  if constexpr (digits<Integer> <= 32) {
+    return static_cast<Integer>(_pdep_u32(x, mask));
+  } else {
+    return static_cast<Integer>(_pdep_u64(x, mask));
+  }
+}
+
+#endif
+
+/**< @brief 実行時にpopcnt命令の有無でpopcountの実装を選ぶ */
+template <typename Integer> std::int32_t popcount_dispatch(Integer v) {
+  static const cpu::dispatcher<std::int32_t(Integer)> f = {
+#if defined(BIT_RUNTIME_DISPATCH)
+      {cpu::popcnt, popcount_popcnt<Integer>},
+#endif
+      {cpu::none, popcount_builtin<Integer>}};
+  return f(v);
+}
+
+/**< @brief 実行時にBMI2の有無でpextの実装を選ぶ */
+template <typename Integer> Integer pext_dispatch(Integer x, Integer mask) {
+  static const cpu::dispatcher<Integer(Integer, Integer)> f = {
+#if defined(BIT_RUNTIME_DISPATCH)
+      {cpu::bmi2, pext_bmi2<Integer>},
+#endif
+      {cpu::none, pext_generic<Integer>}};
+  return f(x, mask);
+}
+
+/**< @brief 実行時にBMI2の有無でpdepの実装を選ぶ */
+template <typename Integer> Integer pdep_dispatch(Integer x, Integer mask) {
+  static const cpu::dispatcher<Integer(Integer, Integer)> f = {
+#if defined(BIT_RUNTIME_DISPATCH)
+      {cpu::bmi2, pdep_bmi2<Integer>},
+#endif
+      {cpu::none, pdep_generic<Integer>}};
+  return f(x, mask);
+}
+
+} // namespace detail
+
 /**
  * @brief  符号なし整数vの先頭から続くゼロの数を数える
- * @note   IEEE 754形式をサポートしているアーキテクチャにのみ対応
- * @note   エンディアンはリトル、ビッグどちらにも対応
- * @note   [Changing the active member of a union inside constexpr]
- * (http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2018/p1330r0.pdf)
+ * @note   定数式ではdetail::nlz_portableを使い、実行時はlzcnt命令(-mlzcnt)か
+ *         コンパイラの組み込み関数を使います
+ * @param  Integer v 符号なし整数v(8〜64ビット)
+ * @return vの先頭から続くゼロの数(v = 0のときはvのビット幅)
+ */
+template <typename Integer>
+  requires std::is_unsigned_v<Integer>
+constexpr std::int32_t nlz(Integer v) {
+  constexpr std::int32_t w = detail::digits<Integer>;
+  static_assert(w <= 64, "only supports integers up to 64 bits");
+  if (std::is_constant_evaluated()) {
+    return detail::nlz_portable(v);
+  }
+#if defined(__LZCNT__)
+  if constexpr (w <= 32) {
+    return static_cast<std::int32_t>(_lzcnt_u32(v)) - (32 - w);
+  } else {
+    return static_cast<std::int32_t>(_lzcnt_u64(v));
+  }
+#elif defined(__GNUC__)
+  if (v == 0) {
+    return w;
+  }
+  if constexpr (w <= 32) {
+    return __builtin_clz(v) - (32 - w);
+  } else {
+    return __builtin_clzll(v);
+  }
+#else
+  return detail::nlz_portable(v);
+#endif
+}
+
+/**
+ * @brief  32ビット符号なし整数vの先頭から続くゼロの数を数える
+ * @note   整数リテラルなど符号付きの値を渡したときは、こちらが呼ばれます
  * @param  std::uint32_t v 符号なし整数v
  * @return vの先頭から続くゼロの数
  */
-static inline std::int32_t nlz(std::uint32_t v) {
-  static_assert(
-      std::numeric_limits<double>::is_iec559,
-      "only support IEC 559 (IEEE 754) double precision floating point.");
-  union {
-    std::uint64_t asu64;
-    double asf64;
-  } u;
-  u.asf64 =
-      (double)v + 0.5; // 0は例外表現なので0.5(=1.0 * 2^(-1))を加算しておく
-  return 1054 - (u.asu64 >> 52); // 1054(=ゲタ(bias)の数+32-1) - vの指数部を返す
+constexpr std::int32_t nlz(std::uint32_t v) { return nlz<std::uint32_t>(v); }
+
+/**
+ * @brief  符号なし整数vの末尾から続くゼロの数を数える
+ * @note   定数式ではdetail::ntz_portableを使い、実行時はtzcnt命令(-mbmi)か
+ *         コンパイラの組み込み関数を使います
+ * @param  Integer v 符号なし整数v(8〜64ビット)
+ * @return vの末尾から続くゼロの数(v = 0のときはvのビット幅)
+ */
+template <typename Integer>
+  requires std::is_unsigned_v<Integer>
+constexpr std::int32_t ntz(Integer v) {
+  constexpr std::int32_t w = detail::digits<Integer>;
+  static_assert(w <= 64, "only supports integers up to 64 bits");
+  if (std::is_constant_evaluated()) {
+    return detail::ntz_portable(v);
+  }
+#if defined(__BMI__)
+  if constexpr (w <= 32) {
+    const std::int32_t n = static_cast<std::int32_t>(_tzcnt_u32(v));
+    return n < w ? n : w; // tzcnt(0)は32なので、8, 16ビットのときは幅に切り詰める
+  } else {
+    return static_cast<std::int32_t>(_tzcnt_u64(v));
+  }
+#elif defined(__GNUC__)
+  if (v == 0) {
+    return w;
+  }
+  if constexpr (w <= 32) {
+    return __builtin_ctz(v);
+  } else {
+    return __builtin_ctzll(v);
+  }
+#else
+  return detail::ntz_portable(v);
+#endif
+}
+
+/**
+ * @brief  符号なし整数vの立っているビットの数を数える(population count)
+ * @note   定数式ではdetail::popcount_portableを使い、実行時はpopcnt命令(-mpopcnt)か、
+ *         起動後に検出したpopcnt命令かコンパイラの組み込み関数を使います
+ * @param  Integer v 符号なし整数v(8〜64ビット)
+ * @return vの立っているビットの数
+ */
+template <typename Integer>
+  requires std::is_unsigned_v<Integer>
+constexpr std::int32_t popcount(Integer v) {
+  constexpr std::int32_t w = detail::digits<Integer>;
+  static_assert(w <= 64, "only supports integers up to 64 bits");
+  if (std::is_constant_evaluated()) {
+    return detail::popcount_portable(v);
+  }
+#if defined(__POPCNT__)
+  if constexpr (w <= 32) {
+    return _mm_popcnt_u32(v);
+  } else {
+    return static_cast<std::int32_t>(_mm_popcnt_u64(v));
+  }
+#elif defined(BIT_RUNTIME_DISPATCH)
+  return detail::popcount_dispatch(v);
+#else
+  return detail::popcount_builtin(v);
+#endif
+}
+
+/**
+ * @brief  符号なし整数vの2を底とする対数の整数部floor(lg v)を返す
+ * @param  Integer v 符号なし整数v
+ * @return floor(lg v)(v = 0のときは-1)
+ */
+template <typename Integer>
+  requires std::is_unsigned_v<Integer>
+constexpr std::int32_t log2(Integer v) {
+  return detail::digits<Integer> - 1 - nlz(v);
+}
+
+/**
+ * @brief  v以下で最大の2の冪を返す
+ * @param  Integer v 符号なし整数v
+ * @return v以下で最大の2の冪(v = 0のときは0)
+ */
+template <typename Integer>
+  requires std::is_unsigned_v<Integer>
+constexpr Integer bit_floor(Integer v) {
+  return v == 0 ? Integer(0) : static_cast<Integer>(Integer(1) << log2(v));
+}
+
+/**
+ * @brief  v以上で最小の2の冪を返す
+ * @note   結果がIntegerで表せないときの値は未定義です
+ * @param  Integer v 符号なし整数v
+ * @return v以上で最小の2の冪(v = 0のときは1)
+ */
+template <typename Integer>
+  requires std::is_unsigned_v<Integer>
+constexpr Integer bit_ceil(Integer v) {
+  return v <= 1 ? Integer(1)
+                : static_cast<Integer>(Integer(1)
+                                       << (log2(static_cast<Integer>(v - 1)) +
+                                           1));
+}
+
+/**
+ * @brief  maskの立っているビットの位置にあるxのビットを下位に詰めて取り出す(parallel bits extract)
+ * @note   実行時はBMI2のpext命令(-mbmi2)か、起動後に検出したpext命令か
+ *         移植可能な実装を使います
+ * @param  Integer x    符号なし整数x
+ * @param  Integer mask 取り出すビットのマスク
+ * @return 取り出したビットを下位に詰めた値
+ */
+template <typename Integer>
+  requires std::is_unsigned_v<Integer>
+constexpr Integer pext(Integer x, Integer mask) {
+  static_assert(detail::digits<Integer> <= 64,
+                "only supports integers up to 64 bits");
+  if (std::is_constant_evaluated()) {
+    return detail::pext_portable(x, mask);
+  }
+#if defined(__BMI2__)
+  if constexpr (detail::digits<Integer> <= 32) {
+    return static_cast<Integer>(_pext_u32(x, mask));
+  } else {
+    return static_cast<Integer>(_pext_u64(x, mask));
+  }
+#elif defined(BIT_RUNTIME_DISPATCH)
+  return detail::pext_dispatch(x, mask);
+#else
+  return detail::pext_portable(x, mask);
+#endif
+}
+
+/**
+ * @brief  xの下位のビットをmaskの立っているビットの位置に順に配る(parallel bits deposit)
+ * @note   実行時はBMI2のpdep命令(-mbmi2)か、起動後に検出したpdep命令か
+ *         移植可能な実装を使います
+ * @param  Integer x    符号なし整数x
+ * @param  Integer mask 配る先のビットのマスク
+ * @return 配った値
+ */
+template <typename Integer>
+  requires std::is_unsigned_v<Integer>
+constexpr Integer pdep(Integer x, Integer mask) {
+  static_assert(detail::digits<Integer> <= 64,
+                "only supports integers up to 64 bits");
+  if (std::is_constant_evaluated()) {
+    return detail::pdep_portable(x, mask);
+  }
+#if defined(__BMI2__)
+  if constexpr (detail::digits<Integer> <= 32) {
+    return static_cast<Integer>(_pdep_u32(x, mask));
+  } else {
+    return static_cast<Integer>(_pdep_u64(x, mask));
+  }
+#elif defined(BIT_RUNTIME_DISPATCH)
+  return detail::pdep_dispatch(x, mask);
+#else
+  return detail::pdep_portable(x, mask);
+#endif
+}
+
+/**
+ * @brief  符号なし整数vのバイト順を反転する
+ * @note   実行時はコンパイラの組み込み関数(bswap, movbe, rev命令)を使います
+ * @param  Integer v 符号なし整数v(8〜64ビット)
+ * @return バイト順を反転した値
+ */
+template <typename Integer>
+  requires std::is_unsigned_v<Integer>
+constexpr Integer byteswap(Integer v) {
+  static_assert(detail::digits<Integer> <= 64,
+                "only supports integers up to 64 bits");
+  if constexpr (sizeof(Integer) == 1) {
+    return v;
+  } else {
+    if (std::is_constant_evaluated()) {
+      return detail::byteswap_portable(v);
+    }
+#if defined(__GNUC__)
+    if constexpr (sizeof(Integer) == 2) {
+      return __builtin_bswap16(v);
+    } else if constexpr (sizeof(Integer) == 4) {
+      return __builtin_bswap32(v);
+    } else {
+      return __builtin_bswap64(v);
+    }
+#else
+    return detail::byteswap_portable(v);
+#endif
+  }
 }
 
 /**
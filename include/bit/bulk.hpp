@@ -0,0 +1,320 @@
+/**
+ * @brief  ビット列(std::uint64_tの配列)をまとめて処理するカーネル
+ * @note   popcount, and_popcount(積集合の要素数), 語毎のAND/OR/XOR/ANDNOTの代入を、
+ *         実行時に検出したCPUの機能に応じてAVX2版かスカラー版で計算します。
+ *         スカラー版はbit::popcountを使います。
+ * @note   AVX2版のpopcountは、pshufbで4ビット毎に数えるpopcount256をCarry-Save Adder
+ *         (CSA)の木で16ベクトルに1回だけ呼ぶHarley-Seal法です。
+ * @note   Reference: W. Muła, N. Kurz and D. Lemire, "Faster Population Counts
+ * Using AVX2 Instructions", The Computer Journal, 2018.
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef BIT_BULK_HPP
+#define BIT_BULK_HPP
+
+// ********************************************************************************
+// Include files
+// ********************************************************************************
+
+#include "bit/bit.hpp"
+#include "cpu/cpu_features.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+#define BIT_BULK_AVX2 1
+#include <immintrin.h>
+#endif
+
+// ********************************************************************************
+// Begin of namespace
+// ********************************************************************************
+
+namespace bit::bulk {
+
+namespace detail {
+
+/**< @brief 語毎の論理演算 */
+enum class op { and_, or_, xor_, andnot_ };
+
+// ********************************************************************************
+// スカラー版
+// ********************************************************************************
+
+inline std::size_t popcount_scalar(const std::uint64_t *a, std::size_t n) {
+  std::size_t c = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    c += static_cast<std::size_t>(bit::popcount(a[i]));
+  }
+  return c;
+}
+
+inline std::size_t and_popcount_scalar(const std::uint64_t *a,
+                                       const std::uint64_t *b, std::size_t n) {
+  std::size_t c = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    c += static_cast<std::size_t>(bit::popcount(a[i] & b[i]));
+  }
+  return c;
+}
+
+template <op Op>
+void assign_scalar(std::uint64_t *dst, const std::uint64_t *src,
+                   std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    if constexpr (Op == op::and_) {
+      dst[i] &= src[i];
+    } else if constexpr (Op == op::or_) {
+      dst[i] |= src[i];
+    } else if constexpr (Op == op::xor_) {
+      dst[i] ^= src[i];
+    } else {
+      dst[i] &= ~src[i];
+    }
+  }
+}
+
+// ********************************************************************************
+// AVX2版
+// ********************************************************************************
+
+#if defined(BIT_BULK_AVX2)
+
+/**< @brief 256ビットの各64ビットレーンの立っているビットの数 */
+CPU_TARGET("avx2") inline __m256i popcount256(__m256i v) {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1,
+                       2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0f);
+  const __m256i lo = _mm256_and_si256(v, low);
+  const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+  const __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                    _mm256_shuffle_epi8(lookup, hi));
+  return _mm256_sad_epu8(c, _mm256_setzero_si256()); // 8バイト毎に足す
+}
+
+/**< @brief Carry-Save Adder: a + b + cの各ビットの和を桁上がりhと下位lに分ける */
+CPU_TARGET("avx2")
+inline void csa(__m256i &h, __m256i &l, __m256i a, __m256i b, __m256i c) {
+  const __m256i u = _mm256_xor_si256(a, b);
+  h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+  l = _mm256_xor_si256(u, c);
+}
+
+/**< @brief i番目のベクトル(And = trueのときはa & b)を読む */
+template <bool And>
+CPU_TARGET("avx2")
+inline __m256i load256(const std::uint64_t *a, const std::uint64_t *b,
+                       std::size_t i) {
+  const __m256i x =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a) + i);
+  if constexpr (And) {
+    return _mm256_and_si256(
+        x, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b) + i));
+  } else {
+    return x;
+  }
+}
+
+/**
+ * @brief Harley-Seal法でn語(And = trueのときはa & b)の立っているビットを数える
+ * @note  16ベクトル毎にCSAの木でones, twos, fours, eightsに畳み込み、
+ *        桁上がりのsixteensだけをpopcount256で数えます
+ */
+template <bool And>
+CPU_TARGET("avx2")
+std::size_t harley_seal(const std::uint64_t *a, const std::uint64_t *b,
+                        std::size_t n) {
+  const std::size_t vecs = n / 4;
+  __m256i total = _mm256_setzero_si256();
+  __m256i ones = _mm256_setzero_si256(), twos = ones, fours = ones,
+          eights = ones, sixteens;
+  __m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+  std::size_t i = 0;
+  for (; i + 16 <= vecs; i += 16) {
+    csa(twos_a, ones, ones, load256<And>(a, b, i + 0),
+        load256<And>(a, b, i + 1));
+    csa(twos_b, ones, ones, load256<And>(a, b, i + 2),
+        load256<And>(a, b, i + 3));
+    csa(fours_a, twos, twos, twos_a, twos_b);
+    csa(twos_a, ones, ones, load256<And>(a, b, i + 4),
+        load256<And>(a, b, i + 5));
+    csa(twos_b, ones, ones, load256<And>(a, b, i + 6),
+        load256<And>(a, b, i + 7));
+    csa(fours_b, twos, twos, twos_a, twos_b);
+    csa(eights_a, fours, fours, fours_a, fours_b);
+    csa(twos_a, ones, ones, load256<And>(a, b, i + 8),
+        load256<And>(a, b, i + 9));
+    csa(twos_b, ones, ones, load256<And>(a, b, i + 10),
+        load256<And>(a, b, i + 11));
+    csa(fours_a, twos, twos, twos_a, twos_b);
+    csa(twos_a, ones, ones, load256<And>(a, b, i + 12),
+        load256<And>(a, b, i + 13));
+    csa(twos_b, ones, ones, load256<And>(a, b, i + 14),
+        load256<And>(a, b, i + 15));
+    csa(fours_b, twos, twos, twos_a, twos_b);
+    csa(eights_b, fours, fours, fours_a, fours_b);
+    csa(sixteens, eights, eights, eights_a, eights_b);
+    total = _mm256_add_epi64(total, popcount256(sixteens));
+  }
+  total = _mm256_slli_epi64(total, 4);
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(eights), 3));
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(fours), 2));
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(twos), 1));
+  total = _mm256_add_epi64(total, popcount256(ones));
+  for (; i < vecs; i++) {
+    total = _mm256_add_epi64(total, popcount256(load256<And>(a, b, i)));
+  }
+  alignas(32) std::uint64_t lane[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lane), total);
+  std::size_t c = static_cast<std::size_t>(lane[0] + lane[1] + lane[2] + lane[3]);
+  if constexpr (And) {
+    return c + and_popcount_scalar(a + vecs * 4, b + vecs * 4, n - vecs * 4);
+  } else {
+    return c + popcount_scalar(a + vecs * 4, n - vecs * 4);
+  }
+}
+
+CPU_TARGET("avx2")
+inline std::size_t popcount_avx2(const std::uint64_t *a, std::size_t n) {
+  return harley_seal<false>(a, nullptr, n);
+}
+
+CPU_TARGET("avx2")
+inline std::size_t and_popcount_avx2(const std::uint64_t *a,
+                                     const std::uint64_t *b, std::size_t n) {
+  return harley_seal<true>(a, b, n);
+}
+
+template <op Op>
+CPU_TARGET("avx2")
+void assign_avx2(std::uint64_t *dst, const std::uint64_t *src, std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i *const p = reinterpret_cast<__m256i *>(dst + i);
+    const __m256i x = _mm256_loadu_si256(p);
+    const __m256i y =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    if constexpr (Op == op::and_) {
+      _mm256_storeu_si256(p, _mm256_and_si256(x, y));
+    } else if constexpr (Op == op::or_) {
+      _mm256_storeu_si256(p, _mm256_or_si256(x, y));
+    } else if constexpr (Op == op::xor_) {
+      _mm256_storeu_si256(p, _mm256_xor_si256(x, y));
+    } else {
+      _mm256_storeu_si256(p, _mm256_andnot_si256(y, x)); // (~y) & x
+    }
+  }
+  assign_scalar<Op>(dst + i, src + i, n - i);
+}
+
+#endif
+
+// ********************************************************************************
+// 振り分け
+// ********************************************************************************
+
+/**< @brief 語毎の論理演算をdst = dst op srcで代入する */
+template <op Op>
+void assign(std::span<std::uint64_t> dst, std::span<const std::uint64_t> src) {
+  if (dst.size() != src.size()) {
+    throw std::invalid_argument("bit::bulk: spans differ in size");
+  }
+  static const cpu::dispatcher<void(std::uint64_t *, const std::uint64_t *,
+                                    std::size_t)>
+      f = {
+#if defined(BIT_BULK_AVX2)
+          {cpu::avx2, assign_avx2<Op>},
+#endif
+          {cpu::none, assign_scalar<Op>}};
+  f(dst.data(), src.data(), dst.size());
+}
+
+} // namespace detail
+
+// ********************************************************************************
+// 関数の定義
+// ********************************************************************************
+
+/**
+ * @brief  ビット列aの立っているビットの数を数える
+ * @param  std::span<const std::uint64_t> a ビット列
+ * @return 立っているビットの数
+ */
+inline std::size_t popcount(std::span<const std::uint64_t> a) {
+  static const cpu::dispatcher<std::size_t(const std::uint64_t *, std::size_t)>
+      f = {
+#if defined(BIT_BULK_AVX2)
+          {cpu::avx2, detail::popcount_avx2},
+#endif
+          {cpu::none, detail::popcount_scalar}};
+  return f(a.data(), a.size());
+}
+
+/**
+ * @brief  ビット列a, bの積(a & b)の立っているビットの数を、積を書き出さずに数える
+ * @param  std::span<const std::uint64_t> a ビット列
+ * @param  std::span<const std::uint64_t> b aと同じ長さのビット列
+ * @return 積集合の要素数
+ * @throw  std::invalid_argument 長さが違うとき
+ */
+inline std::size_t and_popcount(std::span<const std::uint64_t> a,
+                                std::span<const std::uint64_t> b) {
+  if (a.size() != b.size()) {
+    throw std::invalid_argument("bit::bulk: spans differ in size");
+  }
+  static const cpu::dispatcher<std::size_t(
+      const std::uint64_t *, const std::uint64_t *, std::size_t)>
+      f = {
+#if defined(BIT_BULK_AVX2)
+          {cpu::avx2, detail::and_popcount_avx2},
+#endif
+          {cpu::none, detail::and_popcount_scalar}};
+  return f(a.data(), b.data(), a.size());
+}
+
+/**
+ * @brief  dst &= srcを語毎に計算する
+ * @throw  std::invalid_argument 長さが違うとき
+ */
+inline void assign_and(std::span<std::uint64_t> dst,
+                       std::span<const std::uint64_t> src) {
+  detail::assign<detail::op::and_>(dst, src);
+}
+
+/**
+ * @brief  dst |= srcを語毎に計算する
+ * @throw  std::invalid_argument 長さが違うとき
+ */
+inline void assign_or(std::span<std::uint64_t> dst,
+                      std::span<const std::uint64_t> src) {
+  detail::assign<detail::op::or_>(dst, src);
+}
+
+/**
+ * @brief  dst ^= srcを語毎に計算する
+ * @throw  std::invalid_argument 長さが違うとき
+ */
+inline void assign_xor(std::span<std::uint64_t> dst,
+                       std::span<const std::uint64_t> src) {
+  detail::assign<detail::op::xor_>(dst, src);
+}
+
+/**
+ * @brief  dst &= ~srcを語毎に計算する(差集合)
+ * @throw  std::invalid_argument 長さが違うとき
+ */
+inline void assign_andnot(std::span<std::uint64_t> dst,
+                          std::span<const std::uint64_t> src) {
+  detail::assign<detail::op::andnot_>(dst, src);
+}
+
+} // namespace bit::bulk
+
+#endif // BIT_BULK_HPP
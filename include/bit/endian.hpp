@@ -0,0 +1,234 @@
+/**
+ * @brief  バイト列と整数のエンディアン変換
+ * @note   load_be/store_be(load_le/store_le)はバイト列の任意の位置から
+ *         ビッグ(リトル)エンディアンの整数を1つ読み書きします。
+ *         memcpyとbit::byteswapに落ちるので、movbeかmov + bswapの1、2命令になります。
+ * @note   16/32/64ビットの列をまとめて変換するときは、実行時に検出した機能に応じて
+ *         AVX2(vpshufbで32バイトずつ)、SSSE3(pshufbで16バイトずつ)、
+ *         bswapによるスカラー版のいずれかを選びます
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef BIT_ENDIAN_HPP
+#define BIT_ENDIAN_HPP
+
+// ********************************************************************************
+// Include files
+// ********************************************************************************
+
+#include "bit/bit.hpp"
+#include "cpu/cpu_features.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+#define BIT_ENDIAN_SIMD 1
+#include <immintrin.h>
+#endif
+
+// ********************************************************************************
+// Begin of namespace
+// ********************************************************************************
+
+namespace bit {
+
+/**< @brief バイト順を入れ替えられる整数(16/32/64ビットの符号なし整数) */
+template <class T>
+concept swappable_word = std::is_unsigned_v<T> &&
+                         (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+// ********************************************************************************
+// 1つの整数の読み書き
+// ********************************************************************************
+
+/**< @brief pからビッグエンディアンの整数を読む(アラインメントは不要) */
+template <swappable_word T> inline T load_be(const void *p) noexcept {
+  T v;
+  std::memcpy(&v, p, sizeof(T));
+  if constexpr (std::endian::native == std::endian::little) {
+    v = bit::byteswap(v);
+  }
+  return v;
+}
+
+/**< @brief pからリトルエンディアンの整数を読む(アラインメントは不要) */
+template <swappable_word T> inline T load_le(const void *p) noexcept {
+  T v;
+  std::memcpy(&v, p, sizeof(T));
+  if constexpr (std::endian::native == std::endian::big) {
+    v = bit::byteswap(v);
+  }
+  return v;
+}
+
+/**< @brief pにビッグエンディアンでvを書く(アラインメントは不要) */
+template <swappable_word T> inline void store_be(void *p, T v) noexcept {
+  if constexpr (std::endian::native == std::endian::little) {
+    v = bit::byteswap(v);
+  }
+  std::memcpy(p, &v, sizeof(T));
+}
+
+/**< @brief pにリトルエンディアンでvを書く(アラインメントは不要) */
+template <swappable_word T> inline void store_le(void *p, T v) noexcept {
+  if constexpr (std::endian::native == std::endian::big) {
+    v = bit::byteswap(v);
+  }
+  std::memcpy(p, &v, sizeof(T));
+}
+
+// ********************************************************************************
+// まとめて変換するカーネル
+// ********************************************************************************
+
+namespace detail {
+
+/**< @brief srcのn個の整数Tのバイト順を入れ替えてdstに書く(src == dstでもよい) */
+template <class T>
+void byteswap_copy_scalar(const std::uint8_t *src, std::uint8_t *dst,
+                          std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    T v;
+    std::memcpy(&v, src + i * sizeof(T), sizeof(T));
+    v = bit::byteswap(v);
+    std::memcpy(dst + i * sizeof(T), &v, sizeof(T));
+  }
+}
+
+#if defined(BIT_ENDIAN_SIMD)
+
+/**< @brief 16バイトの中でsizeof(T)バイト毎に順序を逆にするpshufbのマスク */
+template <class T> inline constexpr auto byteswap_shuffle = [] {
+  std::array<char, 16> m{};
+  for (std::size_t i = 0; i < 16; i++) {
+    m[i] = static_cast<char>(i - i % sizeof(T) + sizeof(T) - 1 - i % sizeof(T));
+  }
+  return m;
+}();
+
+template <class T>
+CPU_TARGET("ssse3")
+void byteswap_copy_ssse3(const std::uint8_t *src, std::uint8_t *dst,
+                         std::size_t n) {
+  const __m128i m = _mm_loadu_si128(
+      reinterpret_cast<const __m128i *>(byteswap_shuffle<T>.data()));
+  const std::size_t bytes = n * sizeof(T);
+  std::size_t i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm_shuffle_epi8(v, m));
+  }
+  byteswap_copy_scalar<T>(src + i, dst + i, (bytes - i) / sizeof(T));
+}
+
+template <class T>
+CPU_TARGET("avx2")
+void byteswap_copy_avx2(const std::uint8_t *src, std::uint8_t *dst,
+                        std::size_t n) {
+  const __m128i m128 = _mm_loadu_si128(
+      reinterpret_cast<const __m128i *>(byteswap_shuffle<T>.data()));
+  const __m256i m = _mm256_broadcastsi128_si256(m128);
+  const std::size_t bytes = n * sizeof(T);
+  std::size_t i = 0;
+  for (; i + 64 <= bytes; i += 64) { // 2本並べて読み書きの待ちを隠す
+    const __m256i v0 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    const __m256i v1 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                        _mm256_shuffle_epi8(v0, m));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 32),
+                        _mm256_shuffle_epi8(v1, m));
+  }
+  for (; i + 16 <= bytes; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm_shuffle_epi8(v, m128));
+  }
+  byteswap_copy_scalar<T>(src + i, dst + i, (bytes - i) / sizeof(T));
+}
+
+#endif
+
+/**< @brief 実行時の機能に応じてbyteswap_copyを選んで呼ぶ */
+template <class T>
+void byteswap_copy(const std::uint8_t *src, std::uint8_t *dst, std::size_t n) {
+  static const cpu::dispatcher<void(const std::uint8_t *, std::uint8_t *,
+                                    std::size_t)>
+      f = {
+#if defined(BIT_ENDIAN_SIMD)
+          {cpu::avx2, byteswap_copy_avx2<T>},
+          {cpu::ssse3, byteswap_copy_ssse3<T>},
+#endif
+          {cpu::none, byteswap_copy_scalar<T>}};
+  f(src, dst, n);
+}
+
+/**< @brief バイト列と整数の列の長さが合うことを確かめる */
+inline void check_endian_sizes(std::size_t bytes, std::size_t words,
+                               std::size_t size) {
+  if (bytes != words * size) {
+    throw std::invalid_argument("bit: byte span does not match word span");
+  }
+}
+
+} // namespace detail
+
+// ********************************************************************************
+// 列の変換
+// ********************************************************************************
+
+/**< @brief 整数の列aの各要素のバイト順を入れ替える */
+template <swappable_word T> inline void byteswap(std::span<T> a) {
+  auto *const p = reinterpret_cast<std::uint8_t *>(a.data());
+  detail::byteswap_copy<T>(p, p, a.size());
+}
+
+/**
+ * @brief  ビッグエンディアンの整数を並べたバイト列inを、整数の列outに読む
+ * @throw  std::invalid_argument in.size() != out.size() * sizeof(T)のとき
+ */
+template <swappable_word T>
+inline void load_be(std::span<const std::uint8_t> in, std::span<T> out) {
+  detail::check_endian_sizes(in.size(), out.size(), sizeof(T));
+  if constexpr (std::endian::native == std::endian::little) {
+    detail::byteswap_copy<T>(in.data(),
+                             reinterpret_cast<std::uint8_t *>(out.data()),
+                             out.size());
+  } else {
+    std::memcpy(out.data(), in.data(), in.size());
+  }
+}
+
+/**
+ * @brief  整数の列inを、ビッグエンディアンで並べたバイト列outに書く
+ * @throw  std::invalid_argument out.size() != in.size() * sizeof(T)のとき
+ */
+template <class T>
+  requires swappable_word<std::remove_const_t<T>>
+inline void store_be(std::span<T> in, std::span<std::uint8_t> out) {
+  detail::check_endian_sizes(out.size(), in.size(), sizeof(T));
+  if constexpr (std::endian::native == std::endian::little) {
+    detail::byteswap_copy<std::remove_const_t<T>>(
+        reinterpret_cast<const std::uint8_t *>(in.data()), out.data(),
+        in.size());
+  } else {
+    std::memcpy(out.data(), in.data(), out.size());
+  }
+}
+
+} // namespace bit
+
+#endif // BIT_ENDIAN_HPP
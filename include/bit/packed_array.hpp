@@ -0,0 +1,338 @@
+/**
+ * @brief  ビット幅を指定した整数配列(bit-packed array)
+ * @note   各要素を下位のビットから詰めたwビットで64ビット語の列に格納します。
+ *         幅はコンパイル時(packed_array<12>)か実行時(packed_array<>(n, 12))に決めます。
+ * @note   uint32_tの列とまとめて変換するunpack/packは、実行時に検出した機能に応じて
+ *         次の実装を選びます
+ *         - unpack: AVX2で8要素ずつ。8要素はちょうどwバイトなので、
+ *                   pshufbのマスクとシフト量は幅毎に1つで済みます(w <= 25)
+ *         - pack  : BMI2のpextで2要素ずつ詰めます(w < 32)
+ * @note   Reference: D. Lemire and L. Boytsov, "Decoding billions of integers
+ * per second through vectorization", Software: Practice and Experience, 2015.
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef BIT_PACKED_ARRAY_HPP
+#define BIT_PACKED_ARRAY_HPP
+
+// ********************************************************************************
+// Include files
+// ********************************************************************************
+
+#include "cpu/cpu_features.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+#define BIT_PACKED_SIMD 1
+#include <immintrin.h>
+#endif
+
+// ********************************************************************************
+// Begin of namespace
+// ********************************************************************************
+
+namespace bit {
+
+/**< @brief 幅を実行時に決めるときのテンプレート引数 */
+inline constexpr std::size_t dynamic_bits = 0;
+
+namespace detail {
+
+// ********************************************************************************
+// スカラー版
+// ********************************************************************************
+
+/**< @brief wビットの要素のマスク */
+constexpr std::uint64_t packed_mask(std::size_t w) noexcept {
+  return w >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << w) - 1;
+}
+
+/**< @brief 語の列wordsのfirst番目からn個の要素をoutに取り出す */
+inline void packed_unpack_scalar(const std::uint64_t *words, std::size_t first,
+                                 std::size_t w, std::uint32_t *out,
+                                 std::size_t n) {
+  const std::uint64_t mask = packed_mask(w);
+  std::size_t word = first * w / 64, off = first * w % 64;
+  for (std::size_t i = 0; i < n; i++) {
+    std::uint64_t v = words[word] >> off;
+    if (off + w > 64) { // 次の語にまたがる
+      v |= words[word + 1] << (64 - off);
+    }
+    out[i] = static_cast<std::uint32_t>(v & mask);
+    off += w;
+    if (off >= 64) {
+      off -= 64;
+      word++;
+    }
+  }
+}
+
+/**< @brief inのn個の要素を語の列wordsのfirst番目から書き込む */
+inline void packed_pack_scalar(std::uint64_t *words, std::size_t first,
+                               std::size_t w, const std::uint32_t *in,
+                               std::size_t n) {
+  const std::uint64_t mask = packed_mask(w);
+  std::size_t word = first * w / 64, off = first * w % 64;
+  std::uint64_t acc = words[word] & packed_mask(off); // 前の要素のビットを残す
+  for (std::size_t i = 0; i < n; i++) {
+    const std::uint64_t v = in[i] & mask;
+    acc |= v << off;
+    off += w;
+    if (off >= 64) { // 語が埋まった
+      words[word++] = acc;
+      off -= 64;
+      acc = off == 0 ? 0 : v >> (w - off);
+    }
+  }
+  if (off > 0) { // 後の要素のビットを残す
+    words[word] = (words[word] & ~packed_mask(off)) | acc;
+  }
+}
+
+// ********************************************************************************
+// SIMD版
+// ********************************************************************************
+
+#if defined(BIT_PACKED_SIMD)
+
+/**
+ * @brief AVX2版のunpack(w <= 25)
+ * @note  添字が8の倍数の要素はバイト境界から始まり、8要素はwバイトを占めます。
+ *        下位レーンに先頭から16バイト、上位レーンに4要素目を含む16バイトを読み、
+ *        各要素を含む4バイトをpshufbで32ビットレーンに集めてからシフトします。
+ *        末尾を越えて高々16バイト読むので、語の列には2語の余白が必要です
+ */
+CPU_TARGET("avx2")
+inline void packed_unpack_avx2(const std::uint64_t *words, std::size_t first,
+                               std::size_t w, std::uint32_t *out,
+                               std::size_t n) {
+  if (w > 25) {
+    packed_unpack_scalar(words, first, w, out, n);
+    return;
+  }
+  std::size_t i = std::min(n, (8 - first % 8) % 8); // 8要素の境界まで
+  packed_unpack_scalar(words, first, w, out, i);
+
+  const std::size_t hi = 4 * w / 8; // 上位レーンを読み始めるバイト
+  alignas(32) std::uint8_t shuffle[32];
+  alignas(32) std::uint32_t shift[8];
+  for (std::size_t k = 0; k < 8; k++) {
+    const std::size_t b = k * w - (k < 4 ? 0 : hi * 8); // レーン内のビット位置
+    for (std::size_t j = 0; j < 4; j++) {
+      shuffle[k * 4 + j] = static_cast<std::uint8_t>(b / 8 + j);
+    }
+    shift[k] = static_cast<std::uint32_t>(b % 8);
+  }
+  const __m256i shuf =
+      _mm256_load_si256(reinterpret_cast<const __m256i *>(shuffle));
+  const __m256i sh = _mm256_load_si256(reinterpret_cast<const __m256i *>(shift));
+  const __m256i mask = _mm256_set1_epi32(static_cast<int>(packed_mask(w)));
+  const std::uint8_t *const base = reinterpret_cast<const std::uint8_t *>(words);
+  for (; i + 8 <= n; i += 8) {
+    const std::uint8_t *const p = base + (first + i) / 8 * w;
+    const __m256i v = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + hi)), 1);
+    const __m256i x =
+        _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(v, shuf), sh),
+                         mask);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), x);
+  }
+  packed_unpack_scalar(words, first + i, w, out + i, n - i);
+}
+
+/**
+ * @brief BMI2版のpack(w < 32)
+ * @note  2要素を1つの64ビット語に並べ、pextで2wビットに詰めてから書き込みます
+ */
+CPU_TARGET("bmi2")
+inline void packed_pack_bmi2(std::uint64_t *words, std::size_t first,
+                             std::size_t w, const std::uint32_t *in,
+                             std::size_t n) {
+  if (w >= 32) {
+    packed_pack_scalar(words, first, w, in, n);
+    return;
+  }
+  const std::size_t w2 = 2 * w;
+  const std::uint64_t pair = packed_mask(w) | (packed_mask(w) << 32);
+  std::size_t word = first * w / 64, off = first * w % 64;
+  std::uint64_t acc = words[word] & packed_mask(off);
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const std::uint64_t v =
+        _pext_u64(in[i] | (std::uint64_t(in[i + 1]) << 32), pair);
+    acc |= v << off;
+    off += w2;
+    if (off >= 64) {
+      words[word++] = acc;
+      off -= 64;
+      acc = off == 0 ? 0 : v >> (w2 - off);
+    }
+  }
+  if (off > 0) {
+    words[word] = (words[word] & ~packed_mask(off)) | acc;
+  }
+  packed_pack_scalar(words, first + i, w, in + i, n - i);
+}
+
+#endif
+
+} // namespace detail
+
+// ********************************************************************************
+// クラスの定義
+// ********************************************************************************
+
+/**
+ * @brief  ビット幅を指定した符号なし整数の配列
+ * @note   要素は下位Bitsビットだけを保持し、上位のビットは書き込むときに捨てます
+ * @tparam Bits 要素のビット幅(1〜32)。dynamic_bitsのときはコンストラクタで指定します
+ */
+template <std::size_t Bits = dynamic_bits> class packed_array {
+  static_assert(Bits <= 32, "packed_array supports up to 32 bits");
+
+public:
+  using value_type = std::uint32_t;
+
+  /**< @brief 空の配列(幅がコンパイル時に決まっているとき) */
+  packed_array()
+    requires(Bits != dynamic_bits)
+      : bits_(Bits) {
+    resize(0);
+  }
+
+  /**< @brief 要素数nの0で初期化した配列(幅がコンパイル時に決まっているとき) */
+  explicit packed_array(std::size_t n)
+    requires(Bits != dynamic_bits)
+      : bits_(Bits) {
+    resize(n);
+  }
+
+  /**
+   * @brief 要素数n, 幅bitsの0で初期化した配列
+   * @throw std::invalid_argument bitsが1〜32でないとき
+   */
+  packed_array(std::size_t n, std::size_t bits)
+    requires(Bits == dynamic_bits)
+      : bits_(bits) {
+    if (bits < 1 || 32 < bits) {
+      throw std::invalid_argument("packed_array: bits must be in [1, 32]");
+    }
+    resize(n);
+  }
+
+  /**< @brief 要素数 */
+  std::size_t size() const noexcept { return size_; }
+
+  /**< @brief 要素のビット幅 */
+  constexpr std::size_t bits() const noexcept {
+    if constexpr (Bits != dynamic_bits) {
+      return Bits;
+    } else {
+      return bits_;
+    }
+  }
+
+  /**< @brief 使っているメモリのバイト数 */
+  std::size_t bytes() const noexcept {
+    return words_.size() * sizeof(std::uint64_t);
+  }
+
+  /**< @brief 格納している語の列(末尾の2語は余白) */
+  std::span<const std::uint64_t> words() const noexcept { return words_; }
+
+  /**< @brief 要素数をnにする(増えた要素は0) */
+  void resize(std::size_t n) {
+    if (n < size_) { // 切り詰めた要素のビットを消しておく
+      const std::size_t end = n * bits();
+      words_[end / 64] &= detail::packed_mask(end % 64);
+      std::fill(words_.begin() + end / 64 + 1, words_.end(), 0);
+    }
+    words_.resize((n * bits() + 63) / 64 + 2, 0);
+    size_ = n;
+  }
+
+  /**< @brief i番目の要素を返す */
+  value_type get(std::size_t i) const noexcept {
+    const std::size_t w = bits(), b = i * w, off = b % 64;
+    const std::uint64_t *const p = words_.data() + b / 64;
+    std::uint64_t v = p[0] >> off;
+    if (off + w > 64) {
+      v |= p[1] << (64 - off);
+    }
+    return static_cast<value_type>(v & detail::packed_mask(w));
+  }
+
+  /**< @brief i番目の要素をvの下位bits()ビットにする */
+  void set(std::size_t i, value_type v) noexcept {
+    const std::size_t w = bits(), b = i * w, off = b % 64;
+    const std::uint64_t m = detail::packed_mask(w);
+    const std::uint64_t x = v & m;
+    std::uint64_t *const p = words_.data() + b / 64;
+    p[0] = (p[0] & ~(m << off)) | (x << off);
+    if (off + w > 64) {
+      p[1] = (p[1] & ~(m >> (64 - off))) | (x >> (64 - off));
+    }
+  }
+
+  /**< @brief i番目の要素を返す */
+  value_type operator[](std::size_t i) const noexcept { return get(i); }
+
+  /**
+   * @brief first番目からout.size()個の要素をoutに取り出す
+   * @throw std::out_of_range 範囲が要素数を越えるとき
+   */
+  void unpack(std::size_t first, std::span<value_type> out) const {
+    check__(first, out.size());
+    static const cpu::dispatcher<void(const std::uint64_t *, std::size_t,
+                                      std::size_t, std::uint32_t *,
+                                      std::size_t)>
+        f = {
+#if defined(BIT_PACKED_SIMD)
+            {cpu::avx2, detail::packed_unpack_avx2},
+#endif
+            {cpu::none, detail::packed_unpack_scalar}};
+    f(words_.data(), first, bits(), out.data(), out.size());
+  }
+
+  /**
+   * @brief inの要素をfirst番目から書き込む
+   * @throw std::out_of_range 範囲が要素数を越えるとき
+   */
+  void pack(std::size_t first, std::span<const value_type> in) {
+    check__(first, in.size());
+    static const cpu::dispatcher<void(std::uint64_t *, std::size_t,
+                                      std::size_t, const std::uint32_t *,
+                                      std::size_t)>
+        f = {
+#if defined(BIT_PACKED_SIMD)
+            {cpu::bmi2, detail::packed_pack_bmi2},
+#endif
+            {cpu::none, detail::packed_pack_scalar}};
+    f(words_.data(), first, bits(), in.data(), in.size());
+  }
+
+private:
+  std::size_t bits_;                 /**< 要素のビット幅 */
+  std::size_t size_ = 0;             /**< 要素数 */
+  std::vector<std::uint64_t> words_; /**< 語の列(SIMD版の読み過ぎに備えて2語多い) */
+
+  void check__(std::size_t first, std::size_t n) const {
+    if (first > size_ || n > size_ - first) {
+      throw std::out_of_range("packed_array: range exceeds size");
+    }
+  }
+};
+
+} // namespace bit
+
+#endif // BIT_PACKED_ARRAY_HPP
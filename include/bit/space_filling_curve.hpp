@@ -0,0 +1,366 @@
+/**
+ * @brief  空間充填曲線(Morton順序, Hilbert曲線)による座標と1次元の添字の変換
+ * @note   座標を曲線上の添字に変換して整列すると、空間で近い要素がメモリでも近くに並ぶので、
+ *         近傍の走査でキャッシュミスが減ります。添字はuint64_tなので、
+ *         そのままradix_sortやsort_by_keyのキーに使えます。
+ * @note   Morton順序(Z-order)は各座標のビットを交互に並べたものです。
+ *         BMI2が使えるときはpdep/pextで、使えないときはマジックナンバーによる
+ *         シフトとマスクで拡げ(詰め)ます
+ *         - 2次元: 32ビット x 2 -> 64ビット
+ *         - 3次元: 21ビット x 3 -> 63ビット
+ * @note   2次元のHilbert曲線(32ビット x 2 -> 64ビット)は、象限毎の回転と反転を
+ *         ビット毎の状態として前置和(prefix scan)で計算するので、座標のビット毎の
+ *         ループがありません。向きはWikipediaのxy2dと同じです。
+ * @note   Reference URL: https://en.wikipedia.org/wiki/Z-order_curve
+ * @note   Reference URL: https://en.wikipedia.org/wiki/Hilbert_curve
+ * @note   Reference URL:
+ * http://threadlocalmutex.com/?p=126 (Hilbert curve prefix scan)
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef BIT_SPACE_FILLING_CURVE_HPP
+#define BIT_SPACE_FILLING_CURVE_HPP
+
+// ********************************************************************************
+// Include files
+// ********************************************************************************
+
+#include "bit/bit.hpp"
+#include "cpu/cpu_features.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+#define BIT_CURVE_BMI2 1
+#include <immintrin.h>
+#endif
+
+// ********************************************************************************
+// Begin of namespace
+// ********************************************************************************
+
+namespace bit {
+
+namespace detail {
+
+/**< @brief 2次元のMorton順序で1つの座標が占めるビット */
+inline constexpr std::uint64_t morton2_mask = 0x5555555555555555;
+/**< @brief 3次元のMorton順序で1つの座標が占めるビット */
+inline constexpr std::uint64_t morton3_mask = 0x1249249249249249;
+
+/**< @brief 32ビットのxを1ビットおきに拡げる(マジックナンバー) */
+constexpr std::uint64_t spread2(std::uint64_t x) noexcept {
+  x &= 0xffffffff;
+  x = (x | (x << 16)) & 0x0000ffff0000ffff;
+  x = (x | (x << 8)) & 0x00ff00ff00ff00ff;
+  x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0f;
+  x = (x | (x << 2)) & 0x3333333333333333;
+  x = (x | (x << 1)) & 0x5555555555555555;
+  return x;
+}
+
+/**< @brief spread2の逆 */
+constexpr std::uint32_t compact2(std::uint64_t x) noexcept {
+  x &= 0x5555555555555555;
+  x = (x | (x >> 1)) & 0x3333333333333333;
+  x = (x | (x >> 2)) & 0x0f0f0f0f0f0f0f0f;
+  x = (x | (x >> 4)) & 0x00ff00ff00ff00ff;
+  x = (x | (x >> 8)) & 0x0000ffff0000ffff;
+  x = (x | (x >> 16)) & 0x00000000ffffffff;
+  return static_cast<std::uint32_t>(x);
+}
+
+/**< @brief 21ビットのxを2ビットおきに拡げる(マジックナンバー) */
+constexpr std::uint64_t spread3(std::uint64_t x) noexcept {
+  x &= 0x1fffff;
+  x = (x | (x << 32)) & 0x001f00000000ffff;
+  x = (x | (x << 16)) & 0x001f0000ff0000ff;
+  x = (x | (x << 8)) & 0x100f00f00f00f00f;
+  x = (x | (x << 4)) & 0x10c30c30c30c30c3;
+  x = (x | (x << 2)) & 0x1249249249249249;
+  return x;
+}
+
+/**< @brief spread3の逆 */
+constexpr std::uint32_t compact3(std::uint64_t x) noexcept {
+  x &= 0x1249249249249249;
+  x = (x | (x >> 2)) & 0x10c30c30c30c30c3;
+  x = (x | (x >> 4)) & 0x100f00f00f00f00f;
+  x = (x | (x >> 8)) & 0x001f0000ff0000ff;
+  x = (x | (x >> 16)) & 0x001f00000000ffff;
+  x = (x | (x >> 32)) & 0x00000000001fffff;
+  return static_cast<std::uint32_t>(x);
+}
+
+/**
+ * @brief Hilbert曲線の添字の偶数ビットi0と奇数ビットi1を求める
+ * @note  各ビットの状態(回転と反転)を、上位のビットから伝わる変換の合成として
+ *        シフト幅1, 2, 4, 8, 16の前置和で求めます
+ */
+constexpr std::array<std::uint64_t, 2> hilbert2_bits(std::uint64_t x,
+                                                     std::uint64_t y) noexcept {
+  constexpr std::uint64_t m = 0xffffffff;
+  std::uint64_t A, B, C, D;
+  {
+    const std::uint64_t a = x ^ y, b = m ^ a, c = m ^ (x | y),
+                        d = x & (y ^ m);
+    A = a | (b >> 1);
+    B = (a >> 1) ^ a;
+    C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+    D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+  }
+  for (int s = 2; s <= 8; s <<= 1) {
+    const std::uint64_t a = A, b = B, c = C, d = D;
+    A = (a & (a >> s)) ^ (b & (b >> s));
+    B = (a & (b >> s)) ^ (b & ((a ^ b) >> s));
+    C ^= (a & (c >> s)) ^ (b & (d >> s));
+    D ^= (b & (c >> s)) ^ ((a ^ b) & (d >> s));
+  }
+  {
+    const std::uint64_t a = A, b = B, c = C, d = D;
+    C ^= (a & (c >> 16)) ^ (b & (d >> 16));
+    D ^= (b & (c >> 16)) ^ ((a ^ b) & (d >> 16));
+  }
+  const std::uint64_t a = C ^ (C >> 1), b = D ^ (D >> 1);
+  const std::uint64_t i0 = (x ^ y) & m;
+  const std::uint64_t i1 = (b | (m ^ (i0 | a))) & m;
+  return {i0, i1};
+}
+
+} // namespace detail
+
+// ********************************************************************************
+// 関数の定義
+// ********************************************************************************
+
+/**
+ * @brief  2次元の座標(x, y)をMorton順序の添字にする
+ * @return xを偶数ビット、yを奇数ビットに並べた64ビットの添字
+ */
+constexpr std::uint64_t morton2_encode(std::uint32_t x,
+                                       std::uint32_t y) noexcept {
+#if defined(__BMI2__)
+  if (!std::is_constant_evaluated()) {
+    return bit::pdep<std::uint64_t>(x, detail::morton2_mask) |
+           bit::pdep<std::uint64_t>(y, detail::morton2_mask << 1);
+  }
+#endif
+  return detail::spread2(x) | (detail::spread2(y) << 1);
+}
+
+/**< @brief morton2_encodeの逆 */
+constexpr std::array<std::uint32_t, 2> morton2_decode(std::uint64_t m) noexcept {
+#if defined(__BMI2__)
+  if (!std::is_constant_evaluated()) {
+    return {static_cast<std::uint32_t>(bit::pext(m, detail::morton2_mask)),
+            static_cast<std::uint32_t>(bit::pext(m, detail::morton2_mask << 1))};
+  }
+#endif
+  return {detail::compact2(m), detail::compact2(m >> 1)};
+}
+
+/**
+ * @brief  3次元の座標(x, y, z)をMorton順序の添字にする
+ * @note   各座標は下位21ビットだけを使います
+ * @return x, y, zを3ビットおきに並べた63ビットの添字
+ */
+constexpr std::uint64_t morton3_encode(std::uint32_t x, std::uint32_t y,
+                                       std::uint32_t z) noexcept {
+#if defined(__BMI2__)
+  if (!std::is_constant_evaluated()) {
+    return bit::pdep<std::uint64_t>(x, detail::morton3_mask) |
+           bit::pdep<std::uint64_t>(y, detail::morton3_mask << 1) |
+           bit::pdep<std::uint64_t>(z, detail::morton3_mask << 2);
+  }
+#endif
+  return detail::spread3(x) | (detail::spread3(y) << 1) |
+         (detail::spread3(z) << 2);
+}
+
+/**< @brief morton3_encodeの逆 */
+constexpr std::array<std::uint32_t, 3> morton3_decode(std::uint64_t m) noexcept {
+#if defined(__BMI2__)
+  if (!std::is_constant_evaluated()) {
+    return {static_cast<std::uint32_t>(bit::pext(m, detail::morton3_mask)),
+            static_cast<std::uint32_t>(bit::pext(m, detail::morton3_mask << 1)),
+            static_cast<std::uint32_t>(bit::pext(m, detail::morton3_mask << 2))};
+  }
+#endif
+  return {detail::compact3(m), detail::compact3(m >> 1),
+          detail::compact3(m >> 2)};
+}
+
+/**
+ * @brief  2次元の座標(x, y)を2^32 x 2^32の格子を辿るHilbert曲線の添字にする
+ * @return 曲線上の位置(隣り合う添字の座標は上下左右に隣り合います)
+ */
+constexpr std::uint64_t hilbert2_encode(std::uint32_t x,
+                                        std::uint32_t y) noexcept {
+  const auto [i0, i1] = detail::hilbert2_bits(x, y);
+  return morton2_encode(static_cast<std::uint32_t>(i0),
+                        static_cast<std::uint32_t>(i1));
+}
+
+/**< @brief hilbert2_encodeの逆 */
+constexpr std::array<std::uint32_t, 2> hilbert2_decode(std::uint64_t d) noexcept {
+  std::uint32_t x = 0, y = 0;
+  for (std::uint64_t s = 1; s < (std::uint64_t(1) << 32); s <<= 1) {
+    const std::uint32_t rx = static_cast<std::uint32_t>(1 & (d >> 1));
+    const std::uint32_t ry = static_cast<std::uint32_t>(1 & (d ^ rx));
+    if (ry == 0) { // 象限を回す
+      if (rx == 1) {
+        x = static_cast<std::uint32_t>(s - 1 - x);
+        y = static_cast<std::uint32_t>(s - 1 - y);
+      }
+      std::swap(x, y);
+    }
+    x += static_cast<std::uint32_t>(s * rx);
+    y += static_cast<std::uint32_t>(s * ry);
+    d >>= 2;
+  }
+  return {x, y};
+}
+
+// ********************************************************************************
+// まとめて変換するカーネル
+// ********************************************************************************
+
+namespace detail {
+
+inline void morton2_encode_scalar(const std::uint32_t *x, const std::uint32_t *y,
+                                  std::uint64_t *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = spread2(x[i]) | (spread2(y[i]) << 1);
+  }
+}
+
+inline void morton3_encode_scalar(const std::uint32_t *x, const std::uint32_t *y,
+                                  const std::uint32_t *z, std::uint64_t *out,
+                                  std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = spread3(x[i]) | (spread3(y[i]) << 1) | (spread3(z[i]) << 2);
+  }
+}
+
+inline void hilbert2_encode_scalar(const std::uint32_t *x, const std::uint32_t *y,
+                                   std::uint64_t *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    const auto [i0, i1] = hilbert2_bits(x[i], y[i]);
+    out[i] = spread2(i0) | (spread2(i1) << 1);
+  }
+}
+
+#if defined(BIT_CURVE_BMI2)
+
+CPU_TARGET("bmi2")
+inline void morton2_encode_bmi2(const std::uint32_t *x, const std::uint32_t *y,
+                                std::uint64_t *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = _pdep_u64(x[i], morton2_mask) | _pdep_u64(y[i], morton2_mask << 1);
+  }
+}
+
+CPU_TARGET("bmi2")
+inline void morton3_encode_bmi2(const std::uint32_t *x, const std::uint32_t *y,
+                                const std::uint32_t *z, std::uint64_t *out,
+                                std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = _pdep_u64(x[i], morton3_mask) |
+             _pdep_u64(y[i], morton3_mask << 1) |
+             _pdep_u64(z[i], morton3_mask << 2);
+  }
+}
+
+CPU_TARGET("bmi2")
+inline void hilbert2_encode_bmi2(const std::uint32_t *x, const std::uint32_t *y,
+                                 std::uint64_t *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    const auto [i0, i1] = hilbert2_bits(x[i], y[i]);
+    out[i] = _pdep_u64(i0, morton2_mask) | _pdep_u64(i1, morton2_mask << 1);
+  }
+}
+
+#endif
+
+/**< @brief 座標の列と出力の長さが等しいことを確かめる */
+inline void check_curve_sizes(std::size_t n, std::size_t m) {
+  if (n != m) {
+    throw std::invalid_argument("bit: coordinate spans differ in size");
+  }
+}
+
+} // namespace detail
+
+/**
+ * @brief  座標の列(xs[i], ys[i])をMorton順序の添字の列outにする
+ * @throw  std::invalid_argument 長さが違うとき
+ */
+inline void morton2_encode(std::span<const std::uint32_t> xs,
+                           std::span<const std::uint32_t> ys,
+                           std::span<std::uint64_t> out) {
+  detail::check_curve_sizes(xs.size(), out.size());
+  detail::check_curve_sizes(ys.size(), out.size());
+  static const cpu::dispatcher<void(const std::uint32_t *,
+                                    const std::uint32_t *, std::uint64_t *,
+                                    std::size_t)>
+      f = {
+#if defined(BIT_CURVE_BMI2)
+          {cpu::bmi2, detail::morton2_encode_bmi2},
+#endif
+          {cpu::none, detail::morton2_encode_scalar}};
+  f(xs.data(), ys.data(), out.data(), out.size());
+}
+
+/**
+ * @brief  座標の列(xs[i], ys[i], zs[i])をMorton順序の添字の列outにする
+ * @throw  std::invalid_argument 長さが違うとき
+ */
+inline void morton3_encode(std::span<const std::uint32_t> xs,
+                           std::span<const std::uint32_t> ys,
+                           std::span<const std::uint32_t> zs,
+                           std::span<std::uint64_t> out) {
+  detail::check_curve_sizes(xs.size(), out.size());
+  detail::check_curve_sizes(ys.size(), out.size());
+  detail::check_curve_sizes(zs.size(), out.size());
+  static const cpu::dispatcher<void(
+      const std::uint32_t *, const std::uint32_t *, const std::uint32_t *,
+      std::uint64_t *, std::size_t)>
+      f = {
+#if defined(BIT_CURVE_BMI2)
+          {cpu::bmi2, detail::morton3_encode_bmi2},
+#endif
+          {cpu::none, detail::morton3_encode_scalar}};
+  f(xs.data(), ys.data(), zs.data(), out.data(), out.size());
+}
+
+/**
+ * @brief  座標の列(xs[i], ys[i])をHilbert曲線の添字の列outにする
+ * @throw  std::invalid_argument 長さが違うとき
+ */
+inline void hilbert2_encode(std::span<const std::uint32_t> xs,
+                            std::span<const std::uint32_t> ys,
+                            std::span<std::uint64_t> out) {
+  detail::check_curve_sizes(xs.size(), out.size());
+  detail::check_curve_sizes(ys.size(), out.size());
+  static const cpu::dispatcher<void(const std::uint32_t *,
+                                    const std::uint32_t *, std::uint64_t *,
+                                    std::size_t)>
+      f = {
+#if defined(BIT_CURVE_BMI2)
+          {cpu::bmi2, detail::hilbert2_encode_bmi2},
+#endif
+          {cpu::none, detail::hilbert2_encode_scalar}};
+  f(xs.data(), ys.data(), out.data(), out.size());
+}
+
+} // namespace bit
+
+#endif // BIT_SPACE_FILLING_CURVE_HPP
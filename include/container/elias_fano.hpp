@@ -0,0 +1,208 @@
+/**
+ * @brief  Elias-Fano符号による単調非減少列
+ * @note   [0, u]の値をとるn個の単調非減少列x[0] <= ... <= x[n - 1]を、
+ *         各値の下位l = floor(lg(u / n))ビットと上位ビットに分けて格納する
+ *         下位ビットはlビット幅の固定長配列に、上位ビットはx[i] >> lを1進符号で
+ *         表し、i番目の要素に対応する1を位置(x[i] >> l) + iに立てたビット列に置く
+ *         上位ビット列の長さは高々n + u / 2^l + 1 <= 2n + 1であるため、
+ *         全体で1要素あたりおよそ2 + lビットと定数の索引で済む
+ *
+ * @note   access(i)は上位ビット列のselect1、next_geq(x)はselect0で
+ *         値の上位ビットに対応する位置へ飛んでから走査する
+ *
+ * @note   Reference: S. Vigna, "Quasi-Succinct Indices", WSDM 2013.
+ */
+
+#ifndef ELIAS_FANO_HPP
+#define ELIAS_FANO_HPP
+
+#include "bit/bit.hpp"
+#include "rank_select_bitvector.hpp"
+#include <boost/assert.hpp>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace container {
+
+/**
+ * @brief Elias-Fano符号による単調非減少列
+ */
+struct elias_fano {
+  using value_t = std::uint64_t;
+  using word_t = rank_select_bitvector::word_t;
+  static constexpr std::size_t word_bits = rank_select_bitvector::word_bits;
+
+  /**< @brief 要素を先頭から順に辿る前方向イテレータ */
+  struct const_iterator {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = value_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_t *;
+    using reference = value_t;
+
+    const_iterator() = default;
+    const_iterator(const elias_fano *ef, std::size_t i, std::size_t pos)
+        : ef_(ef), i_(i), pos_(pos) {}
+
+    value_t operator*() const noexcept { return ef_->value(i_, pos_); }
+    const_iterator &operator++() noexcept {
+      if (++i_ < ef_->n_) {
+        pos_ = ef_->next_one(pos_ + 1);
+      }
+      return *this;
+    }
+    const_iterator operator++(int) noexcept {
+      const_iterator it = *this;
+      ++*this;
+      return it;
+    }
+    /**< @brief 指している要素の添字を返す */
+    std::size_t index() const noexcept { return i_; }
+
+    bool operator==(const const_iterator &rhs) const noexcept {
+      return i_ == rhs.i_;
+    }
+    bool operator!=(const const_iterator &rhs) const noexcept {
+      return i_ != rhs.i_;
+    }
+
+  private:
+    const elias_fano *ef_ = nullptr;
+    std::size_t i_ = 0;   /**< 要素の添字 */
+    std::size_t pos_ = 0; /**< 上位ビット列での位置 */
+  };
+
+  elias_fano() = default;
+
+  /**
+   * @brief 単調非減少列[first, last)を符号化する
+   * @param value_t u 値の上限(全ての要素はu以下でなければならない)
+   */
+  template <class InputIt>
+  elias_fano(InputIt first, InputIt last, value_t u)
+      : n_(static_cast<std::size_t>(std::distance(first, last))), u_(u) {
+    l_ = n_ == 0 || u_ / n_ == 0 ? 0 : bit::log2(u_ / n_);
+    upper_ = rank_select_bitvector(n_ + (u_ >> l_) + 1);
+    lower_.assign((n_ * l_ + word_bits - 1) / word_bits + 1, 0);
+    value_t prev = 0;
+    for (std::size_t i = 0; first != last; ++first, ++i) {
+      const value_t x = static_cast<value_t>(*first);
+      BOOST_ASSERT_MSG(prev <= x && x <= u_,
+                       "Elias-Fano sequence must be monotone and bounded.");
+      upper_.set((x >> l_) + i);
+      set_low(i, x);
+      prev = x;
+    }
+    upper_.build();
+  }
+
+  /**< @brief 単調非減少列[first, last)を、最後の要素を値の上限として符号化する */
+  template <class InputIt>
+  elias_fano(InputIt first, InputIt last)
+      : elias_fano(first, last,
+                   first == last ? 0
+                                 : static_cast<value_t>(*std::prev(last))) {}
+
+  /**< @brief 要素数を返す */
+  std::size_t size() const noexcept { return n_; }
+  /**< @brief 空かどうかを返す */
+  bool empty() const noexcept { return n_ == 0; }
+  /**< @brief 値の上限を返す */
+  value_t universe() const noexcept { return u_; }
+  /**< @brief 使用バイト数を返す */
+  std::size_t bytes() const noexcept {
+    return upper_.bytes() + lower_.size() * sizeof(word_t);
+  }
+
+  /**
+   * @brief  i番目の要素を返す
+   * @note   実行時間はΟ(1)
+   */
+  value_t access(std::size_t i) const noexcept {
+    BOOST_ASSERT_MSG(i < n_, "Elias-Fano index out of range.");
+    return value(i, upper_.select1(i));
+  }
+  value_t operator[](std::size_t i) const noexcept { return access(i); }
+
+  /**
+   * @brief  x以上である最初の要素を指すイテレータを返す
+   * @note   上位ビットがx >> lに等しい要素の先頭へselect0で飛び、そこから走査する
+   *         走査する要素数は上位ビットが等しい要素の数(平均Ο(1))で抑えられる
+   * @return 見つからなければend()
+   */
+  const_iterator next_geq(value_t x) const noexcept {
+    if (n_ == 0 || x > u_) {
+      return end();
+    }
+    const value_t hx = x >> l_;
+    const std::size_t p = hx == 0 ? 0 : upper_.select0(hx - 1) + 1;
+    const std::size_t i = p - hx; // p より前にある1の数
+    if (i >= n_) {
+      return end();
+    }
+    const_iterator it(this, i, next_one(p));
+    while (it != end() && *it < x) {
+      ++it;
+    }
+    return it;
+  }
+
+  const_iterator begin() const noexcept {
+    return n_ == 0 ? end() : const_iterator(this, 0, next_one(0));
+  }
+  const_iterator end() const noexcept { return const_iterator(this, n_, 0); }
+
+private:
+  /**< @brief 上位ビット列で位置pos以降の最初の1の位置を返す */
+  std::size_t next_one(std::size_t pos) const noexcept {
+    std::size_t w = pos / word_bits;
+    word_t x = upper_.word(w) & (~word_t(0) << (pos % word_bits));
+    while (x == 0) {
+      x = upper_.word(++w);
+    }
+    return w * word_bits + bit::ntz(x);
+  }
+
+  /**< @brief 上位ビット列での位置がposであるi番目の要素を返す */
+  value_t value(std::size_t i, std::size_t pos) const noexcept {
+    return (static_cast<value_t>(pos - i) << l_) | low(i);
+  }
+
+  /**< @brief i番目の要素の下位lビットを返す */
+  value_t low(std::size_t i) const noexcept {
+    if (l_ == 0) {
+      return 0;
+    }
+    const std::size_t b = i * l_, w = b / word_bits, o = b % word_bits;
+    word_t x = lower_[w] >> o;
+    if (o + l_ > word_bits) {
+      x |= lower_[w + 1] << (word_bits - o);
+    }
+    return x & ((word_t(1) << l_) - 1);
+  }
+
+  /**< @brief i番目の要素の下位lビットにxの下位lビットを書き込む */
+  void set_low(std::size_t i, value_t x) noexcept {
+    if (l_ == 0) {
+      return;
+    }
+    x &= (word_t(1) << l_) - 1;
+    const std::size_t b = i * l_, w = b / word_bits, o = b % word_bits;
+    lower_[w] |= x << o;
+    if (o + l_ > word_bits) {
+      lower_[w + 1] |= x >> (word_bits - o);
+    }
+  }
+
+private:
+  std::size_t n_ = 0;           /**< 要素数 */
+  value_t u_ = 0;               /**< 値の上限 */
+  std::size_t l_ = 0;           /**< 下位ビットの幅 */
+  rank_select_bitvector upper_; /**< 上位ビット列 */
+  std::vector<word_t> lower_;   /**< 下位ビットの配列 */
+};
+
+} // namespace container
+
+#endif // ELIAS_FANO_HPP
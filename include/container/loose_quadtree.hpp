@@ -0,0 +1,451 @@
+/**
+ * @brief  ルーズ四分木
+ * @note   ルーズ四分木(loose quadtree)は各節点の境界を本来の2倍に広げた四分木である
+ *         深さdの節点の本来の半径をH/2^dとすると、半径がH/2^d以下で、中心が
+ *         本来の境界に含まれる要素は広げた境界に必ず収まる. したがって要素を
+ *         格納する節点は要素の大きさと中心だけからΟ(1)で決まり、境界を跨ぐ
+ *         要素を根付近に溜めこむ通常の四分木の欠点が解消される
+ *
+ * @note   節点は必要になったときにだけ作られ、空になれば解放されるため、
+ *         オブジェクトが疎に分布する広い世界に向いている
+ *         挿入、削除、移動は木の深さをDとしてΟ(D)
+ */
+
+#ifndef LOOSE_QUADTREE_HPP
+#define LOOSE_QUADTREE_HPP
+
+#include "container.hpp"
+#include "spatial.hpp"
+#include <algorithm>
+#include <array>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace container {
+
+template <class T, class Float> struct loose_quadtree_node;
+
+template <class T, class Float> struct loose_quadtree_item {
+  loose_quadtree_item *prev;            /**< 節点内の前の要素 */
+  loose_quadtree_item *next;            /**< 節点内の次の要素 */
+  loose_quadtree_node<T, Float> *owner; /**< 要素を格納している節点 */
+  aabb2<Float> b;                       /**< 境界ボックス */
+  T v;                                  /**< 付属データ */
+
+  constexpr explicit loose_quadtree_item(const aabb2<Float> &b,
+                                         const T &v) noexcept
+      : prev(nullptr), next(nullptr), owner(nullptr), b(b), v(v) {}
+};
+
+template <class T, class Float> struct loose_quadtree_node {
+  using depth_t = std::int32_t;
+  loose_quadtree_node *parent;            /**< 親 */
+  std::array<loose_quadtree_node *, 4> c; /**< 子(象限の順) */
+  loose_quadtree_item<T, Float> *head;    /**< 格納している要素 */
+  std::size_t count;                      /**< 部分木に含まれる要素数 */
+  point2<Float> center;                   /**< 本来の境界の中心 */
+  Float half;                             /**< 本来の境界の半径 */
+  depth_t depth;                          /**< 深さ */
+
+  constexpr explicit loose_quadtree_node(loose_quadtree_node *parent,
+                                         const point2<Float> &center,
+                                         Float half, depth_t depth) noexcept
+      : parent(parent), c{}, head(nullptr), count(0), center(center),
+        half(half), depth(depth) {}
+
+  /**< @brief 2倍に広げた境界 */
+  constexpr aabb2<Float> loose() const noexcept {
+    return aabb2<Float>::from_circle(center, half * Float(2));
+  }
+};
+
+/**
+ * @brief  ルーズ四分木
+ * @tparam T         付属データの型
+ * @tparam Float     座標の型
+ * @tparam Allocator アロケータの型
+ */
+template <class T, class Float = float,
+          class Allocator = boost::container::pmr::polymorphic_allocator<
+              loose_quadtree_item<T, Float>>>
+struct loose_quadtree {
+  static_assert(std::is_nothrow_constructible_v<T>);
+  using alloc = std::allocator_traits<Allocator>;
+  using item = loose_quadtree_item<T, Float>;
+  using node = loose_quadtree_node<T, Float>;
+  using node_allocator = typename alloc::template rebind_alloc<node>;
+  using node_alloc = std::allocator_traits<node_allocator>;
+  using depth_t = typename node::depth_t;
+  using handle_t = std::size_t;
+  using point_t = point2<Float>;
+  using aabb_t = aabb2<Float>;
+
+  /**
+   * @param aabb_t      world 世界の境界(正方形に広げられる)
+   * @param std::size_t n     格納できる要素数の上限
+   * @param depth_t     d     木の深さの上限
+   * @param std::size_t m     節点数の上限(0のときn * d + 1)
+   * @note  要素1個で根以外の節点が最大d個できるので、n * d + 1個あれば足りない事はない。
+   *        小さな要素が散らばるほど節点が増える。mを小さく取った場合、節点が尽きると
+   *        要素を途中の浅い節点に置く(結果は正しいが検索は遅くなる)
+   */
+  explicit loose_quadtree(const aabb_t &world, std::size_t n = 32,
+                          depth_t d = 8, std::size_t m = 0)
+      : world_(world), max_depth_(d) {
+    allocate_pool(n, m == 0 ? n * static_cast<std::size_t>(d) + 1 : m);
+    const point_t c = world.center();
+    root_ = create_node(nullptr, c, world.half_extent(), 0);
+    world_ = aabb_t::from_circle(c, root_->half);
+  }
+  ~loose_quadtree() noexcept { free_pool(); } // 確保した記憶領域の解放
+
+  loose_quadtree(const loose_quadtree &) = delete;
+  loose_quadtree &operator=(const loose_quadtree &) = delete;
+
+  /**
+   * @brief  境界ボックスbと付属データvを持つ要素を挿入する
+   * @note   実行時間はΟ(D)
+   * @return 挿入した要素のハンドル
+   */
+  handle_t insert(const aabb_t &b, const T &v) {
+    item *x = create_item(b, v);
+    link(x);
+    return handle(x);
+  }
+
+  /**
+   * @brief  ハンドルhの要素を削除する
+   * @note   実行時間はΟ(D)
+   * @return 削除した要素の付属データ
+   */
+  std::optional<T> erase(handle_t h) {
+    item *x = at(h);
+    std::optional<T> opt = std::make_optional(x->v);
+    unlink(x);
+    destroy_item(x);
+    return opt;
+  }
+
+  /**
+   * @brief ハンドルhの要素の境界ボックスをbに更新する
+   * @note  格納すべき節点が変わらなければ境界を書き換えるだけで済む
+   */
+  void move(handle_t h, const aabb_t &b) {
+    item *x = at(h);
+    if (fits(x->owner, b)) {
+      x->b = b;
+      return;
+    }
+    unlink(x);
+    x->b = b;
+    link(x);
+  }
+
+  /**< @brief ハンドルhの要素の境界ボックスを返す */
+  const aabb_t &bounds(handle_t h) const { return at(h)->b; }
+  /**< @brief ハンドルhの要素の付属データを返す */
+  T &value(handle_t h) { return at(h)->v; }
+  const T &value(handle_t h) const { return at(h)->v; }
+
+  /**< @brief 要素数を返す */
+  constexpr std::size_t size() const noexcept { return size_; }
+  /**< @brief 空かどうかを返す */
+  constexpr bool empty() const noexcept { return size_ == 0; }
+  /**< @brief 満杯かどうかを返す */
+  constexpr bool full() const noexcept { return size_ >= cap_; }
+
+  /**
+   * @brief  中心c、半径rの円と重なる要素を列挙する
+   * @tparam F handle_t, const T&を引数に取る関数オブジェクトの型
+   */
+  template <class F> void query_radius(const point_t &c, Float r, F fn) const {
+    visit(root_, [&](const aabb_t &b) { return overlaps(b, c, r); },
+          [&](const item *x) { fn(handle(x), x->v); });
+  }
+
+  /**
+   * @brief  境界ボックスbと重なる要素を列挙する
+   * @tparam F handle_t, const T&を引数に取る関数オブジェクトの型
+   */
+  template <class F> void query_aabb(const aabb_t &b, F fn) const {
+    visit(root_, [&](const aabb_t &y) { return overlaps(b, y); },
+          [&](const item *x) { fn(handle(x), x->v); });
+  }
+
+  /**
+   * @brief  複数の中心[first, last)について半径rの探索をまとめて行う
+   * @note   木を1度だけ巡回し、各節点では広げた境界と重なる問い合わせだけを
+   *         子に引き継ぐ. 問い合わせ毎に根から辿り直すより節点の訪問が少ない
+   * @tparam InputIt point_tを指すイテレータの型
+   * @tparam F       std::size_t(問い合わせの添字), handle_t, const T&を
+   *                 引数に取る関数オブジェクトの型
+   */
+  template <class InputIt, class F>
+  void query_radius(InputIt first, InputIt last, Float r, F fn) const {
+    const std::vector<point_t> qs(first, last);
+    batch(qs.size(),
+          [&](std::size_t i, const aabb_t &b) { return overlaps(b, qs[i], r); },
+          [&](std::size_t i, const item *x) { fn(i, handle(x), x->v); });
+  }
+
+  /**
+   * @brief  複数の境界ボックス[first, last)についての探索をまとめて行う
+   * @tparam InputIt aabb_tを指すイテレータの型
+   * @tparam F       std::size_t(問い合わせの添字), handle_t, const T&を
+   *                 引数に取る関数オブジェクトの型
+   */
+  template <class InputIt, class F>
+  void query_aabb(InputIt first, InputIt last, F fn) const {
+    const std::vector<aabb_t> qs(first, last);
+    batch(qs.size(),
+          [&](std::size_t i, const aabb_t &b) { return overlaps(qs[i], b); },
+          [&](std::size_t i, const item *x) { fn(i, handle(x), x->v); });
+  }
+
+private:
+  /**
+   * @brief 境界ボックスbを格納すべき深さを返す
+   * @note  半径eの要素は本来の半径がe以上である最も深い節点に格納する
+   */
+  depth_t depth_of(const aabb_t &b) const noexcept {
+    const Float e = b.half_extent();
+    if (!(e > Float(0))) {
+      return max_depth_;
+    }
+    const Float d = std::floor(std::log2(root_->half / e));
+    return d < Float(0) ? 0
+                        : static_cast<depth_t>(std::min(d, Float(max_depth_)));
+  }
+
+  /**< @brief 点pが節点xの本来の境界で何番目の象限にあるかを返す */
+  static std::size_t quadrant(const node *x, const point_t &p) noexcept {
+    return (p.x < x->center.x ? 0 : 1) | (p.y < x->center.y ? 0 : 2);
+  }
+
+  /**< @brief 境界ボックスbを節点xに格納してよいかどうか */
+  bool fits(const node *x, const aabb_t &b) const noexcept {
+    const point_t c = b.center();
+    if (!contains(world_, c)) {
+      return x == root_; // 世界の外に中心がある要素は根に置く
+    }
+    return x->depth == depth_of(b) &&
+           contains(aabb_t::from_circle(x->center, x->half), c);
+  }
+
+  /**
+   * @brief 要素xを格納すべき節点に繋ぐ(途中の節点は必要に応じて作る)
+   * @note  節点が尽きたときはそこで止めて、その節点に繋ぐ
+   */
+  void link(item *x) {
+    const point_t c = x->b.center();
+    const depth_t d = contains(world_, c) ? depth_of(x->b) : 0;
+    node *y = root_;
+    y->count++;
+    while (y->depth < d) {
+      const std::size_t q = quadrant(y, c);
+      if (y->c[q] == nullptr) {
+        if (nodes_size_ >= nodes_cap_) {
+          break;
+        }
+        const Float h = y->half * Float(0.5);
+        const point_t cc{y->center.x + ((q & 1) ? h : -h),
+                         y->center.y + ((q & 2) ? h : -h)};
+        y->c[q] = create_node(y, cc, h, y->depth + 1);
+      }
+      y = y->c[q];
+      y->count++;
+    }
+    x->owner = y;
+    x->prev = nullptr;
+    x->next = y->head;
+    if (y->head != nullptr) {
+      y->head->prev = x;
+    }
+    y->head = x;
+  }
+
+  /**< @brief 要素xを節点から外す(空になった節点は解放する) */
+  void unlink(item *x) noexcept {
+    node *y = x->owner;
+    if (x->prev != nullptr) {
+      x->prev->next = x->next;
+    } else {
+      y->head = x->next;
+    }
+    if (x->next != nullptr) {
+      x->next->prev = x->prev;
+    }
+    x->owner = nullptr;
+    while (y != nullptr) {
+      node *p = y->parent;
+      if (--y->count == 0 && p != nullptr) {
+        std::replace(p->c.begin(), p->c.end(), y, static_cast<node *>(nullptr));
+        destroy_node(y);
+      }
+      y = p;
+    }
+  }
+
+  /**
+   * @brief 節点xを根とする部分木のうち、広げた境界がhitを満たす節点の要素を列挙する
+   * @note  根は世界の外に中心がある要素を持ちうるので常に調べる
+   */
+  template <class Hit, class F>
+  void visit(const node *x, Hit hit, F fn) const {
+    if (x == nullptr || x->count == 0 || (x != root_ && !hit(x->loose()))) {
+      return;
+    }
+    for (const item *y = x->head; y != nullptr; y = y->next) {
+      if (hit(y->b)) {
+        fn(y);
+      }
+    }
+    for (const node *y : x->c) {
+      visit(y, hit, fn);
+    }
+  }
+
+  /**< @brief q個の問い合わせを1度の巡回で処理する */
+  template <class Hit, class F>
+  void batch(std::size_t q, Hit hit, F fn) const {
+    std::vector<std::size_t> active(q);
+    for (std::size_t i = 0; i < q; i++) {
+      active[i] = i;
+    }
+    batch(root_, active, hit, fn);
+  }
+
+  template <class Hit, class F>
+  void batch(const node *x, const std::vector<std::size_t> &qs, Hit hit,
+             F fn) const {
+    for (const item *y = x->head; y != nullptr; y = y->next) {
+      for (std::size_t i : qs) {
+        if (hit(i, y->b)) {
+          fn(i, y);
+        }
+      }
+    }
+    for (const node *y : x->c) {
+      if (y == nullptr || y->count == 0) {
+        continue;
+      }
+      const aabb_t b = y->loose();
+      std::vector<std::size_t> sub;
+      std::copy_if(qs.begin(), qs.end(), std::back_inserter(sub),
+                   [&](std::size_t i) { return hit(i, b); });
+      if (!sub.empty()) {
+        batch(y, sub, hit, fn);
+      }
+    }
+  }
+
+  handle_t handle(const item *x) const noexcept {
+    return static_cast<handle_t>(x - items_);
+  }
+  item *at(handle_t h) const {
+    BOOST_ASSERT_MSG(h < cap_, "Invalid loose quadtree handle.");
+    return items_ + h;
+  }
+
+private:
+  /**< @brief 要素xの記憶領域の確保を行う */
+  item *create_item(const aabb_t &b, const T &v) {
+    BOOST_ASSERT_MSG(!full(), "Loose quadtree capacity over.");
+    item *x = items_ + free_items_[size_];
+    alloc::construct(alloc_, x, b, v);
+    size_++;
+    return x;
+  }
+
+  /**< @brief 要素xの記憶領域の解放を行う */
+  void destroy_item(item *x) noexcept {
+    alloc::destroy(alloc_, x);
+    free_items_[--size_] = handle(x);
+  }
+
+  /**< @brief 節点の記憶領域の確保を行う */
+  node *create_node(node *parent, const point_t &c, Float half, depth_t d) {
+    BOOST_ASSERT_MSG(nodes_size_ < nodes_cap_,
+                     "Loose quadtree node capacity over.");
+    node *x = nodes_ + free_nodes_[nodes_size_];
+    node_alloc::construct(node_alloc_, x, parent, c, half, d);
+    nodes_size_++;
+    return x;
+  }
+
+  /**< @brief 節点xの記憶領域の解放を行う */
+  void destroy_node(node *x) noexcept {
+    node_alloc::destroy(node_alloc_, x);
+    free_nodes_[--nodes_size_] = static_cast<std::size_t>(x - nodes_);
+  }
+
+  /**< @brief 節点xを根とした部分木を要素ごと再帰的に解放する */
+  void postorder_destroy_nodes(node *x) noexcept {
+    if (x == nullptr) {
+      return;
+    }
+    for (node *y : x->c) {
+      postorder_destroy_nodes(y);
+    }
+    for (item *y = x->head, *z; y != nullptr; y = z) {
+      z = y->next;
+      alloc::destroy(alloc_, y);
+    }
+    node_alloc::destroy(node_alloc_, x);
+  }
+
+  /**< @brief メモリプールの解放 */
+  void free_pool() noexcept {
+    postorder_destroy_nodes(root_);
+    alloc::deallocate(alloc_, items_, cap_);
+    node_alloc::deallocate(node_alloc_, nodes_, nodes_cap_);
+    root_ = nullptr;
+    items_ = nullptr;
+    nodes_ = nullptr;
+    size_ = cap_ = nodes_size_ = nodes_cap_ = 0;
+  }
+
+  /**< @brief メモリプールの確保 */
+  void allocate_pool(std::size_t n, std::size_t m) {
+    items_ = alloc::allocate(alloc_, n);
+    cap_ = n;
+    nodes_ = node_alloc::allocate(node_alloc_, m);
+    nodes_cap_ = m;
+    free_items_.resize(n);
+    for (std::size_t i = 0; i < n; i++) {
+      free_items_[i] = i;
+    }
+    free_nodes_.resize(m);
+    for (std::size_t i = 0; i < m; i++) {
+      free_nodes_[i] = i;
+    }
+  }
+
+private:
+  using index_alloc = typename alloc::template rebind_alloc<std::size_t>;
+
+  aabb_t world_;                                     /**< 世界の境界 */
+  depth_t max_depth_;                                /**< 木の深さの上限 */
+  node *root_ = nullptr;                             /**< 根 */
+  std::vector<std::size_t, index_alloc> free_items_; /**< 要素の割当表 */
+  std::vector<std::size_t, index_alloc> free_nodes_; /**< 節点の割当表 */
+  std::size_t cap_ = 0;                              /**< 要素のバッファサイズ */
+  std::size_t size_ = 0;                             /**< 要素数 */
+  std::size_t nodes_cap_ = 0;                        /**< 節点のバッファサイズ */
+  std::size_t nodes_size_ = 0;                       /**< 節点数 */
+  item *items_ = nullptr;                            /**< 要素用メモリプール */
+  node *nodes_ = nullptr;                            /**< 節点用メモリプール */
+  Allocator alloc_;                                  /**< アロケータ */
+  node_allocator node_alloc_;                        /**< 節点用アロケータ */
+};
+
+} // namespace container
+
+#endif // LOOSE_QUADTREE_HPP
@@ -0,0 +1,410 @@
+/**
+ * @brief  容量制限付きキャッシュ(LRU/CLOCK)
+ * @note   キーの索引には線形探査法による開番地法のハッシュ表を、
+ *         置換順序の管理には要素に埋め込んだ(intrusive)循環双方向連結リストを用いる
+ *         検索、挿入、削除、追い出しはいずれも期待Ο(1)
+ *
+ * @note   LRU(least recently used)はヒットのたびに要素をリストの先頭へ繋ぎ直し、
+ *         末尾から追い出す
+ *         CLOCKはヒット時に参照ビットを立てるだけでリストを繋ぎ直さない.
+ *         追い出し時に針(hand)を進め、参照ビットが立っていればそれを降ろして
+ *         次へ、降りていればその要素を追い出す. LRUの近似だが、ヒット時の
+ *         書き込みが1ビットで済むため読み込みが多い場合に有利である
+ */
+
+#ifndef LRU_CACHE_HPP
+#define LRU_CACHE_HPP
+
+#include "container.hpp"
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace container {
+
+/**< @brief LRU置換方式を表すタグ */
+struct lru_policy {};
+/**< @brief CLOCK置換方式を表すタグ */
+struct clock_policy {};
+
+/**
+ * @brief 要素1つを重さ1と数える重み関数
+ * @note  予算は要素数の上限となる
+ */
+template <class Key, class T> struct unit_weigher {
+  constexpr std::size_t operator()(const Key &, const T &) const noexcept {
+    return 1;
+  }
+};
+
+/**
+ * @brief 要素のおおよそのバイト数を重さとする重み関数
+ * @note  size()とvalue_typeを持つ型(std::string, std::vectorなど)は
+ *        その中身のバイト数も加える
+ */
+template <class Key, class T> struct byte_weigher {
+  constexpr std::size_t operator()(const Key &k, const T &v) const noexcept {
+    return bytes(k) + bytes(v);
+  }
+
+private:
+  template <class U> static constexpr std::size_t bytes(const U &u) noexcept {
+    if constexpr (has_size<U>::value) {
+      return sizeof(U) + u.size() * sizeof(typename U::value_type);
+    } else {
+      return sizeof(U);
+    }
+  }
+  template <class U, class = std::void_t<>>
+  struct has_size : public std::false_type {};
+  template <class U>
+  struct has_size<U, std::void_t<decltype(std::declval<U>().size()),
+                                 typename U::value_type>>
+      : public std::true_type {};
+};
+
+template <class Key, class T> struct cache_node {
+  cache_node *prev; /**< リスト内の前の要素 */
+  cache_node *next; /**< リスト内の次の要素 */
+  std::size_t h;    /**< キーのハッシュ値 */
+  std::size_t w;    /**< 重さ */
+  bool ref;         /**< 参照ビット(CLOCKのみ使用) */
+  Key key;          /**< キー */
+  T v;              /**< 付属データ */
+
+  constexpr explicit cache_node(std::size_t h, std::size_t w, const Key &k,
+                                const T &v) noexcept
+      : prev(this), next(this), h(h), w(w), ref(false), key(k), v(v) {}
+};
+
+/**
+ * @brief  容量制限付きキャッシュ
+ * @tparam Key       キーの型
+ * @tparam T         付属データの型
+ * @tparam Policy    置換方式(lru_policyまたはclock_policy)
+ * @tparam Weigher   Key, Tを引数に取り重さを返す関数オブジェクトの型
+ * @tparam Hash      キーのハッシュ関数の型
+ * @tparam KeyEqual  キーの同値判定の型
+ * @tparam Allocator アロケータの型
+ */
+template <class Key, class T, class Policy = lru_policy,
+          class Weigher = byte_weigher<Key, T>, class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class Allocator =
+              boost::container::pmr::polymorphic_allocator<cache_node<Key, T>>>
+struct cache {
+  static_assert(std::is_same_v<Policy, lru_policy> ||
+                    std::is_same_v<Policy, clock_policy>,
+                "Policy must be lru_policy or clock_policy.");
+  using alloc = std::allocator_traits<Allocator>;
+  using node = cache_node<Key, T>;
+
+  /**
+   * @param std::size_t n      格納できる要素数の上限
+   * @param std::size_t budget 重さの合計の上限(Weigherの単位, 既定は無制限)
+   */
+  explicit cache(std::size_t n = 32,
+                 std::size_t budget = std::numeric_limits<std::size_t>::max())
+      : budget_(budget) {
+    allocate_pool(n);
+  }
+  ~cache() noexcept { free_pool(); } // 確保した記憶領域の解放
+
+  cache(const cache &) = delete;
+  cache &operator=(const cache &) = delete;
+
+  /**
+   * @brief  キーkに対応する付属データを返す
+   * @note   LRUでは要素をリストの先頭へ移し、CLOCKでは参照ビットを立てる
+   * @return キーkに対応する付属データ
+   */
+  std::optional<T> get(const Key &k) {
+    node *x = find(k);
+    if (x == nullptr) {
+      misses_++;
+      return std::nullopt;
+    }
+    hits_++;
+    touch(x);
+    return std::make_optional(x->v);
+  }
+
+  /**
+   * @brief  置換順序を変えず、統計も取らずにキーkが含まれるかどうか返す
+   */
+  bool contains(const Key &k) const { return find(k) != nullptr; }
+
+  /**
+   * @brief  キーkに付属データvを対応づける
+   * @note   予算や容量を超える場合は置換方式に従って要素を追い出す
+   *         重さが予算を超える要素はキャッシュしない
+   * @return キーkに対応していた付属データ
+   */
+  std::optional<T> put(const Key &k, const T &v) {
+    std::optional<T> opt = erase(k);
+    const std::size_t w = weigh_(k, v);
+    if (w > budget_) {
+      return opt;
+    }
+    while (size_ > 0 && (full() || weight_ + w > budget_)) {
+      evict();
+    }
+    node *x = create_node(hash_(k), w, k, v);
+    insert_index(x);
+    link(x);
+    weight_ += w;
+    return opt;
+  }
+
+  /**
+   * @brief  キーkを持つ要素を削除する
+   * @return キーkに対応していた付属データ
+   */
+  std::optional<T> erase(const Key &k) {
+    node *x = find(k);
+    if (x == nullptr) {
+      return std::nullopt;
+    }
+    std::optional<T> opt = std::make_optional(std::move(x->v));
+    remove(x);
+    return opt;
+  }
+
+  /**< @brief 全ての要素を削除する(統計は残す) */
+  void clear() noexcept {
+    while (size_ > 0) {
+      remove(head_);
+    }
+  }
+
+  /**< @brief 要素数を返す */
+  constexpr std::size_t size() const noexcept { return size_; }
+  /**< @brief 空かどうかを返す */
+  constexpr bool empty() const noexcept { return size_ == 0; }
+  /**< @brief 要素数が上限に達しているかどうか返す */
+  constexpr bool full() const noexcept { return size_ >= cap_; }
+  /**< @brief 重さの合計を返す */
+  constexpr std::size_t weight() const noexcept { return weight_; }
+  /**< @brief 重さの合計の上限を返す */
+  constexpr std::size_t budget() const noexcept { return budget_; }
+
+  /**< @brief ヒット数を返す */
+  constexpr std::uint64_t hits() const noexcept { return hits_; }
+  /**< @brief ミス数を返す */
+  constexpr std::uint64_t misses() const noexcept { return misses_; }
+  /**< @brief 追い出した要素数を返す */
+  constexpr std::uint64_t evictions() const noexcept { return evictions_; }
+  /**< @brief ヒット数、ミス数、追い出した要素数を0に戻す */
+  void reset_stats() noexcept { hits_ = misses_ = evictions_ = 0; }
+
+private:
+  /**< @brief 要素xを参照されたものとして扱う */
+  void touch(node *x) noexcept {
+    if constexpr (std::is_same_v<Policy, lru_policy>) {
+      if (x != head_) {
+        unlink(x);
+        link(x);
+      }
+    } else {
+      x->ref = true;
+    }
+  }
+
+  /**
+   * @brief 要素xをリストに繋ぐ
+   * @note  LRUでは先頭に、CLOCKでは針の直前(針が最後に辿り着く位置)に繋ぐ
+   *        どちらも循環リストでhead_の直前に挿入する操作になる
+   */
+  void link(node *x) noexcept {
+    if (head_ == nullptr) {
+      x->prev = x->next = x;
+      head_ = x;
+      return;
+    }
+    x->next = head_;
+    x->prev = head_->prev;
+    head_->prev->next = x;
+    head_->prev = x;
+    if constexpr (std::is_same_v<Policy, lru_policy>) {
+      head_ = x;
+    }
+  }
+
+  /**< @brief 要素xをリストから外す */
+  void unlink(node *x) noexcept {
+    if (x->next == x) {
+      head_ = nullptr;
+      return;
+    }
+    x->prev->next = x->next;
+    x->next->prev = x->prev;
+    if (head_ == x) {
+      head_ = x->next;
+    }
+  }
+
+  /**< @brief 置換方式に従って要素を1つ追い出す */
+  void evict() noexcept {
+    if constexpr (std::is_same_v<Policy, lru_policy>) {
+      remove(head_->prev); // 最も長く参照されていない要素
+    } else {
+      while (head_->ref) { // 参照ビットを降ろしながら針を進める
+        head_->ref = false;
+        head_ = head_->next;
+      }
+      remove(head_);
+    }
+    evictions_++;
+  }
+
+  /**< @brief 要素xを索引とリストから外して解放する */
+  void remove(node *x) noexcept {
+    erase_index(x);
+    unlink(x);
+    weight_ -= x->w;
+    destroy_node(x);
+  }
+
+private:
+  /**< @brief キーkを持つ要素を索引から探す */
+  node *find(const Key &k) const {
+    const std::size_t mask = index_.size() - 1;
+    const std::size_t h = hash_(k);
+    for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+      node *x = index_[i];
+      if (x == nullptr) {
+        return nullptr;
+      }
+      if (x->h == h && eq_(x->key, k)) {
+        return x;
+      }
+    }
+  }
+
+  /**< @brief 要素xを索引に加える */
+  void insert_index(node *x) noexcept {
+    const std::size_t mask = index_.size() - 1;
+    std::size_t i = x->h & mask;
+    while (index_[i] != nullptr) {
+      i = (i + 1) & mask;
+    }
+    index_[i] = x;
+  }
+
+  /**
+   * @brief 要素xを索引から外す
+   * @note  墓標(tombstone)を残さず、後続の要素を本来の位置に近づくよう詰め直す
+   *        (backward shift deletion). 探索長が削除の繰り返しで伸びることがない
+   */
+  void erase_index(node *x) noexcept {
+    const std::size_t mask = index_.size() - 1;
+    std::size_t i = x->h & mask;
+    while (index_[i] != x) {
+      i = (i + 1) & mask;
+    }
+    for (std::size_t j = (i + 1) & mask;; j = (j + 1) & mask) {
+      node *y = index_[j];
+      if (y == nullptr) {
+        break;
+      }
+      const std::size_t k = y->h & mask; // yの本来の位置
+      // kが巡回区間(i, j]に含まれなければ、yをiへ詰めてよい
+      if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j))) {
+        index_[i] = y;
+        i = j;
+      }
+    }
+    index_[i] = nullptr;
+  }
+
+private:
+  /**< @brief 要素xの記憶領域の確保を行う */
+  node *create_node(std::size_t h, std::size_t w, const Key &k, const T &v) {
+    BOOST_ASSERT_MSG(!full(), "Cache capacity over.");
+    node *x = pool_ + free_[size_];
+    alloc::construct(alloc_, x, h, w, k, v);
+    size_++;
+    return x;
+  }
+
+  /**< @brief 要素xの記憶領域の解放を行う */
+  void destroy_node(node *x) noexcept {
+    alloc::destroy(alloc_, x);
+    free_[--size_] = static_cast<std::size_t>(x - pool_);
+  }
+
+  /**< @brief メモリプールの解放 */
+  void free_pool() noexcept {
+    clear();
+    alloc::deallocate(alloc_, pool_, cap_);
+    pool_ = nullptr;
+    size_ = cap_ = 0;
+  }
+
+  /**< @brief メモリプールと索引の確保(索引の大きさは2n以上の2の冪) */
+  void allocate_pool(std::size_t n) {
+    BOOST_ASSERT_MSG(n > 0, "Cache capacity must be positive.");
+    pool_ = alloc::allocate(alloc_, n);
+    cap_ = n;
+    free_.resize(n);
+    for (std::size_t i = 0; i < n; i++) {
+      free_[i] = i;
+    }
+    std::size_t m = 1;
+    while (m < (n << 1)) {
+      m <<= 1;
+    }
+    index_.assign(m, nullptr);
+  }
+
+private:
+  using index_alloc = typename alloc::template rebind_alloc<node *>;
+  using free_alloc = typename alloc::template rebind_alloc<std::size_t>;
+
+  std::vector<node *, index_alloc> index_;    /**< 開番地法の索引 */
+  std::vector<std::size_t, free_alloc> free_; /**< 添字の割当表 */
+  node *head_ = nullptr;                      /**< LRU: 先頭, CLOCK: 針 */
+  node *pool_ = nullptr;                      /**< 要素用メモリプール */
+  std::size_t cap_ = 0;                       /**< バッファサイズ */
+  std::size_t size_ = 0;                      /**< 要素数 */
+  std::size_t weight_ = 0;                    /**< 重さの合計 */
+  std::size_t budget_;                        /**< 重さの合計の上限 */
+  std::uint64_t hits_ = 0;                    /**< ヒット数 */
+  std::uint64_t misses_ = 0;                  /**< ミス数 */
+  std::uint64_t evictions_ = 0;               /**< 追い出した要素数 */
+  Weigher weigh_;                             /**< 重み関数 */
+  Hash hash_;                                 /**< ハッシュ関数 */
+  KeyEqual eq_;                               /**< 同値判定 */
+  Allocator alloc_;                           /**< アロケータ */
+};
+
+/**
+ * @brief  LRUキャッシュ
+ * @tparam Key     キーの型
+ * @tparam T       付属データの型
+ * @tparam Weigher 重み関数の型
+ */
+template <class Key, class T, class Weigher = byte_weigher<Key, T>,
+          class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+using lru_cache = cache<Key, T, lru_policy, Weigher, Hash, KeyEqual>;
+
+/**
+ * @brief  CLOCKキャッシュ
+ * @tparam Key     キーの型
+ * @tparam T       付属データの型
+ * @tparam Weigher 重み関数の型
+ */
+template <class Key, class T, class Weigher = byte_weigher<Key, T>,
+          class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+using clock_cache = cache<Key, T, clock_policy, Weigher, Hash, KeyEqual>;
+
+} // namespace container
+
+#endif // LRU_CACHE_HPP
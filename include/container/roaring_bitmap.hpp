@@ -0,0 +1,654 @@
+/**
+ * @brief  圧縮ビットマップ(Roaring bitmap)
+ * @note   32ビット整数の集合を上位16ビット(チャンク)毎に分け、各チャンクの下位16ビットを
+ *         要素数と分布に応じて次の3種類のコンテナのいずれかで持つ
+ *         - 配列コンテナ    : 要素数が4096以下のとき、下位16ビットの整列済み配列
+ *         - ビットマップコンテナ: 要素数が4096を超えるとき、2^16ビット(8KB)の固定長ビット列
+ *         - 連長コンテナ    : 連続区間(開始, 長さ - 1)の列. run_optimize()で選ばれる
+ *         疎な集合は配列に、密な集合はビットマップに、連続した集合は連長に収まるため、
+ *         どのような分布でも密なビット集合や整列済み配列より小さくなりやすい
+ *
+ * @note   ビットマップ同士の論理演算と要素数はbit::bulkのカーネルで計算する
+ *         (AVX2が使えるかどうかは実行時に判定する)
+ *
+ * @note   Reference: D. Lemire et al., "Consistently faster and smaller
+ * compressed bitmaps with Roaring", Software: Practice and Experience, 2016.
+ */
+
+#ifndef ROARING_BITMAP_HPP
+#define ROARING_BITMAP_HPP
+
+#include "bit/bit.hpp"
+#include "bit/bulk.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace container {
+
+namespace impl {
+
+/**< @brief 配列コンテナの要素数の上限 */
+constexpr std::uint32_t roaring_array_max = 4096;
+/**< @brief ビットマップコンテナの語数(2^16ビット) */
+constexpr std::size_t roaring_bitmap_words = 1024;
+
+/**< @brief 配列コンテナ */
+struct roaring_array {
+  std::vector<std::uint16_t> v; /**< 整列済みの下位16ビット */
+};
+
+/**< @brief ビットマップコンテナ */
+struct roaring_bits {
+  std::vector<std::uint64_t> w =
+      std::vector<std::uint64_t>(roaring_bitmap_words, 0); /**< ビット列 */
+  std::uint32_t card = 0;                                  /**< 要素数 */
+};
+
+/**< @brief 連長コンテナ */
+struct roaring_runs {
+  struct run {
+    std::uint16_t start;  /**< 区間の先頭 */
+    std::uint16_t length; /**< 区間の長さ - 1 */
+    constexpr std::uint32_t last() const noexcept {
+      return std::uint32_t(start) + length;
+    }
+  };
+  std::vector<run> r; /**< 互いに素で隣接しない、整列済みの区間列 */
+};
+
+using roaring_container =
+    std::variant<roaring_array, roaring_bits, roaring_runs>;
+
+enum class roaring_op { and_, or_, andnot_ };
+
+/**
+ * @brief  ビットマップxにyとの論理演算を施して(x = x op y)、結果の要素数を返す
+ */
+template <roaring_op Op>
+inline std::uint32_t bitmap_op(std::uint64_t *x,
+                               const std::uint64_t *y) noexcept {
+  const std::span<std::uint64_t> xs(x, roaring_bitmap_words);
+  const std::span<const std::uint64_t> ys(y, roaring_bitmap_words);
+  if constexpr (Op == roaring_op::and_) {
+    bit::bulk::assign_and(xs, ys);
+  } else if constexpr (Op == roaring_op::or_) {
+    bit::bulk::assign_or(xs, ys);
+  } else {
+    bit::bulk::assign_andnot(xs, ys);
+  }
+  return static_cast<std::uint32_t>(bit::bulk::popcount(xs));
+}
+
+/**< @brief ビットマップwの[s, e]のビットを立てる(v = true)か降ろす */
+inline void bitmap_fill(std::uint64_t *w, std::uint32_t s, std::uint32_t e,
+                        bool v) noexcept {
+  const std::size_t ws = s / 64, we = e / 64;
+  const std::uint64_t ms = ~std::uint64_t(0) << (s % 64);
+  const std::uint64_t me = ~std::uint64_t(0) >> (63 - e % 64);
+  for (std::size_t i = ws; i <= we; i++) {
+    std::uint64_t m = ~std::uint64_t(0);
+    if (i == ws) {
+      m &= ms;
+    }
+    if (i == we) {
+      m &= me;
+    }
+    w[i] = v ? (w[i] | m) : (w[i] & ~m);
+  }
+}
+
+/**< @brief ビットマップwの要素を列挙する */
+template <class F> inline void bitmap_for_each(const std::uint64_t *w, F fn) {
+  for (std::size_t i = 0; i < roaring_bitmap_words; i++) {
+    for (std::uint64_t x = w[i]; x != 0; x &= x - 1) {
+      fn(static_cast<std::uint16_t>(i * 64 + bit::ntz(x)));
+    }
+  }
+}
+
+/**< @brief コンテナcの要素数を返す */
+inline std::uint32_t cardinality(const roaring_container &c) noexcept {
+  if (auto a = std::get_if<roaring_array>(&c)) {
+    return static_cast<std::uint32_t>(a->v.size());
+  }
+  if (auto b = std::get_if<roaring_bits>(&c)) {
+    return b->card;
+  }
+  std::uint32_t card = 0;
+  for (const auto &r : std::get<roaring_runs>(c).r) {
+    card += r.length + 1U;
+  }
+  return card;
+}
+
+/**< @brief コンテナcの要素を昇順に列挙する */
+template <class F> inline void for_each(const roaring_container &c, F fn) {
+  if (auto a = std::get_if<roaring_array>(&c)) {
+    std::for_each(a->v.begin(), a->v.end(), fn);
+  } else if (auto b = std::get_if<roaring_bits>(&c)) {
+    bitmap_for_each(b->w.data(), fn);
+  } else {
+    for (const auto &r : std::get<roaring_runs>(c).r) {
+      for (std::uint32_t x = r.start; x <= r.last(); x++) {
+        fn(static_cast<std::uint16_t>(x));
+      }
+    }
+  }
+}
+
+/**< @brief コンテナcをビットマップコンテナに変換する */
+inline roaring_bits to_bits(const roaring_container &c) {
+  if (auto b = std::get_if<roaring_bits>(&c)) {
+    return *b;
+  }
+  roaring_bits b;
+  if (auto rs = std::get_if<roaring_runs>(&c)) {
+    for (const auto &r : rs->r) {
+      bitmap_fill(b.w.data(), r.start, r.last(), true);
+    }
+  } else {
+    for (std::uint16_t x : std::get<roaring_array>(c).v) {
+      b.w[x / 64] |= std::uint64_t(1) << (x % 64);
+    }
+  }
+  b.card = cardinality(c);
+  return b;
+}
+
+/**< @brief ビットマップコンテナを要素数に応じて配列コンテナに戻す */
+inline roaring_container shrink(roaring_bits &&b) {
+  if (b.card > roaring_array_max) {
+    return roaring_container(std::move(b));
+  }
+  roaring_array a;
+  a.v.reserve(b.card);
+  bitmap_for_each(b.w.data(), [&](std::uint16_t x) { a.v.push_back(x); });
+  return roaring_container(std::move(a));
+}
+
+/**< @brief 整列済み配列を要素数に応じてビットマップコンテナに変える */
+inline roaring_container grow(std::vector<std::uint16_t> &&v) {
+  roaring_container c(roaring_array{std::move(v)});
+  if (cardinality(c) > roaring_array_max) {
+    return roaring_container(to_bits(c));
+  }
+  return c;
+}
+
+/**
+ * @brief 連長コンテナrsにxを加える(rsにxは含まれないこと)
+ * @note  前後の区間に接していれば伸ばし、両方に接していれば1つに繋ぐ
+ */
+inline void run_insert(roaring_runs &rs, std::uint16_t x) {
+  auto &r = rs.r;
+  auto it = std::upper_bound(
+      r.begin(), r.end(), x,
+      [](std::uint16_t v, const roaring_runs::run &r) { return v < r.start; });
+  const bool prev = it != r.begin() && std::prev(it)->last() + 1 == x;
+  const bool next = it != r.end() && std::uint32_t(x) + 1 == it->start;
+  if (prev && next) {
+    std::prev(it)->length =
+        static_cast<std::uint16_t>(it->last() - std::prev(it)->start);
+    r.erase(it);
+  } else if (prev) {
+    std::prev(it)->length++;
+  } else if (next) {
+    it->start = x;
+    it->length++;
+  } else {
+    r.insert(it, {x, 0});
+  }
+}
+
+/**
+ * @brief 連長コンテナrsからxを取り除く(rsにxが含まれること)
+ * @note  区間の途中なら2つに分ける
+ */
+inline void run_erase(roaring_runs &rs, std::uint16_t x) {
+  auto &r = rs.r;
+  auto it = std::prev(std::upper_bound(
+      r.begin(), r.end(), x,
+      [](std::uint16_t v, const roaring_runs::run &r) { return v < r.start; }));
+  const std::uint32_t last = it->last();
+  if (it->start == last) {
+    r.erase(it);
+  } else if (x == it->start) {
+    it->start++;
+    it->length--;
+  } else if (x == last) {
+    it->length--;
+  } else {
+    it->length = static_cast<std::uint16_t>(x - 1 - it->start);
+    r.insert(std::next(it),
+             {static_cast<std::uint16_t>(x + 1),
+              static_cast<std::uint16_t>(last - x - 1)});
+  }
+}
+
+/**
+ * @brief 連長コンテナcが配列(またはビットマップ)より大きくなったら、そちらに戻す
+ */
+inline void run_fit(roaring_container &c) {
+  const std::size_t runs = std::get<roaring_runs>(c).r.size();
+  if (runs * sizeof(roaring_runs::run) >
+      std::min<std::size_t>(roaring_bitmap_words * sizeof(std::uint64_t),
+                            cardinality(c) * sizeof(std::uint16_t))) {
+    c = shrink(to_bits(c));
+  }
+}
+
+/**< @brief コンテナcに下位16ビットxが含まれるかどうか */
+inline bool contains(const roaring_container &c, std::uint16_t x) noexcept {
+  if (auto a = std::get_if<roaring_array>(&c)) {
+    return std::binary_search(a->v.begin(), a->v.end(), x);
+  }
+  if (auto b = std::get_if<roaring_bits>(&c)) {
+    return (b->w[x / 64] >> (x % 64)) & 1;
+  }
+  const auto &r = std::get<roaring_runs>(c).r;
+  auto it = std::upper_bound(
+      r.begin(), r.end(), x,
+      [](std::uint16_t v, const roaring_runs::run &r) { return v < r.start; });
+  return it != r.begin() && x <= std::prev(it)->last();
+}
+
+/**
+ * @brief 整列済み配列aとbの積集合を求める
+ * @note  要素数の比が大きいときは小さい方の各要素を大きい方から指数探索(galloping)する
+ */
+inline std::vector<std::uint16_t>
+intersect(const std::vector<std::uint16_t> &a,
+          const std::vector<std::uint16_t> &b) {
+  std::vector<std::uint16_t> out;
+  const auto &s = a.size() <= b.size() ? a : b;
+  const auto &l = a.size() <= b.size() ? b : a;
+  if (s.size() * 64 < l.size()) {
+    auto it = l.begin();
+    for (std::uint16_t x : s) {
+      std::size_t step = 1; // x以上の要素に届くまで幅を倍にしながら進む
+      auto hi = it;
+      while (hi != l.end() && *hi < x) {
+        it = hi;
+        hi = static_cast<std::size_t>(l.end() - hi) > step ? hi + step
+                                                            : l.end();
+        step <<= 1;
+      }
+      it = std::lower_bound(it, hi, x);
+      if (it == l.end()) {
+        break;
+      }
+      if (*it == x) {
+        out.push_back(x);
+      }
+    }
+    return out;
+  }
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(out));
+  return out;
+}
+
+/**< @brief 連長コンテナ同士の演算 */
+template <roaring_op Op>
+inline roaring_runs run_op(const roaring_runs &a, const roaring_runs &b) {
+  roaring_runs out;
+  auto emit = [&](std::uint32_t s, std::uint32_t e) { // [s, e]を追加する
+    if (!out.r.empty() && out.r.back().last() + 1 >= s) {
+      const std::uint32_t l = std::max(out.r.back().last(), e);
+      out.r.back().length = static_cast<std::uint16_t>(l - out.r.back().start);
+    } else {
+      out.r.push_back({static_cast<std::uint16_t>(s),
+                       static_cast<std::uint16_t>(e - s)});
+    }
+  };
+  if constexpr (Op == roaring_op::or_) {
+    std::size_t i = 0, j = 0;
+    while (i < a.r.size() || j < b.r.size()) {
+      const bool take_a =
+          j == b.r.size() || (i < a.r.size() && a.r[i].start <= b.r[j].start);
+      const auto &r = take_a ? a.r[i++] : b.r[j++];
+      emit(r.start, r.last());
+    }
+  } else if constexpr (Op == roaring_op::and_) {
+    std::size_t i = 0, j = 0;
+    while (i < a.r.size() && j < b.r.size()) {
+      const std::uint32_t s =
+          std::max<std::uint32_t>(a.r[i].start, b.r[j].start);
+      const std::uint32_t e = std::min(a.r[i].last(), b.r[j].last());
+      if (s <= e) {
+        emit(s, e);
+      }
+      if (a.r[i].last() < b.r[j].last()) {
+        i++;
+      } else {
+        j++;
+      }
+    }
+  } else {
+    std::size_t j = 0;
+    for (const auto &r : a.r) {
+      std::uint32_t s = r.start;
+      const std::uint32_t e = r.last();
+      while (j < b.r.size() && b.r[j].last() < s) {
+        j++;
+      }
+      for (std::size_t k = j; k < b.r.size() && b.r[k].start <= e; k++) {
+        if (b.r[k].start > s) {
+          emit(s, b.r[k].start - 1U);
+        }
+        s = b.r[k].last() + 1;
+      }
+      if (s <= e) {
+        emit(s, e);
+      }
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief  コンテナaとbの演算結果を返す
+ * @note   組み合わせ毎に適した方法で計算し、結果の要素数に応じて表現を選び直す
+ */
+template <roaring_op Op>
+inline roaring_container apply(const roaring_container &a,
+                               const roaring_container &b) {
+  const auto *aa = std::get_if<roaring_array>(&a);
+  const auto *ba = std::get_if<roaring_array>(&b);
+  const auto *ar = std::get_if<roaring_runs>(&a);
+  const auto *br = std::get_if<roaring_runs>(&b);
+  if (ar != nullptr && br != nullptr) {
+    return roaring_container(run_op<Op>(*ar, *br));
+  }
+  if (aa != nullptr && ba != nullptr) { // 配列同士
+    std::vector<std::uint16_t> out;
+    if constexpr (Op == roaring_op::and_) {
+      out = intersect(aa->v, ba->v);
+    } else if constexpr (Op == roaring_op::or_) {
+      out.reserve(aa->v.size() + ba->v.size());
+      std::set_union(aa->v.begin(), aa->v.end(), ba->v.begin(), ba->v.end(),
+                     std::back_inserter(out));
+    } else {
+      std::set_difference(aa->v.begin(), aa->v.end(), ba->v.begin(),
+                          ba->v.end(), std::back_inserter(out));
+    }
+    return grow(std::move(out));
+  }
+  // 積と差では、左辺が配列ならその要素を右辺で選別するだけで済む
+  if constexpr (Op != roaring_op::or_) {
+    if (aa != nullptr) {
+      roaring_array out;
+      std::copy_if(aa->v.begin(), aa->v.end(), std::back_inserter(out.v),
+                   [&](std::uint16_t x) {
+                     return contains(b, x) == (Op == roaring_op::and_);
+                   });
+      return roaring_container(std::move(out));
+    }
+  }
+  if constexpr (Op == roaring_op::and_) {
+    if (ba != nullptr) {
+      return apply<Op>(b, a);
+    }
+  }
+  // 残りはビットマップに揃えて語毎に計算する
+  roaring_bits x = to_bits(a);
+  if (ba != nullptr) { // 配列の要素だけビットを操作する
+    for (std::uint16_t v : ba->v) {
+      std::uint64_t &w = x.w[v / 64];
+      const std::uint64_t m = std::uint64_t(1) << (v % 64);
+      const bool had = (w & m) != 0;
+      if constexpr (Op == roaring_op::or_) {
+        w |= m;
+        x.card += !had;
+      } else {
+        w &= ~m;
+        x.card -= had;
+      }
+    }
+    return shrink(std::move(x));
+  }
+  const roaring_bits y = to_bits(b);
+  x.card = bitmap_op<Op>(x.w.data(), y.w.data());
+  return shrink(std::move(x));
+}
+
+} // namespace impl
+
+/**
+ * @brief 圧縮ビットマップ(Roaring bitmap)
+ */
+struct roaring_bitmap {
+  using value_t = std::uint32_t;
+
+  roaring_bitmap() = default;
+
+  /**< @brief 要素[first, last)からなる集合を作る */
+  template <class InputIt> roaring_bitmap(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      add(static_cast<value_t>(*first));
+    }
+  }
+
+  /**< @brief 要素xを加える */
+  void add(value_t x) {
+    impl::roaring_container &c = chunk(high(x));
+    const std::uint16_t l = low(x);
+    if (auto a = std::get_if<impl::roaring_array>(&c)) {
+      auto it = std::lower_bound(a->v.begin(), a->v.end(), l);
+      if (it != a->v.end() && *it == l) {
+        return;
+      }
+      a->v.insert(it, l);
+      if (a->v.size() > impl::roaring_array_max) {
+        c = impl::to_bits(c);
+      }
+      return;
+    }
+    if (std::holds_alternative<impl::roaring_runs>(c)) {
+      if (impl::contains(c, l)) {
+        return;
+      }
+      impl::run_insert(std::get<impl::roaring_runs>(c), l);
+      impl::run_fit(c);
+      return;
+    }
+    auto &b = std::get<impl::roaring_bits>(c);
+    std::uint64_t &w = b.w[l / 64];
+    const std::uint64_t m = std::uint64_t(1) << (l % 64);
+    b.card += !(w & m);
+    w |= m;
+  }
+
+  /**< @brief 要素xを取り除く */
+  void remove(value_t x) {
+    auto it = find(high(x));
+    if (it == chunks_.end() || !impl::contains(it->second, low(x))) {
+      return;
+    }
+    impl::roaring_container &c = it->second;
+    const std::uint16_t l = low(x);
+    if (auto a = std::get_if<impl::roaring_array>(&c)) {
+      a->v.erase(std::lower_bound(a->v.begin(), a->v.end(), l));
+    } else if (auto rs = std::get_if<impl::roaring_runs>(&c)) {
+      impl::run_erase(*rs, l);
+      impl::run_fit(c);
+    } else {
+      auto &b = std::get<impl::roaring_bits>(c);
+      std::uint64_t &w = b.w[l / 64];
+      const std::uint64_t m = std::uint64_t(1) << (l % 64);
+      b.card -= !!(w & m);
+      w &= ~m;
+      if (b.card <= impl::roaring_array_max) {
+        c = impl::shrink(std::move(b));
+      }
+    }
+    if (impl::cardinality(c) == 0) {
+      chunks_.erase(it);
+    }
+  }
+
+  /**< @brief 要素xが含まれるかどうか */
+  bool contains(value_t x) const noexcept {
+    auto it = find(high(x));
+    return it != chunks_.end() && impl::contains(it->second, low(x));
+  }
+
+  /**< @brief 要素数を返す */
+  std::uint64_t cardinality() const noexcept {
+    std::uint64_t card = 0;
+    for (const auto &[k, c] : chunks_) {
+      card += impl::cardinality(c);
+    }
+    return card;
+  }
+  /**< @brief 空かどうかを返す */
+  bool empty() const noexcept { return chunks_.empty(); }
+
+  /**< @brief コンテナの中身が占めるおおよそのバイト数を返す */
+  std::size_t bytes() const noexcept {
+    std::size_t n = chunks_.size() * sizeof(chunk_t);
+    for (const auto &[k, c] : chunks_) {
+      if (auto a = std::get_if<impl::roaring_array>(&c)) {
+        n += a->v.size() * sizeof(std::uint16_t);
+      } else if (auto r = std::get_if<impl::roaring_runs>(&c)) {
+        n += r->r.size() * sizeof(impl::roaring_runs::run);
+      } else {
+        n += impl::roaring_bitmap_words * sizeof(std::uint64_t);
+      }
+    }
+    return n;
+  }
+
+  /**
+   * @brief 連長コンテナの方が小さくなるコンテナを連長コンテナに変換する
+   * @note  連続した区間の多い集合で呼び出すとよい
+   */
+  void run_optimize() {
+    for (auto &[k, c] : chunks_) {
+      impl::roaring_runs rs;
+      impl::for_each(c, [&](std::uint16_t x) {
+        if (!rs.r.empty() && rs.r.back().last() + 1 == x) {
+          rs.r.back().length++;
+        } else {
+          rs.r.push_back({x, 0});
+        }
+      });
+      const std::size_t run_bytes = rs.r.size() * sizeof(rs.r[0]);
+      const std::size_t cur_bytes =
+          std::holds_alternative<impl::roaring_bits>(c)
+              ? impl::roaring_bitmap_words * sizeof(std::uint64_t)
+              : impl::cardinality(c) * sizeof(std::uint16_t);
+      if (run_bytes < cur_bytes) {
+        c = std::move(rs);
+      }
+    }
+  }
+
+  /**< @brief 要素を昇順に列挙する */
+  template <class F> void for_each(F fn) const {
+    for (const auto &[k, c] : chunks_) {
+      const value_t base = value_t(k) << 16;
+      impl::for_each(c, [&](std::uint16_t x) { fn(base | x); });
+    }
+  }
+
+  /**< @brief 和集合 */
+  roaring_bitmap &operator|=(const roaring_bitmap &rhs) {
+    return *this = combine<impl::roaring_op::or_>(*this, rhs);
+  }
+  /**< @brief 積集合 */
+  roaring_bitmap &operator&=(const roaring_bitmap &rhs) {
+    return *this = combine<impl::roaring_op::and_>(*this, rhs);
+  }
+  /**< @brief 差集合 */
+  roaring_bitmap &operator-=(const roaring_bitmap &rhs) {
+    return *this = combine<impl::roaring_op::andnot_>(*this, rhs);
+  }
+  friend roaring_bitmap operator|(const roaring_bitmap &l,
+                                  const roaring_bitmap &r) {
+    return combine<impl::roaring_op::or_>(l, r);
+  }
+  friend roaring_bitmap operator&(const roaring_bitmap &l,
+                                  const roaring_bitmap &r) {
+    return combine<impl::roaring_op::and_>(l, r);
+  }
+  friend roaring_bitmap operator-(const roaring_bitmap &l,
+                                  const roaring_bitmap &r) {
+    return combine<impl::roaring_op::andnot_>(l, r);
+  }
+
+private:
+  using chunk_t = std::pair<std::uint16_t, impl::roaring_container>;
+  using chunks_t = std::vector<chunk_t>;
+
+  static constexpr std::uint16_t high(value_t x) noexcept { return x >> 16; }
+  static constexpr std::uint16_t low(value_t x) noexcept { return x & 0xffff; }
+
+  /**< @brief 上位16ビットがkのチャンクを探す */
+  chunks_t::const_iterator find(std::uint16_t k) const noexcept {
+    auto it = std::lower_bound(
+        chunks_.begin(), chunks_.end(), k,
+        [](const chunk_t &c, std::uint16_t k) { return c.first < k; });
+    return it != chunks_.end() && it->first == k ? it : chunks_.end();
+  }
+  chunks_t::iterator find(std::uint16_t k) noexcept {
+    auto it = std::as_const(*this).find(k);
+    return chunks_.begin() + (it - chunks_.cbegin());
+  }
+
+  /**< @brief 上位16ビットがkのチャンクを返す(なければ空の配列コンテナを作る) */
+  impl::roaring_container &chunk(std::uint16_t k) {
+    auto it = std::lower_bound(
+        chunks_.begin(), chunks_.end(), k,
+        [](const chunk_t &c, std::uint16_t k) { return c.first < k; });
+    if (it == chunks_.end() || it->first != k) {
+      it = chunks_.emplace(it, k, impl::roaring_array{});
+    }
+    return it->second;
+  }
+
+  /**< @brief チャンク毎にOpを施した結果を返す */
+  template <impl::roaring_op Op>
+  static roaring_bitmap combine(const roaring_bitmap &l,
+                                const roaring_bitmap &r) {
+    roaring_bitmap out;
+    auto push = [&](std::uint16_t k, impl::roaring_container &&c) {
+      if (impl::cardinality(c) != 0) {
+        out.chunks_.emplace_back(k, std::move(c));
+      }
+    };
+    std::size_t i = 0, j = 0;
+    while (i < l.chunks_.size() || j < r.chunks_.size()) {
+      if (j == r.chunks_.size() ||
+          (i < l.chunks_.size() && l.chunks_[i].first < r.chunks_[j].first)) {
+        if (Op != impl::roaring_op::and_) { // 左辺だけにあるチャンク
+          out.chunks_.push_back(l.chunks_[i]);
+        }
+        i++;
+      } else if (i == l.chunks_.size() ||
+                 r.chunks_[j].first < l.chunks_[i].first) {
+        if (Op == impl::roaring_op::or_) { // 右辺だけにあるチャンク
+          out.chunks_.push_back(r.chunks_[j]);
+        }
+        j++;
+      } else {
+        push(l.chunks_[i].first,
+             impl::apply<Op>(l.chunks_[i].second, r.chunks_[j].second));
+        i++;
+        j++;
+      }
+    }
+    return out;
+  }
+
+  chunks_t chunks_; /**< 上位16ビットで整列したチャンク */
+};
+
+} // namespace container
+
+#endif // ROARING_BITMAP_HPP
@@ -0,0 +1,83 @@
+/**
+ * @brief  空間インデックスで共有する2次元の幾何プリミティブ
+ */
+
+#ifndef SPATIAL_HPP
+#define SPATIAL_HPP
+
+#include <algorithm>
+#include <type_traits>
+
+namespace container {
+
+/**
+ * @brief  2次元の点
+ * @tparam Float 座標の型
+ */
+template <class Float = float> struct point2 {
+  static_assert(std::is_floating_point_v<Float>,
+                "only makes sence for floating point types.");
+  Float x; /**< x座標 */
+  Float y; /**< y座標 */
+};
+
+/**
+ * @brief  軸平行境界ボックス(axis-aligned bounding box)
+ * @tparam Float 座標の型
+ */
+template <class Float = float> struct aabb2 {
+  static_assert(std::is_floating_point_v<Float>,
+                "only makes sence for floating point types.");
+  Float x0; /**< 最小点のx座標 */
+  Float y0; /**< 最小点のy座標 */
+  Float x1; /**< 最大点のx座標 */
+  Float y1; /**< 最大点のy座標 */
+
+  /**< @brief 中心cと半径rから境界ボックスを作る */
+  static constexpr aabb2 from_circle(const point2<Float> &c, Float r) noexcept {
+    return aabb2{c.x - r, c.y - r, c.x + r, c.y + r};
+  }
+
+  /**< @brief 中心を返す */
+  constexpr point2<Float> center() const noexcept {
+    return point2<Float>{(x0 + x1) * Float(0.5), (y0 + y1) * Float(0.5)};
+  }
+
+  /**< @brief 各軸の半径のうち大きい方を返す */
+  constexpr Float half_extent() const noexcept {
+    return std::max(x1 - x0, y1 - y0) * Float(0.5);
+  }
+};
+
+/**< @brief 点pが境界ボックスbに含まれるかどうか */
+template <class Float>
+constexpr bool contains(const aabb2<Float> &b, const point2<Float> &p) noexcept {
+  return b.x0 <= p.x && p.x <= b.x1 && b.y0 <= p.y && p.y <= b.y1;
+}
+
+/**< @brief 境界ボックスaとbが重なるかどうか */
+template <class Float>
+constexpr bool overlaps(const aabb2<Float> &a, const aabb2<Float> &b) noexcept {
+  return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+}
+
+/**< @brief 点pと点qの距離の2乗 */
+template <class Float>
+constexpr Float distance2(const point2<Float> &p,
+                          const point2<Float> &q) noexcept {
+  const Float dx = p.x - q.x, dy = p.y - q.y;
+  return dx * dx + dy * dy;
+}
+
+/**< @brief 境界ボックスbと中心c、半径rの円が重なるかどうか */
+template <class Float>
+constexpr bool overlaps(const aabb2<Float> &b, const point2<Float> &c,
+                        Float r) noexcept {
+  const point2<Float> q{std::clamp(c.x, b.x0, b.x1),
+                        std::clamp(c.y, b.y0, b.y1)}; // bの中でcに最も近い点
+  return distance2(c, q) <= r * r;
+}
+
+} // namespace container
+
+#endif // SPATIAL_HPP
@@ -0,0 +1,363 @@
+/**
+ * @brief  空間ハッシュグリッド
+ * @note   平面を一辺sの正方形のセルに分割し、セル座標(cx, cy)をハッシュして
+ *         バケットに振り分ける. 各バケットは節点の双方向連結リストを持つ
+ *         セルの個数に関わらず記憶領域はバケット数と要素数にしか依存しないため、
+ *         オブジェクトが密で一様に分布する世界に向いている
+ *
+ * @note   挿入、削除、移動はΟ(1)
+ *         半径rの近傍探索は、走査するセル数をc、その中の要素数をmとしてΟ(c + m)
+ */
+
+#ifndef SPATIAL_HASH_GRID_HPP
+#define SPATIAL_HASH_GRID_HPP
+
+#include "container.hpp"
+#include "spatial.hpp"
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace container {
+
+template <class T, class Float> struct spatial_hash_grid_node {
+  using cell_t = std::int32_t;
+  spatial_hash_grid_node *prev; /**< バケット内の前の節点 */
+  spatial_hash_grid_node *next; /**< バケット内の次の節点 */
+  cell_t cx;                    /**< セルのx座標 */
+  cell_t cy;                    /**< セルのy座標 */
+  point2<Float> p;              /**< 位置 */
+  T v;                          /**< 付属データ */
+
+  constexpr explicit spatial_hash_grid_node(const point2<Float> &p,
+                                            const T &v) noexcept
+      : prev(nullptr), next(nullptr), cx(0), cy(0), p(p), v(v) {}
+};
+
+/**
+ * @brief  空間ハッシュグリッド
+ * @tparam T         付属データの型
+ * @tparam Float     座標の型
+ * @tparam Allocator アロケータの型
+ */
+template <class T, class Float = float,
+          class Allocator = boost::container::pmr::polymorphic_allocator<
+              spatial_hash_grid_node<T, Float>>>
+struct spatial_hash_grid {
+  static_assert(std::is_nothrow_constructible_v<T>);
+  using alloc = std::allocator_traits<Allocator>;
+  using node = spatial_hash_grid_node<T, Float>;
+  using cell_t = typename node::cell_t;
+  using handle_t = std::size_t;
+  using point_t = point2<Float>;
+  using aabb_t = aabb2<Float>;
+
+  /**
+   * @param Float       s セルの一辺の長さ(近傍探索の典型的な半径程度がよい)
+   * @param std::size_t n 格納できる要素数の上限
+   * @param std::size_t b バケット数(0のときnから決める. 2の冪に切り上げられる)
+   */
+  explicit spatial_hash_grid(Float s, std::size_t n = 32, std::size_t b = 0)
+      : inv_cell_(Float(1) / s) {
+    BOOST_ASSERT_MSG(s > Float(0), "Cell size must be positive.");
+    allocate_pool(n);
+    allocate_buckets(b == 0 ? n << 1 : b);
+  }
+  ~spatial_hash_grid() noexcept { free_pool(); } // 確保した記憶領域の解放
+
+  spatial_hash_grid(const spatial_hash_grid &) = delete;
+  spatial_hash_grid &operator=(const spatial_hash_grid &) = delete;
+
+  /**
+   * @brief  位置pに付属データvを持つ要素を挿入する
+   * @note   実行時間はΟ(1)
+   * @return 挿入した要素のハンドル
+   */
+  handle_t insert(const point_t &p, const T &v) {
+    node *x = create_node(p, v);
+    link(x);
+    return handle(x);
+  }
+
+  /**
+   * @brief  ハンドルhの要素を削除する
+   * @note   実行時間はΟ(1)
+   * @return 削除した要素の付属データ
+   */
+  std::optional<T> erase(handle_t h) {
+    node *x = at(h);
+    std::optional<T> opt = std::make_optional(x->v);
+    unlink(x);
+    destroy_node(x);
+    return opt;
+  }
+
+  /**
+   * @brief ハンドルhの要素を位置pへ移動する
+   * @note  セルが変わらなければ位置を書き換えるだけで済む. 実行時間はΟ(1)
+   */
+  void move(handle_t h, const point_t &p) {
+    node *x = at(h);
+    const cell_t cx = cell(p.x), cy = cell(p.y);
+    if (cx != x->cx || cy != x->cy) {
+      unlink(x);
+      x->p = p;
+      link(x);
+    } else {
+      x->p = p;
+    }
+  }
+
+  /**< @brief ハンドルhの要素の位置を返す */
+  const point_t &position(handle_t h) const { return at(h)->p; }
+  /**< @brief ハンドルhの要素の付属データを返す */
+  T &value(handle_t h) { return at(h)->v; }
+  const T &value(handle_t h) const { return at(h)->v; }
+
+  /**< @brief 要素数を返す */
+  constexpr std::size_t size() const noexcept { return size_; }
+  /**< @brief 空かどうかを返す */
+  constexpr bool empty() const noexcept { return size_ == 0; }
+  /**< @brief 満杯かどうかを返す */
+  constexpr bool full() const noexcept { return size_ >= cap_; }
+
+  /**
+   * @brief  中心c、半径rの円に含まれる要素を列挙する
+   * @tparam F handle_t, const T&を引数に取る関数オブジェクトの型
+   */
+  template <class F> void query_radius(const point_t &c, Float r, F fn) const {
+    const Float r2 = r * r;
+    for_each_in(aabb_t::from_circle(c, r), [&](const node *x) {
+      if (distance2(c, x->p) <= r2) {
+        fn(handle(x), x->v);
+      }
+    });
+  }
+
+  /**
+   * @brief  境界ボックスbに含まれる要素を列挙する
+   * @tparam F handle_t, const T&を引数に取る関数オブジェクトの型
+   */
+  template <class F> void query_aabb(const aabb_t &b, F fn) const {
+    for_each_in(b, [&](const node *x) {
+      if (contains(b, x->p)) {
+        fn(handle(x), x->v);
+      }
+    });
+  }
+
+  /**
+   * @brief  複数の中心[first, last)について半径rの近傍探索をまとめて行う
+   * @note   問い合わせを中心のバケット順に並べ替えてから処理するため、
+   *         近い問い合わせが同じバケットを続けて触り、キャッシュに乗りやすい
+   *         そのため、fnが呼ばれる順序は問い合わせの順序とは一致しない
+   * @tparam InputIt point_tを指すイテレータの型
+   * @tparam F       std::size_t(問い合わせの添字), handle_t, const T&を
+   *                 引数に取る関数オブジェクトの型
+   */
+  template <class InputIt, class F>
+  void query_radius(InputIt first, InputIt last, Float r, F fn) const {
+    batch(first, last, [&](std::size_t i, const point_t &c) {
+      query_radius(c, r, [&](handle_t h, const T &v) { fn(i, h, v); });
+    });
+  }
+
+  /**
+   * @brief  複数の境界ボックス[first, last)についての探索をまとめて行う
+   * @tparam InputIt aabb_tを指すイテレータの型
+   * @tparam F       std::size_t(問い合わせの添字), handle_t, const T&を
+   *                 引数に取る関数オブジェクトの型
+   */
+  template <class InputIt, class F>
+  void query_aabb(InputIt first, InputIt last, F fn) const {
+    batch(first, last, [&](std::size_t i, const aabb_t &b) {
+      query_aabb(b, [&](handle_t h, const T &v) { fn(i, h, v); });
+    });
+  }
+
+private:
+  /**
+   * @brief 座標vをセル座標に変換する
+   * @note  範囲外の値(NaNを含む)をそのままcell_tに変換すると未定義動作なので、
+   *        ±2^30に丸めてから変換する(Floatで正確に表せる境界)
+   */
+  cell_t cell(Float v) const noexcept {
+    constexpr Float limit = Float(1 << 30);
+    const Float f = std::floor(v * inv_cell_);
+    if (!(f > -limit)) {
+      return -(cell_t(1) << 30);
+    }
+    return f < limit ? static_cast<cell_t>(f) : cell_t(1) << 30;
+  }
+
+  /**< @brief セル座標(cx, cy)をバケットの添字に変換する */
+  std::size_t bucket(cell_t cx, cell_t cy) const noexcept {
+    const std::uint32_t h = static_cast<std::uint32_t>(cx) * 0x9e3779b1U ^
+                            static_cast<std::uint32_t>(cy) * 0x85ebca77U;
+    return (h ^ (h >> 15)) & (buckets_.size() - 1);
+  }
+
+  /**
+   * @brief 境界ボックスbと重なるセルに属する節点を列挙する
+   * @note  走査するセル数がバケット数を超える場合は全バケットを走査する
+   */
+  template <class F> void for_each_in(const aabb_t &b, F fn) const {
+    const cell_t cx0 = cell(b.x0), cx1 = cell(b.x1);
+    const cell_t cy0 = cell(b.y0), cy1 = cell(b.y1);
+    // 2^31セル分の幅になりうるので64bitで数える
+    const std::int64_t w = std::int64_t(cx1) - cx0 + 1;
+    const std::int64_t h = std::int64_t(cy1) - cy0 + 1;
+    if (w <= 0 || h <= 0) {
+      return;
+    }
+    if (static_cast<std::uint64_t>(w) * static_cast<std::uint64_t>(h) >
+        buckets_.size()) {
+      for (const node *head : buckets_) {
+        for (const node *x = head; x != nullptr; x = x->next) {
+          fn(x);
+        }
+      }
+      return;
+    }
+    for (cell_t cy = cy0; cy <= cy1; cy++) {
+      for (cell_t cx = cx0; cx <= cx1; cx++) {
+        // 同じバケットに別のセルが衝突している可能性があるので、セル座標で選別する
+        for (const node *x = buckets_[bucket(cx, cy)]; x != nullptr;
+             x = x->next) {
+          if (x->cx == cx && x->cy == cy) {
+            fn(x);
+          }
+        }
+      }
+    }
+  }
+
+  /**< @brief 問い合わせ[first, last)を中心のバケット順に処理する */
+  template <class InputIt, class F>
+  void batch(InputIt first, InputIt last, F fn) const {
+    using query_t = typename std::iterator_traits<InputIt>::value_type;
+    std::vector<std::pair<std::size_t, query_t>> qs;
+    for (std::size_t i = 0; first != last; ++first, ++i) {
+      qs.emplace_back(i, *first);
+    }
+    auto key = [this](const query_t &q) {
+      if constexpr (std::is_same_v<query_t, aabb_t>) {
+        const point_t c = q.center();
+        return bucket(cell(c.x), cell(c.y));
+      } else {
+        return bucket(cell(q.x), cell(q.y));
+      }
+    };
+    std::sort(qs.begin(), qs.end(), [&](const auto &l, const auto &r) {
+      return key(l.second) < key(r.second);
+    });
+    for (const auto &[i, q] : qs) {
+      fn(i, q);
+    }
+  }
+
+  /**< @brief 節点xを位置に対応するバケットの先頭に繋ぐ */
+  void link(node *x) noexcept {
+    x->cx = cell(x->p.x);
+    x->cy = cell(x->p.y);
+    node *&head = buckets_[bucket(x->cx, x->cy)];
+    x->prev = nullptr;
+    x->next = head;
+    if (head != nullptr) {
+      head->prev = x;
+    }
+    head = x;
+  }
+
+  /**< @brief 節点xをバケットから外す */
+  void unlink(node *x) noexcept {
+    if (x->prev != nullptr) {
+      x->prev->next = x->next;
+    } else {
+      buckets_[bucket(x->cx, x->cy)] = x->next;
+    }
+    if (x->next != nullptr) {
+      x->next->prev = x->prev;
+    }
+  }
+
+  handle_t handle(const node *x) const noexcept {
+    return static_cast<handle_t>(x - pool_);
+  }
+  node *at(handle_t h) const {
+    BOOST_ASSERT_MSG(h < cap_, "Invalid spatial hash grid handle.");
+    return pool_ + h;
+  }
+
+private:
+  /**< @brief 節点xの記憶領域の確保を行う */
+  node *create_node(const point_t &p, const T &v) {
+    BOOST_ASSERT_MSG(!full(), "Spatial hash grid capacity over.");
+    node *x = pool_ + free_[size_];
+    alloc::construct(alloc_, x, p, v);
+    size_++;
+    return x;
+  }
+
+  /**< @brief 節点xの記憶領域の解放を行う */
+  void destroy_node(node *x) noexcept {
+    alloc::destroy(alloc_, x);
+    free_[--size_] = handle(x); // 空いた添字を再利用できるよう戻す
+  }
+
+  /**< @brief メモリプールの解放 */
+  void free_pool() noexcept {
+    for (node *&head : buckets_) {
+      for (node *x = head, *y; x != nullptr; x = y) {
+        y = x->next;
+        alloc::destroy(alloc_, x);
+      }
+      head = nullptr;
+    }
+    alloc::deallocate(alloc_, pool_, cap_);
+    pool_ = nullptr;
+    size_ = cap_ = 0;
+  }
+
+  /**< @brief メモリプールの確保 */
+  void allocate_pool(std::size_t n) {
+    pool_ = alloc::allocate(alloc_, n);
+    cap_ = n;
+    free_.resize(n); // free_[size_..cap_)が未使用の添字
+    for (std::size_t i = 0; i < n; i++) {
+      free_[i] = i;
+    }
+  }
+
+  /**< @brief バケットの確保(2の冪に切り上げる) */
+  void allocate_buckets(std::size_t b) {
+    std::size_t n = 1;
+    while (n < b) {
+      n <<= 1;
+    }
+    buckets_.assign(n, nullptr);
+  }
+
+private:
+  using handle_alloc = typename alloc::template rebind_alloc<handle_t>;
+  using bucket_alloc = typename alloc::template rebind_alloc<node *>;
+
+  Float inv_cell_;                            /**< セルの一辺の長さの逆数 */
+  std::vector<node *, bucket_alloc> buckets_; /**< バケット */
+  std::vector<handle_t, handle_alloc> free_;  /**< 添字の割当表 */
+  std::size_t cap_ = 0;                       /**< バッファサイズ */
+  std::size_t size_ = 0;                      /**< 要素数 */
+  node *pool_ = nullptr;                      /**< 節点用メモリプール */
+  Allocator alloc_;                           /**< アロケータ */
+};
+
+} // namespace container
+
+#endif // SPATIAL_HASH_GRID_HPP
@@ -0,0 +1,326 @@
+/**
+ * @brief  実行時のCPU機能の検出と、機能に応じた関数の切り替え(dispatch)
+ * @note   1つのバイナリを世代の異なるCPUで動かすため、SIMDの実装はコンパイルオプション
+ *         (-mavx2など)ではなくCPU_TARGETで関数毎に命令セットを指定してコンパイルし、
+ *         起動後に一度だけcpuidで検出した機能から使う関数(関数ポインタ)を選びます。
+ * @note   環境変数CPU_FEATURES_DISABLEに機能の名前をカンマ区切りで書くと(allは全て)、
+ *         その機能が無いものとして選ぶので、1台のマシンで全ての実装を試せます。
+ *         例: CPU_FEATURES_DISABLE=avx512f,avx2 ./bin/xxx
+ * @note   Reference: Intel 64 and IA-32 Architectures Software Developer's Manual,
+ *         Vol. 2A, CPUID (leaf 01H, 07H, 80000001H) and XGETBV
+ */
+
+// ********************************************************************************
+// インクルードガード
+// ********************************************************************************
+
+#ifndef CPU_FEATURES_HPP
+#define CPU_FEATURES_HPP
+
+// ********************************************************************************
+// 必要なヘッダファイルのインクルード
+// ********************************************************************************
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||             \
+    defined(_M_IX86)
+#define CPU_FEATURES_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+/**
+ * @brief 関数をコンパイルする命令セットを指定する(例: CPU_TARGET("avx2,bmi2"))
+ * @note  ファイル全体を-mavx2でコンパイルしなくても、その関数だけで命令を使えます。
+ *        呼び出す前にcpu::current()でその機能があることを確かめてください
+ */
+#if defined(__GNUC__)
+#define CPU_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CPU_TARGET(isa)
+#endif
+
+// ********************************************************************************
+// 名前空間の始まり
+// ********************************************************************************
+
+namespace cpu {
+
+// ********************************************************************************
+// 型の定義
+// ********************************************************************************
+
+/**< @brief 検出する機能(ビットフラグ。|で組み合わせて要件を表します) */
+enum feature : std::uint32_t {
+  none = 0,
+  sse42 = 1u << 0,
+  popcnt = 1u << 1,
+  avx = 1u << 2,
+  avx2 = 1u << 3,
+  fma = 1u << 4,
+  bmi1 = 1u << 5,
+  bmi2 = 1u << 6,
+  lzcnt = 1u << 7,
+  avx512f = 1u << 8,
+  avx512bw = 1u << 9,
+  avx512vl = 1u << 10,
+  sha = 1u << 11,
+  ssse3 = 1u << 12,
+};
+
+/**< @brief 機能の名前(環境変数と表示に使います) */
+inline constexpr std::array<std::pair<feature, std::string_view>, 13>
+    feature_names = {{
+        {ssse3, "ssse3"},
+        {sse42, "sse42"},
+        {popcnt, "popcnt"},
+        {avx, "avx"},
+        {avx2, "avx2"},
+        {fma, "fma"},
+        {bmi1, "bmi1"},
+        {bmi2, "bmi2"},
+        {lzcnt, "lzcnt"},
+        {avx512f, "avx512f"},
+        {avx512bw, "avx512bw"},
+        {avx512vl, "avx512vl"},
+        {sha, "sha"},
+    }};
+
+/**
+ * @brief 使える機能の集合
+ */
+class features {
+public:
+  constexpr features() noexcept = default;
+  constexpr explicit features(std::uint32_t bits) noexcept : bits_(bits) {}
+
+  /**< @brief 機能の集合をビットフラグで返す */
+  constexpr std::uint32_t bits() const noexcept { return bits_; }
+
+  /**< @brief 要件required(機能の|)を全て満たすかどうか */
+  constexpr bool has(std::uint32_t required) const noexcept {
+    return (bits_ & required) == required;
+  }
+
+  /**< @brief 機能の名前をカンマ区切りで返す */
+  std::string to_string() const {
+    std::string s;
+    for (const auto &[f, name] : feature_names) {
+      if (has(f)) {
+        if (!s.empty()) {
+          s += ',';
+        }
+        s += name;
+      }
+    }
+    return s;
+  }
+
+private:
+  std::uint32_t bits_ = 0; /**< featureの| */
+};
+
+// ********************************************************************************
+// 関数の定義
+// ********************************************************************************
+
+namespace detail {
+
+#if defined(CPU_FEATURES_X86)
+/**< @brief cpuidのleafとsubleafのレジスタ{eax, ebx, ecx, edx}を読む(無いleafは0) */
+inline std::array<std::uint32_t, 4> cpuid(std::uint32_t leaf,
+                                          std::uint32_t subleaf) {
+  std::array<std::uint32_t, 4> r{};
+#if defined(_MSC_VER)
+  int regs[4];
+  __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(subleaf));
+  for (int i = 0; i < 4; i++) {
+    r[i] = static_cast<std::uint32_t>(regs[i]);
+  }
+#else
+  unsigned int a, b, c, d;
+  if (__get_cpuid_count(leaf, subleaf, &a, &b, &c, &d)) {
+    r = {a, b, c, d};
+  }
+#endif
+  return r;
+}
+
+/**< @brief OSが保存するレジスタの集合XCR0を読む(OSXSAVEが有効なときだけ呼ぶこと) */
+inline std::uint64_t xgetbv() {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  std::uint32_t a, d;
+  __asm__ volatile("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+  return (static_cast<std::uint64_t>(d) << 32) | a;
+#endif
+}
+#endif
+
+} // namespace detail
+
+/**
+ * @brief  cpuidでCPUとOSが対応している機能を検出する
+ * @note   AVX, AVX-512はOSがYMM, ZMMレジスタを保存するとき(XCR0)だけ使えるものとします
+ * @return 使える機能の集合(x86以外では空)
+ */
+inline features detect() {
+  std::uint32_t f = none;
+#if defined(CPU_FEATURES_X86)
+  const auto l0 = detail::cpuid(0, 0);
+  const auto l1 = detail::cpuid(1, 0);
+  const auto l7 = l0[0] >= 7 ? detail::cpuid(7, 0) : decltype(l0){};
+  const auto e0 = detail::cpuid(0x80000000, 0);
+  const auto e1 =
+      e0[0] >= 0x80000001 ? detail::cpuid(0x80000001, 0) : decltype(l0){};
+  const auto bit = [](std::uint32_t reg, int n) { return (reg >> n) & 1; };
+
+  f |= bit(l1[2], 9) ? ssse3 : none;
+  f |= bit(l1[2], 20) ? sse42 : none;
+  f |= bit(l1[2], 23) ? popcnt : none;
+  f |= bit(l7[1], 3) ? bmi1 : none;
+  f |= bit(l7[1], 8) ? bmi2 : none;
+  f |= bit(l7[1], 29) ? sha : none;
+  f |= bit(e1[2], 5) ? lzcnt : none;
+
+  const bool osxsave = bit(l1[2], 27);
+  const std::uint64_t xcr0 = osxsave ? detail::xgetbv() : 0;
+  if (bit(l1[2], 28) && (xcr0 & 0x6) == 0x6) { // XMM, YMMを保存する
+    f |= avx;
+    f |= bit(l7[1], 5) ? avx2 : none;
+    f |= bit(l1[2], 12) ? fma : none;
+    if ((xcr0 & 0xe0) == 0xe0) { // opmask, ZMMの上位, ZMM16-31を保存する
+      f |= bit(l7[1], 16) ? avx512f : none;
+      f |= bit(l7[1], 30) ? avx512bw : none;
+      f |= bit(l7[1], 31) ? avx512vl : none;
+    }
+  }
+#endif
+  return features(f);
+}
+
+/**
+ * @brief  カンマ区切りの機能の名前を機能の集合に変換する
+ * @note   allは全ての機能を表します。知らない名前は無視します
+ * @param  std::string_view list 機能の名前のリスト(例: "avx512f,avx2")
+ * @return featureの|
+ */
+inline std::uint32_t parse(std::string_view list) {
+  std::uint32_t f = none;
+  while (!list.empty()) {
+    const std::size_t comma = list.find(',');
+    std::string_view name = list.substr(0, comma);
+    while (!name.empty() && name.front() == ' ') {
+      name.remove_prefix(1);
+    }
+    while (!name.empty() && name.back() == ' ') {
+      name.remove_suffix(1);
+    }
+    if (name == "all") {
+      f = ~std::uint32_t(0);
+    }
+    for (const auto &[g, n] : feature_names) {
+      if (name == n) {
+        f |= g;
+      }
+    }
+    list = comma == std::string_view::npos ? std::string_view()
+                                           : list.substr(comma + 1);
+  }
+  return f;
+}
+
+/**
+ * @brief  このプロセスで使う機能の集合を返す
+ * @note   最初の呼び出しで一度だけ検出し、環境変数CPU_FEATURES_DISABLEの機能を除きます
+ * @return 使う機能の集合
+ */
+inline const features &current() {
+  static const features f = [] {
+    const char *env = std::getenv("CPU_FEATURES_DISABLE");
+    return features(detect().bits() & ~parse(env != nullptr ? env : ""));
+  }();
+  return f;
+}
+
+// ********************************************************************************
+// クラスの定義
+// ********************************************************************************
+
+template <class Signature> class dispatcher;
+
+/**
+ * @brief  機能に応じて関数を選ぶクラス
+ * @note   構築したときに一度だけ選んだ関数ポインタを呼ぶので、呼び出しの度に機能を調べません。
+ *         関数スコープのstatic変数にすると、最初の呼び出しでスレッドセーフに選ばれます
+ * @code
+ *   CPU_TARGET("avx2") int sum_avx2(const int *, std::size_t);
+ *   int sum_scalar(const int *, std::size_t);
+ *   int sum(const int *a, std::size_t n) {
+ *     static const cpu::dispatcher<int(const int *, std::size_t)> f = {
+ *         {cpu::avx2, sum_avx2}, {cpu::none, sum_scalar}};
+ *     return f(a, n);
+ *   }
+ * @endcode
+ * @tparam R    戻り値の型
+ * @tparam Args 引数の型
+ */
+template <class R, class... Args> class dispatcher<R(Args...)> {
+public:
+  using function_t = R (*)(Args...);
+
+  /**< @brief 要件と、要件を満たすときに使う関数 */
+  struct candidate {
+    std::uint32_t required; /**< featureの| */
+    function_t function;    /**< 関数 */
+  };
+
+  /**
+   * @brief コンストラクタ
+   * @param candidates 候補(先に書いたものを優先します。最後は要件noneにしてください)
+   * @param f          使える機能の集合
+   * @throw std::invalid_argument 要件を満たす候補が無いとき
+   */
+  dispatcher(std::initializer_list<candidate> candidates,
+             const features &f = current())
+      : function_(select__(candidates, f)) {}
+
+  /**< @brief 選んだ関数を呼ぶ */
+  R operator()(Args... args) const {
+    return function_(std::forward<Args>(args)...);
+  }
+
+  /**< @brief 選んだ関数を返す */
+  function_t get() const noexcept { return function_; }
+
+private:
+  function_t function_; /**< 選んだ関数 */
+
+  /**< @brief 要件を満たす最初の候補を選ぶ */
+  static function_t select__(std::initializer_list<candidate> candidates,
+                             const features &f) {
+    for (const candidate &c : candidates) {
+      if (f.has(c.required) && c.function != nullptr) {
+        return c.function;
+      }
+    }
+    throw std::invalid_argument("cpu::dispatcher: no candidate for " +
+                                f.to_string());
+  }
+};
+
+} // namespace cpu
+
+#endif // CPU_FEATURES_HPP
@@ -1,11 +1,13 @@
 #ifndef NETWORK_UTILITY_HPP
 #define NETWORK_UTILITY_HPP
 
+#include "bit/endian.hpp"
 #include <cstdint>
 #include <iostream>
 #include <iterator>
 #include <memory>
 #include <set>
+#include <span>
 #include <string>
 #include <tuple>
 
@@ -21,6 +23,24 @@ encode(std::uint16_t x) {
                         static_cast<std::uint8_t>(x & 0xff));
 }
 
+/**
+ * @brief ネットワークバイトオーダーの16ビット整数の列inをまとめてoutに読む
+ * @throw std::invalid_argument in.size() != out.size() * 2のとき
+ */
+static inline void decode(std::span<const std::uint8_t> in,
+                          std::span<std::uint16_t> out) {
+  bit::load_be(in, out);
+}
+
+/**
+ * @brief 16ビット整数の列inをまとめてネットワークバイトオーダーでoutに書く
+ * @throw std::invalid_argument out.size() != in.size() * 2のとき
+ */
+static inline void encode(std::span<const std::uint16_t> in,
+                          std::span<std::uint8_t> out) {
+  bit::store_be(in, out);
+}
+
 /**
  * @ref  https://tools.ietf.org/html/rfc1071
  */
@@ -6,8 +6,11 @@
 #define XORSHIFT_HPP
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <random>
+#include <vector>
 
 /**
  * @brief Random number generator class by xorshift method
@@ -15,6 +18,10 @@
  * @note  Reference URL 2 : http://vigna.di.unimi.it/ftp/papers/xorshiftplus.pdf
  * @note  Reference URL 3 : http://xoroshiro.di.unimi.it/
  * @note  Reference URL 4 : https://blog.visvirial.com/articles/575
+ * @note  Reference URL 5 : http://xoroshiro.di.unimi.it/xorshift1024star.c
+ * @note  jump() / long_jump() advance every generator by a fixed huge number of
+ *        steps in O(state bits) time. The jump polynomials are x^(2^k) mod P(x)
+ *        where P(x) is the characteristic polynomial of each generator
  */
 struct xorshift {
 public:
@@ -107,7 +114,66 @@ public:
     return t[1] + s0;
   }
 
+  //*--------------------------------------------------------------------------------
+  // Jump
+  //*--------------------------------------------------------------------------------
+
+  /**< @brief advance xorshift128() by 2^64 steps */
+  void jump128() { jump128__(jump128_poly); }
+
+  /**< @brief advance xorshift128() by 2^96 steps */
+  void long_jump128() { jump128__(long_jump128_poly); }
+
+  /**< @brief advance xorshift64star() by 2^32 steps */
+  void jump64star() { jump64star__(jump64star_poly); }
+
+  /**< @brief advance xorshift64star() by 2^48 steps */
+  void long_jump64star() { jump64star__(long_jump64star_poly); }
+
+  /**< @brief advance xorshift1024star() by 2^512 steps */
+  void jump1024star() { jump1024star__(jump1024star_poly); }
+
+  /**< @brief advance xorshift1024star() by 2^768 steps */
+  void long_jump1024star() { jump1024star__(long_jump1024star_poly); }
+
+  /**< @brief advance xorshift128plus() by 2^64 steps */
+  void jump128plus() { jump128plus__(jump128plus_poly); }
+
+  /**< @brief advance xorshift128plus() by 2^96 steps */
+  void long_jump128plus() { jump128plus__(long_jump128plus_poly); }
+
+  /**
+   * @brief advance every generator by one jump
+   * @note  2^64 steps for xorshift128 / xorshift128plus, 2^512 steps for
+   *        xorshift1024star and 2^32 steps for xorshift64star (whose period is
+   *        only 2^64 - 1). Generators separated by jump() never overlap unless
+   *        more than 2^32 of them are used
+   */
+  void jump() {
+    jump128();
+    jump64star();
+    jump1024star();
+    jump128plus();
+  }
+
+  /**
+   * @brief advance every generator by one long jump
+   * @note  2^96 steps for xorshift128 / xorshift128plus, 2^768 steps for
+   *        xorshift1024star and 2^48 steps for xorshift64star. Use it to make up
+   *        to 2^16 groups of streams, each of which is split by jump()
+   */
+  void long_jump() {
+    long_jump128();
+    long_jump64star();
+    long_jump1024star();
+    long_jump128plus();
+  }
+
+  class stream_factory;
+
 private:
+  template <std::size_t> friend class xorshift_batch;
+
   std::uint32_t x, y, z, w; /**< @note 32bit * 4states = 128   */
 
   std::uint64_t v; /**< @note 64bit * 1state = 64     */
@@ -116,6 +182,172 @@ private:
   std::int32_t p;                  /**< @note always satisfy 0 <= p < 16 */
 
   std::array<std::uint64_t, 2> t; /**< @note 64bit * 2states = 128   */
+
+  //*--------------------------------------------------------------------------------
+  // Jump polynomials (bit i is the coefficient of x^i)
+  //*--------------------------------------------------------------------------------
+
+  static constexpr std::array<std::uint64_t, 2> jump128_poly = {
+      0x821e534335aac71cULL, 0xd8cd644ef52e65c4ULL};
+  static constexpr std::array<std::uint64_t, 2> long_jump128_poly = {
+      0xcf407dcc3fe5f618ULL, 0x32e5cf7230ff27cbULL};
+
+  static constexpr std::array<std::uint64_t, 1> jump64star_poly = {
+      0xbbd5e1c3a495e3e0ULL};
+  static constexpr std::array<std::uint64_t, 1> long_jump64star_poly = {
+      0x76c6208c83ee6437ULL};
+
+  static constexpr std::array<std::uint64_t, 16> jump1024star_poly = {
+      0x84242f96eca9c41dULL, 0xa3c65b8776f96855ULL, 0x5b34a39f070b5837ULL,
+      0x4489affce4f31a1eULL, 0x2ffeeb0a48316f40ULL, 0xdc2d9891fe68c022ULL,
+      0x3659132bb12fea70ULL, 0xaac17d8efa43cab8ULL, 0xc4cb815590989b13ULL,
+      0x5ee975283d71c93bULL, 0x691548c86c1bd540ULL, 0x7910c41d10a1e6a5ULL,
+      0x0b5fc64563b3e2a8ULL, 0x047f7684e9fc949dULL, 0xb99181f2d8f685caULL,
+      0x284600e3f30e38c3ULL};
+  static constexpr std::array<std::uint64_t, 16> long_jump1024star_poly = {
+      0x1db6ba0415e68f80ULL, 0x1f09c81ae9ac14e7ULL, 0x1f6719a6ee34e7f3ULL,
+      0xc120593b38a9b5eaULL, 0x3c412a1d4223ae9aULL, 0x8048b2a10ba2f726ULL,
+      0x88e5362f50f7f650ULL, 0x891fa8984bfc0276ULL, 0xa19d44b0dd77a638ULL,
+      0xac0ab6e69c4da928ULL, 0x46719fb5c5c827b7ULL, 0x05dd7bf153461782ULL,
+      0x56a51dd185004647ULL, 0x59b2257befdad3d3ULL, 0xd5d8a614c24b08b3ULL,
+      0xd0159f547fca0a39ULL};
+
+  static constexpr std::array<std::uint64_t, 2> jump128plus_poly = {
+      0x8a5cd789635d2dffULL, 0x121fd2155c472f96ULL};
+  static constexpr std::array<std::uint64_t, 2> long_jump128plus_poly = {
+      0xea61c9f1f13962aeULL, 0xa1fe50ef79cfafb2ULL};
+
+  //*--------------------------------------------------------------------------------
+  // Jump implementations
+  //*--------------------------------------------------------------------------------
+
+  /**
+   * @brief  sum (xor) the states S_i for which bit i of poly is set, while
+   *         stepping the generator. That is poly(M) * S_0 = M^J * S_0
+   * @param  poly  jump polynomial
+   * @param  state returns the current state as an array
+   * @param  next  steps the generator
+   * @return the state after the jump
+   */
+  template <class State, std::size_t N, class Load, class Next>
+  static State jump__(const std::array<std::uint64_t, N> &poly, Load state,
+                      Next next) {
+    State r{};
+    for (const std::uint64_t word : poly) {
+      for (int b = 0; b < 64; b++) {
+        if ((word >> b) & 1) {
+          const State c = state();
+          for (std::size_t i = 0; i < r.size(); i++) {
+            r[i] ^= c[i];
+          }
+        }
+        next();
+      }
+    }
+    return r;
+  }
+
+  void jump128__(const std::array<std::uint64_t, 2> &poly) {
+    const auto r = jump__<std::array<std::uint32_t, 4>>(
+        poly, [this] { return std::array<std::uint32_t, 4>{x, y, z, w}; },
+        [this] { xorshift128(); });
+    x = r[0];
+    y = r[1];
+    z = r[2];
+    w = r[3];
+  }
+
+  void jump64star__(const std::array<std::uint64_t, 1> &poly) {
+    v = jump__<std::array<std::uint64_t, 1>>(
+        poly, [this] { return std::array<std::uint64_t, 1>{v}; },
+        [this] { xorshift64star(); })[0];
+  }
+
+  /**< @note the state is seen from s[p]; after 1024 steps p is back in place */
+  void jump1024star__(const std::array<std::uint64_t, 16> &poly) {
+    const auto r = jump__<std::array<std::uint64_t, 16>>(
+        poly,
+        [this] {
+          std::array<std::uint64_t, 16> c;
+          for (std::int32_t j = 0; j < 16; j++) {
+            c[j] = s[(p + j) & 0x0f];
+          }
+          return c;
+        },
+        [this] { xorshift1024star(); });
+    for (std::int32_t j = 0; j < 16; j++) {
+      s[(p + j) & 0x0f] = r[j];
+    }
+  }
+
+  void jump128plus__(const std::array<std::uint64_t, 2> &poly) {
+    t = jump__<std::array<std::uint64_t, 2>>(
+        poly, [this] { return t; }, [this] { xorshift128plus(); });
+  }
+};
+
+/**
+ * @brief Factory of non-overlapping xorshift generators for parallel workers
+ * @note  Stream i is the generator seeded with seed and advanced by jump() i
+ *        times, so stream i and stream i + 1 are 2^64 steps apart
+ *        (2^512 for xorshift1024star, 2^32 for xorshift64star).
+ *        The result only depends on (seed, group, i), not on the number of
+ *        threads or the order in which they start
+ * @code
+ *   xorshift::stream_factory factory(seed);
+ *   auto rngs = factory.streams(n_threads);
+ *   // thread k uses rngs[k] only
+ * @endcode
+ */
+class xorshift::stream_factory {
+public:
+  //*--------------------------------------------------------------------------------
+  // Special Member Functions
+  //*--------------------------------------------------------------------------------
+
+  /**
+   * @brief constructor
+   * @param seed  seed of the base generator
+   * @param group the base generator is advanced by long_jump() group times, so
+   *              that factories with different groups (e.g. one per process)
+   *              hand out disjoint streams
+   */
+  explicit stream_factory(std::uint32_t seed, std::uint32_t group = 0)
+      : base(seed) {
+    for (std::uint32_t i = 0; i < group; i++) {
+      base.long_jump();
+    }
+  }
+
+  //*--------------------------------------------------------------------------------
+  // Streams
+  //*--------------------------------------------------------------------------------
+
+  /**< @brief generator of stream i (costs i jumps) */
+  xorshift stream(std::size_t i) const {
+    xorshift r = base;
+    for (std::size_t k = 0; k < i; k++) {
+      r.jump();
+    }
+    return r;
+  }
+
+  /**< @brief generators of streams 0, 1, ..., n - 1 (costs n - 1 jumps) */
+  std::vector<xorshift> streams(std::size_t n) const {
+    std::vector<xorshift> r;
+    r.reserve(n);
+    xorshift g = base;
+    for (std::size_t k = 0; k < n; k++) {
+      if (k != 0) {
+        g.jump();
+      }
+      r.push_back(g);
+    }
+    return r;
+  }
+
+private:
+  xorshift base; /**< @note generator of stream 0 */
 };
 
 #endif // XORSHIFT_HPP
@@ -0,0 +1,269 @@
+/**
+ * @brief Batch fill of random numbers by interleaved xorshift128+ lanes
+ * @note  fill() runs Lanes (4 or 8) independent xorshift128+ generators side by
+ *        side. With AVX2 one (two) 256bit register(s) hold all lanes, so a step
+ *        makes 4 (8) values without the serial dependency of operator().
+ *        Without AVX2 the scalar version makes exactly the same values.
+ * @note  Lane k starts k * 2^64 / Lanes steps after the seeded xorshift128plus(),
+ *        so the lanes never overlap and a batch made from
+ *        xorshift::stream_factory::stream(i) stays inside stream i.
+ * @note  Value i of one fill comes from lane i % Lanes. Every call advances all
+ *        lanes by ceil(n / Lanes) steps, so the output is reproducible for the
+ *        same seed, lane count and sequence of fill sizes
+ * @note  uint32_t takes the upper 32 bits (the low bits of xorshift128+ are weak),
+ *        float the upper 23 bits and double the upper 52 bits of each value,
+ *        mapped to [0, 1)
+ */
+
+#ifndef XORSHIFT_BATCH_HPP
+#define XORSHIFT_BATCH_HPP
+
+#include "cpu/cpu_features.hpp"
+#include "random/xorshift.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+#define XORSHIFT_BATCH_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace xorshift_detail {
+
+/**< @brief value types that fill() accepts */
+template <class T>
+concept batch_value =
+    std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::uint64_t> ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+/**< @brief convert one 64bit output to T */
+template <class T> inline T convert(std::uint64_t x) noexcept {
+  if constexpr (std::is_same_v<T, std::uint64_t>) {
+    return x;
+  } else if constexpr (std::is_same_v<T, std::uint32_t>) {
+    return static_cast<std::uint32_t>(x >> 32);
+  } else if constexpr (std::is_same_v<T, float>) {
+    // 1.m (23bit mantissa) in [1, 2), minus 1
+    return std::bit_cast<float>(static_cast<std::uint32_t>(x >> 41) |
+                                0x3f800000U) -
+           1.0f;
+  } else {
+    return std::bit_cast<double>((x >> 12) | 0x3ff0000000000000ULL) - 1.0;
+  }
+}
+
+/**
+ * @brief fill out[0, n) by Lanes xorshift128+ generators (scalar version)
+ * @param a0 t[0] of each lane
+ * @param a1 t[1] of each lane
+ */
+template <class T, std::size_t Lanes>
+void fill_scalar(std::uint64_t *a0, std::uint64_t *a1, T *out, std::size_t n) {
+  // keep the lanes in locals: out may alias a0 and a1 as far as the compiler knows
+  std::array<std::uint64_t, Lanes> s0, s1, r;
+  std::memcpy(s0.data(), a0, sizeof(s0));
+  std::memcpy(s1.data(), a1, sizeof(s1));
+  const auto step = [&] {
+    for (std::size_t k = 0; k < Lanes; k++) {
+      std::uint64_t x = s0[k];
+      const std::uint64_t y = s1[k];
+      s0[k] = y;
+      x ^= x << 23;
+      s1[k] = x ^ y ^ (x >> 18) ^ (y >> 5);
+      r[k] = s1[k] + y;
+    }
+  };
+  std::size_t i = 0;
+  for (; i + Lanes <= n; i += Lanes) {
+    step();
+    for (std::size_t k = 0; k < Lanes; k++) {
+      out[i + k] = convert<T>(r[k]);
+    }
+  }
+  if (i < n) { // the last step only uses some of the lanes
+    step();
+    for (std::size_t k = 0; i + k < n; k++) {
+      out[i + k] = convert<T>(r[k]);
+    }
+  }
+  std::memcpy(a0, s0.data(), sizeof(s0));
+  std::memcpy(a1, s1.data(), sizeof(s1));
+}
+
+#if defined(XORSHIFT_BATCH_SIMD)
+
+/**< @brief one xorshift128+ step of 4 lanes */
+CPU_TARGET("avx2")
+inline __m256i step_avx2(__m256i &a0, __m256i &a1) {
+  __m256i s1 = a0;
+  const __m256i s0 = a1;
+  a0 = s0;
+  s1 = _mm256_xor_si256(s1, _mm256_slli_epi64(s1, 23));
+  a1 = _mm256_xor_si256(
+      _mm256_xor_si256(s1, s0),
+      _mm256_xor_si256(_mm256_srli_epi64(s1, 18), _mm256_srli_epi64(s0, 5)));
+  return _mm256_add_epi64(a1, s0);
+}
+
+/**< @brief the low 32 bits of each 64bit lane of v, in the low 128 bits */
+CPU_TARGET("avx2")
+inline __m256i pack_low32_avx2(__m256i v) {
+  return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+}
+
+/**
+ * @brief convert the 64bit outputs r[0, Lanes / 4) and store them to out
+ * @note  32bit types are packed from the 64bit lanes with vpermd
+ */
+template <class T, std::size_t V>
+CPU_TARGET("avx2")
+inline void store_avx2(const __m256i (&r)[V], T *out) {
+  if constexpr (std::is_same_v<T, std::uint64_t>) {
+    for (std::size_t j = 0; j < V; j++) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out) + j, r[j]);
+    }
+  } else if constexpr (std::is_same_v<T, double>) {
+    const __m256i one = _mm256_set1_epi64x(0x3ff0000000000000LL);
+    for (std::size_t j = 0; j < V; j++) {
+      const __m256d d = _mm256_castsi256_pd(
+          _mm256_or_si256(_mm256_srli_epi64(r[j], 12), one));
+      _mm256_storeu_pd(out + 4 * j, _mm256_sub_pd(d, _mm256_set1_pd(1.0)));
+    }
+  } else {
+    __m256i p[V];
+    for (std::size_t j = 0; j < V; j++) {
+      if constexpr (std::is_same_v<T, std::uint32_t>) {
+        p[j] = pack_low32_avx2(_mm256_srli_epi64(r[j], 32));
+      } else {
+        p[j] = pack_low32_avx2(_mm256_or_si256(
+            _mm256_srli_epi64(r[j], 41), _mm256_set1_epi64x(0x3f800000LL)));
+      }
+    }
+    __m256i v;
+    if constexpr (V == 1) {
+      v = p[0];
+    } else {
+      v = _mm256_permute2x128_si256(p[0], p[1], 0x20);
+    }
+    if constexpr (std::is_same_v<T, float>) {
+      const __m256 f = _mm256_sub_ps(_mm256_castsi256_ps(v), _mm256_set1_ps(1.0f));
+      if constexpr (V == 1) {
+        _mm_storeu_ps(out, _mm256_castps256_ps128(f));
+      } else {
+        _mm256_storeu_ps(out, f);
+      }
+    } else {
+      if constexpr (V == 1) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                         _mm256_castsi256_si128(v));
+      } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), v);
+      }
+    }
+  }
+}
+
+/**< @brief fill out[0, n) by Lanes xorshift128+ generators (AVX2 version) */
+template <class T, std::size_t Lanes>
+CPU_TARGET("avx2")
+void fill_avx2(std::uint64_t *a0, std::uint64_t *a1, T *out, std::size_t n) {
+  constexpr std::size_t V = Lanes / 4;
+  __m256i s0[V], s1[V], r[V];
+  for (std::size_t j = 0; j < V; j++) {
+    s0[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a0) + j);
+    s1[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a1) + j);
+  }
+  std::size_t i = 0;
+  for (; i + Lanes <= n; i += Lanes) {
+    for (std::size_t j = 0; j < V; j++) {
+      r[j] = step_avx2(s0[j], s1[j]);
+    }
+    store_avx2<T, V>(r, out + i);
+  }
+  if (i < n) { // the last step only uses some of the lanes
+    for (std::size_t j = 0; j < V; j++) {
+      r[j] = step_avx2(s0[j], s1[j]);
+    }
+    T buf[Lanes];
+    store_avx2<T, V>(r, buf);
+    std::memcpy(out + i, buf, (n - i) * sizeof(T));
+  }
+  for (std::size_t j = 0; j < V; j++) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(a0) + j, s0[j]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(a1) + j, s1[j]);
+  }
+}
+
+#endif
+
+/**< @brief choose fill_avx2 or fill_scalar by the CPU features */
+template <class T, std::size_t Lanes>
+void fill(std::uint64_t *a0, std::uint64_t *a1, T *out, std::size_t n) {
+  static const cpu::dispatcher<void(std::uint64_t *, std::uint64_t *, T *,
+                                    std::size_t)>
+      f = {
+#if defined(XORSHIFT_BATCH_SIMD)
+          {cpu::avx2, fill_avx2<T, Lanes>},
+#endif
+          {cpu::none, fill_scalar<T, Lanes>}};
+  f(a0, a1, out, n);
+}
+
+} // namespace xorshift_detail
+
+/**
+ * @brief  Batch random number generator by interleaved xorshift128+ lanes
+ * @tparam Lanes the number of lanes (4 or 8)
+ */
+template <std::size_t Lanes = 4> class xorshift_batch {
+  static_assert(Lanes == 4 || Lanes == 8, "xorshift_batch: Lanes must be 4 or 8");
+
+public:
+  //*--------------------------------------------------------------------------------
+  // Special Member Functions
+  //*--------------------------------------------------------------------------------
+
+  /**< @brief lanes split the 2^64 steps after xorshift128plus() of g */
+  explicit xorshift_batch(xorshift g) {
+    for (std::size_t k = 0; k < Lanes; k++) {
+      if (k != 0) {
+        g.jump128plus__(lane_poly);
+      }
+      a0[k] = g.t[0];
+      a1[k] = g.t[1];
+    }
+  }
+
+  explicit xorshift_batch(std::uint32_t seed) : xorshift_batch(xorshift(seed)) {}
+
+  //*--------------------------------------------------------------------------------
+  // Generator
+  //*--------------------------------------------------------------------------------
+
+  /**< @brief fill out with uniform random numbers (integers, or [0, 1) for floats) */
+  template <xorshift_detail::batch_value T> void fill(std::span<T> out) {
+    xorshift_detail::fill<T, Lanes>(a0.data(), a1.data(), out.data(),
+                                    out.size());
+  }
+
+  /**< @brief the number of lanes */
+  static constexpr std::size_t lanes() { return Lanes; }
+
+private:
+  /**< @note x^(2^64 / Lanes) mod P(x) of xorshift128+ */
+  static constexpr std::array<std::uint64_t, 2> lane_poly =
+      Lanes == 4 ? std::array<std::uint64_t, 2>{0x58c58d6dd4e0e774ULL,
+                                                0x57af8b6d58937824ULL}
+                 : std::array<std::uint64_t, 2>{0x577452a1d7f49cdcULL,
+                                                0xa026b9187b95048fULL};
+
+  alignas(32) std::array<std::uint64_t, Lanes> a0; /**< @note t[0] of lanes */
+  alignas(32) std::array<std::uint64_t, Lanes> a1; /**< @note t[1] of lanes */
+};
+
+#endif // XORSHIFT_BATCH_HPP
@@ -6,7 +6,9 @@
 #define SHA256_HPP
 
 #include "bit/bit.hpp"
+#include "bit/endian.hpp"
 #include <array>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -54,15 +56,13 @@ public:
       std::uint32_t W[64];
 
       // 0 <= t <= 15 : メッセージを16つの32-bit wordsに分割する
-      for (std::uint32_t t = 0; t < 16; t++) {
-
-        const std::uint32_t base = i * 64 + t * 4;
-        W[t] = (padded_msg[base + 0] << 24) | (padded_msg[base + 1] << 16) |
-               (padded_msg[base + 2] << 8) | (padded_msg[base + 3]);
+      bit::load_be(std::span(padded_msg).subspan(i * 64, 64),
+                   std::span(W).first(16));
 #ifdef DEBUG_OUTPUT
+      for (std::size_t t = 0; t < 16; t++) {
         fmt::printf("W[%2d] = %08x\n", t, W[t]);
-#endif
       }
+#endif
 
       // 16 <= t <= 63 : 16つの32-bits wordsを64つの32-bit wordsに分割する
       for (std::uint32_t t = 16; t < 64; t++) {
@@ -129,13 +129,7 @@ public:
 
     // 最終的なハッシュ値を返す
     std::vector<std::uint8_t> M(32); // 8 * 32 = 256-bits
-    for (std::size_t i = 0; i < 8; i++) {
-      const std::size_t base = i * 4;
-      M[base + 0] = static_cast<std::uint8_t>(H[i] >> 24);
-      M[base + 1] = static_cast<std::uint8_t>(H[i] >> 16);
-      M[base + 2] = static_cast<std::uint8_t>(H[i] >> 8);
-      M[base + 3] = static_cast<std::uint8_t>(H[i]);
-    }
+    bit::store_be(std::span(H), std::span(M));
 
     return M;
   }
@@ -177,10 +171,8 @@ private:
     padded_msg[msglen] = 0b10000000;
 
     // メッセージ長を付加
-    padded_msg[padded_len - 4] = static_cast<std::uint8_t>((msglen * 8) >> 24);
-    padded_msg[padded_len - 3] = static_cast<std::uint8_t>((msglen * 8) >> 16);
-    padded_msg[padded_len - 2] = static_cast<std::uint8_t>((msglen * 8) >> 8);
-    padded_msg[padded_len - 1] = static_cast<std::uint8_t>((msglen * 8));
+    bit::store_be(padded_msg.data() + padded_len - 8,
+                  static_cast<std::uint64_t>(msglen) * 8);
 
     return padded_msg;
   }
@@ -6,7 +6,9 @@
 #define SHA384_HPP
 
 #include "bit/bit.hpp"
+#include "bit/endian.hpp"
 #include <array>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -55,22 +57,13 @@ public:
       std::vector<std::uint64_t> W(80);
 
       // 0 <= t <= 15 : メッセージを16つの64-bit wordsに分割
-      for (std::uint64_t t = 0; t < 16; t++) {
-
-        std::size_t base = 128 * i + t * 8;
-        W[t] = ((padded_msg[base] & 0xffULL) << 56) |
-               ((padded_msg[base + 1] & 0xffULL) << 48) |
-               ((padded_msg[base + 2] & 0xffULL) << 40) |
-               ((padded_msg[base + 3] & 0xffULL) << 32) |
-               ((padded_msg[base + 4] & 0xffULL) << 24) |
-               ((padded_msg[base + 5] & 0xffULL) << 16) |
-               ((padded_msg[base + 6] & 0xffULL) << 8) |
-               ((padded_msg[base + 7] & 0xffULL));
-
+      bit::load_be(std::span(padded_msg).subspan(i * 128, 128),
+                   std::span(W).first(16));
 #ifdef DEBUG_OUTPUT
+      for (std::size_t t = 0; t < 16; t++) {
         fmt::printf("W[%2d] = %16x\n", t, W[t]);
-#endif
       }
+#endif
 
       // 16 <= t <= 79 : 16つの64-bit wordsを80つの64-bit wordsに分割
       for (std::uint64_t t = 16; t < 80; t++) {
@@ -136,18 +129,7 @@ public:
 
     // 最終的なハッシュ値を返す
     std::vector<std::uint8_t> M(48); // 8 * 48 = 384-bits
-    for (std::size_t i = 0; i < 6; i++) {
-
-      const std::size_t base = i * 8;
-      M[base] = static_cast<std::uint8_t>(H[i] >> 56);
-      M[base + 1] = static_cast<std::uint8_t>(H[i] >> 48);
-      M[base + 2] = static_cast<std::uint8_t>(H[i] >> 40);
-      M[base + 3] = static_cast<std::uint8_t>(H[i] >> 32);
-      M[base + 4] = static_cast<std::uint8_t>(H[i] >> 24);
-      M[base + 5] = static_cast<std::uint8_t>(H[i] >> 16);
-      M[base + 6] = static_cast<std::uint8_t>(H[i] >> 8);
-      M[base + 7] = static_cast<std::uint8_t>(H[i]);
-    }
+    bit::store_be(std::span(H).first(6), std::span(M));
 
     return M;
   }
@@ -189,10 +171,8 @@ private:
     padded_msg[msglen] = 0b10000000;
 
     // メッセージ長を付加
-    padded_msg[padded_len - 4] = static_cast<std::uint8_t>((msglen * 8) >> 24);
-    padded_msg[padded_len - 3] = static_cast<std::uint8_t>((msglen * 8) >> 16);
-    padded_msg[padded_len - 2] = static_cast<std::uint8_t>((msglen * 8) >> 8);
-    padded_msg[padded_len - 1] = static_cast<std::uint8_t>((msglen * 8));
+    bit::store_be(padded_msg.data() + padded_len - 8,
+                  static_cast<std::uint64_t>(msglen) * 8);
 
     return padded_msg;
   }
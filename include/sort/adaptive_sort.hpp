@@ -0,0 +1,339 @@
+/**
+ * @brief 適応的ソート(ランの検出とマージ)の実装
+ * @note  入力を昇順・降順の連続部分(ラン)に分け、降順のランを反転してから
+ *        パワーソート(powersort)の規則でランをマージします。マージは片側が連続して勝つと
+ *        指数探索で一度に移す、TimSortのギャロッピングを使います。
+ * @note  ランの平均長が短い(整列済みに近くない)入力ではイントロソートに切り替えます。
+ * @note  Reference: J. I. Munro and S. Wild, "Nearly-Optimal Mergesorts: Fast,
+ * Practical Sorting Methods That Optimally Adapt to Existing Runs", ESA 2018.
+ * @note  Reference: T. Peters, "listsort.txt", CPython.
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef ADAPTIVE_SORT_HPP
+#define ADAPTIVE_SORT_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "sort/intro_sort.hpp"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  適応的ソートクラス
+ * @tparam RandomAccessIterator (ランダムアクセス)イテレータ
+ * @tparam Compare              比較述語
+ */
+template <class RandomAccessIterator, class Compare> class AdaptiveSort {
+private:
+  using iter_t = RandomAccessIterator;
+  using cmp_t = Compare;
+  using val_t = typename std::iterator_traits<iter_t>::value_type;
+  using dif_t = typename std::iterator_traits<iter_t>::difference_type;
+
+  /**< @brief マージ待ちのラン */
+  struct run_t {
+    dif_t start; /**< 先頭の添字 */
+    dif_t len;   /**< 長さ */
+    int power;   /**< 次のランとの境界の深さ(パワー) */
+  };
+
+  template <class RAI, class Cmp>
+  friend void adaptive_sort(RAI a0, RAI aN, Cmp cmp);
+
+  static constexpr dif_t min_run = 32; /**< これより平均が短いランはイントロソートに任せる */
+  static constexpr dif_t initial_gallop = 7; /**< ギャロッピングに入る連勝数の初期値 */
+
+  explicit AdaptiveSort(cmp_t cmp) : cmp_(cmp) {}
+
+  cmp_t cmp_;                          /**< 比較述語 */
+  dif_t min_gallop_ = initial_gallop; /**< ギャロッピングに入る連勝数 */
+  std::vector<val_t> buf_;             /**< マージ用の作業領域 */
+
+  /**
+   * @brief 適応的ソートの本体
+   * @param iter_t a0 先頭イテレータ
+   * @param iter_t aN 末尾の次を指すイテレータ
+   */
+  void sort__(const iter_t a0, const iter_t aN) {
+    const dif_t n = std::distance(a0, aN);
+    if (n < 2) {
+      return;
+    }
+
+    // ランを検出する. ランが多すぎる(平均長がmin_run未満)なら何も動かさずに諦める
+    std::vector<std::pair<dif_t, bool>> runs; // (長さ, 降順かどうか)
+    const std::size_t max_runs = static_cast<std::size_t>(n / min_run) + 1;
+    for (iter_t it = a0; it != aN;) {
+      const auto [len, descending] = count_run__(it, aN);
+      runs.emplace_back(len, descending);
+      if (runs.size() > max_runs) {
+        intro_sort(a0, aN, cmp_, block_partition());
+        return;
+      }
+      std::advance(it, len);
+    }
+
+    // 降順のランを反転し、パワーの大きい境界から順にマージする
+    std::vector<run_t> stack;
+    dif_t start = 0;
+    for (const auto &[len, descending] : runs) {
+      if (descending) {
+        std::reverse(a0 + start, a0 + (start + len));
+      }
+      if (!stack.empty()) {
+        run_t &top = stack.back();
+        const int p = power__(top.start, top.len, len, n);
+        while (stack.size() > 1 && stack[stack.size() - 2].power > p) {
+          merge_top__(a0, stack);
+        }
+        stack.back().power = p;
+      }
+      stack.push_back({start, len, 0});
+      start += len;
+    }
+    while (stack.size() > 1) {
+      merge_top__(a0, stack);
+    }
+  }
+
+  /**
+   * @brief [it, aN)の先頭から続くランの長さを数える
+   * @note  降順のランは、反転しても等しい要素の順序が崩れないよう狭義の降順に限ります
+   * @return (ランの長さ, 降順かどうか)
+   */
+  std::pair<dif_t, bool> count_run__(const iter_t it, const iter_t aN) {
+    iter_t j = std::next(it);
+    if (j == aN) {
+      return {1, false};
+    }
+    if (cmp_(*j, *it)) {
+      for (++j; j != aN && cmp_(*j, *std::prev(j)); ++j) {
+      }
+      return {std::distance(it, j), true};
+    }
+    for (++j; j != aN && !cmp_(*j, *std::prev(j)); ++j) {
+    }
+    return {std::distance(it, j), false};
+  }
+
+  /**
+   * @brief 隣り合うラン[s1, s1 + n1)と[s1 + n1, s1 + n1 + n2)の境界のパワーを求める
+   * @note  2つのランの中点を[0, 1)に正規化した値の2進展開が初めて異なる桁の位置です
+   */
+  static int power__(dif_t s1, dif_t n1, dif_t n2, dif_t n) {
+    dif_t a = 2 * s1 + n1; // 中点の2倍
+    dif_t b = a + n1 + n2;
+    int power = 0;
+    while (true) {
+      ++power;
+      if (a >= n) { // 両方の桁が1
+        a -= n;
+        b -= n;
+      } else if (b >= n) { // 桁が初めて異なる
+        break;
+      }
+      a <<= 1;
+      b <<= 1;
+    }
+    return power;
+  }
+
+  /**
+   * @brief スタックの上の2つのランをマージする
+   */
+  void merge_top__(const iter_t a0, std::vector<run_t> &stack) {
+    run_t r = stack.back();
+    stack.pop_back();
+    run_t &l = stack.back();
+    merge__(a0 + l.start, a0 + r.start, a0 + (r.start + r.len));
+    l.len += r.len;
+    l.power = r.power;
+  }
+
+  /**
+   * @brief 指数探索でpredが初めて偽になる位置を探す
+   * @note  from_backが真のときは末尾から探します
+   */
+  template <class It, class Pred>
+  static It gallop__(It first, It last, Pred pred, bool from_back) {
+    const dif_t n = std::distance(first, last);
+    dif_t prev = 0, ofs = 1;
+    if (!from_back) {
+      while (ofs <= n && pred(first[ofs - 1])) {
+        prev = ofs;
+        ofs = 2 * ofs + 1;
+      }
+      return std::partition_point(first + prev, first + std::min(ofs, n), pred);
+    }
+    while (ofs <= n && !pred(last[-ofs])) {
+      prev = ofs;
+      ofs = 2 * ofs + 1;
+    }
+    return std::partition_point(last - std::min(ofs, n), last - prev, pred);
+  }
+
+  /**
+   * @brief 隣り合う整列済みの部分配列[a, m)と[m, b)をマージする
+   * @note  既に正しい位置にある両端を指数探索で除いてから、短い方を作業領域に移します
+   */
+  void merge__(iter_t a, const iter_t m, iter_t b) {
+    const val_t &first_r = *m;
+    a = gallop__(a, m, [&](const val_t &x) { return !cmp_(first_r, x); },
+                 false);
+    if (a == m) {
+      return;
+    }
+    const val_t &last_l = *std::prev(m);
+    b = gallop__(m, b, [&](const val_t &x) { return cmp_(x, last_l); }, true);
+    if (std::distance(a, m) <= std::distance(m, b)) {
+      merge_lo__(a, m, b);
+    } else {
+      merge_hi__(a, m, b);
+    }
+  }
+
+  /**< @brief ギャロッピングで移した要素数に応じてmin_gallopを調整する */
+  void adjust_gallop__(dif_t nl, dif_t nr) {
+    if (nl < initial_gallop && nr < initial_gallop) {
+      ++min_gallop_; // ギャロッピングが効かなかった
+    } else if (min_gallop_ > 1) {
+      --min_gallop_;
+    }
+  }
+
+  /**
+   * @brief 左側を作業領域に移して前からマージする
+   */
+  void merge_lo__(const iter_t a, const iter_t m, const iter_t b) {
+    buf_.assign(std::make_move_iterator(a), std::make_move_iterator(m));
+    auto l = buf_.begin();
+    const auto le = buf_.end();
+    iter_t r = m, out = a;
+    dif_t wl = 0, wr = 0; // 連勝数
+    while (l != le && r != b) {
+      if (wl < min_gallop_ && wr < min_gallop_) {
+        if (cmp_(*r, *l)) {
+          *out++ = std::move(*r++);
+          ++wr;
+          wl = 0;
+        } else {
+          *out++ = std::move(*l++);
+          ++wl;
+          wr = 0;
+        }
+        continue;
+      }
+      // ギャロッピング: 右側の先頭以下の左側の要素と、左側の先頭未満の右側の要素をまとめて移す
+      const val_t &kr = *r;
+      const auto lk =
+          gallop__(l, le, [&](const val_t &x) { return !cmp_(kr, x); }, false);
+      const dif_t nl = std::distance(l, lk);
+      out = std::move(l, lk, out);
+      l = lk;
+      if (l == le) {
+        break;
+      }
+      const val_t &kl = *l;
+      const iter_t rk =
+          gallop__(r, b, [&](const val_t &x) { return cmp_(x, kl); }, false);
+      const dif_t nr = std::distance(r, rk);
+      out = std::move(r, rk, out);
+      r = rk;
+      adjust_gallop__(nl, nr);
+      wl = wr = 0;
+    }
+    std::move(l, le, out); // 残った右側の要素は既に正しい位置にある
+  }
+
+  /**
+   * @brief 右側を作業領域に移して後ろからマージする
+   */
+  void merge_hi__(const iter_t a, const iter_t m, const iter_t b) {
+    buf_.assign(std::make_move_iterator(m), std::make_move_iterator(b));
+    const auto rb = buf_.begin();
+    auto r = buf_.end();
+    iter_t l = m, out = b;
+    dif_t wl = 0, wr = 0; // 連勝数
+    while (l != a && r != rb) {
+      if (wl < min_gallop_ && wr < min_gallop_) {
+        if (cmp_(*std::prev(r), *std::prev(l))) {
+          *--out = std::move(*--l);
+          ++wl;
+          wr = 0;
+        } else {
+          *--out = std::move(*--r);
+          ++wr;
+          wl = 0;
+        }
+        continue;
+      }
+      // ギャロッピング: 左側の末尾以上の右側の要素と、右側の末尾より大きい左側の要素をまとめて移す
+      const val_t &kl = *std::prev(l);
+      const auto rk =
+          gallop__(rb, r, [&](const val_t &x) { return cmp_(x, kl); }, true);
+      const dif_t nr = std::distance(rk, r);
+      out = std::move_backward(rk, r, out);
+      r = rk;
+      if (r == rb) {
+        break;
+      }
+      const val_t &kr = *std::prev(r);
+      const iter_t lk =
+          gallop__(a, l, [&](const val_t &x) { return !cmp_(kr, x); }, true);
+      const dif_t nl = std::distance(lk, l);
+      out = std::move_backward(lk, l, out);
+      l = lk;
+      adjust_gallop__(nl, nr);
+      wl = wr = 0;
+    }
+    std::move_backward(rb, r, out); // 残った左側の要素は既に正しい位置にある
+  }
+};
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  適応的ソートを行います
+ * @note   整列済みに近い入力(追記の多いログ、揺らぎのある時刻など)ではO(n)に近づき、
+ *         そうでない入力ではイントロソートと同程度になります
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ */
+template <class RandomAccessIterator, class Compare>
+inline void adaptive_sort(RandomAccessIterator a0, RandomAccessIterator aN,
+                          Compare cmp) {
+  AdaptiveSort<RandomAccessIterator, Compare> adaptive(cmp);
+  adaptive.sort__(a0, aN);
+}
+
+/**
+ * @brief  適応的ソートを行います(第3引数を省略した場合、こちらが呼ばれます)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ */
+template <class RandomAccessIterator>
+inline void adaptive_sort(RandomAccessIterator a0, RandomAccessIterator aN) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  adaptive_sort(a0, aN, std::less<val_t>());
+}
+
+#endif // endif ADAPTIVE_SORT_HPP
@@ -0,0 +1,99 @@
+/**
+ * @brief 並列ソートが共有する、呼び出し元も手伝うparallel_forの実装
+ * @note  小片の番号は共有の状態から1つずつ配り、プールのスレッドと待っている呼び出し元の
+ *        どちらも残っている小片を取り出して処理します。呼び出し元がプールのスレッドでも
+ *        (1スレッドのプールでも)自分で残りを処理するので、デッドロックしません。
+ * @note  状態はshared_ptrで共有します。プールに投げたタスクはfnへのポインタを持ちますが、
+ *        fnを使うのは小片を取り出せたときだけです。parallel_forが戻った後に実行されたタスクは
+ *        next == countを見て何もせずに戻るので、fnが破棄された後でも安全です。
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef SORT_DETAIL_PARALLEL_FOR_HPP
+#define SORT_DETAIL_PARALLEL_FOR_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include <boost/asio/post.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+//********************************************************************************
+// 名前空間の始まり
+//********************************************************************************
+
+namespace sort_detail {
+
+/**< @brief parallel_forの小片の配り方と終わり方を管理する状態 */
+struct parallel_for_state {
+  std::mutex m;
+  std::condition_variable cv;
+  std::size_t next = 0;   /**< 次に配る小片の番号 */
+  std::size_t count = 0;  /**< 小片の数 */
+  std::size_t remain = 0; /**< まだ終わっていない小片の数 */
+  std::exception_ptr e;   /**< 小片の中で最初に送出された例外 */
+};
+
+/**
+ * @brief  まだ誰も処理していない小片があれば1つ取り出して処理する
+ * @return 小片を処理したかどうか
+ */
+template <class F> bool run_piece(parallel_for_state &st, F &fn) {
+  std::size_t i = 0;
+  {
+    std::lock_guard<std::mutex> lock(st.m);
+    if (st.next == st.count) {
+      return false;
+    }
+    i = st.next++;
+  }
+  std::exception_ptr err;
+  try {
+    fn(i);
+  } catch (...) {
+    err = std::current_exception();
+  }
+  std::lock_guard<std::mutex> lock(st.m);
+  if (err && !st.e) {
+    st.e = err;
+  }
+  if (--st.remain == 0) {
+    st.cv.notify_all();
+  }
+  return true;
+}
+
+/**
+ * @brief fn(0), ..., fn(count - 1)をスレッドプール上で実行し、すべて終わるまで待つ
+ * @note  呼び出し元も残っている小片を処理するので、プールのタスクから呼んでも構いません
+ * @note  タスク内で送出された最初の例外を再送出します
+ * @tparam Pool スレッドプール(boost::asio::post可能なもの)
+ * @tparam F    void(std::size_t)として呼び出せる関数
+ */
+template <class Pool, class F>
+void parallel_for(Pool &pool, std::size_t count, F fn) {
+  const auto st = std::make_shared<parallel_for_state>();
+  st->count = st->remain = count;
+  for (std::size_t i = 1; i < count; i++) {
+    boost::asio::post(pool, [st, f = &fn] { run_piece(*st, *f); });
+  }
+  while (run_piece(*st, fn)) {
+  }
+  std::unique_lock<std::mutex> lock(st->m);
+  st->cv.wait(lock, [&] { return st->remain == 0; });
+  if (st->e) {
+    std::rethrow_exception(st->e);
+  }
+}
+
+} // namespace sort_detail
+
+#endif // endif SORT_DETAIL_PARALLEL_FOR_HPP
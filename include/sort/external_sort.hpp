@@ -0,0 +1,513 @@
+/**
+ * @brief 外部マージソートの実装
+ * @note  メモリに載らない固定長のバイナリレコードのファイルを整列します。
+ *        入力をメモリ予算の半分ずつmmapで(コピーオンライトで)写像してイントロソートし、
+ *        ランとして一時ファイルへ書き出します。書き出しは次のランの整列と重ねて非同期に行います。
+ * @note  ランは敗者木(loser tree)でk-wayマージします。各ランの読み込みと出力の書き込みは
+ *        2枚のバッファを交互に使い、一方を処理している間にもう一方を非同期に読み書きします。
+ *        ランの数がマージの次数を超えるときは、複数回に分けてマージします。
+ * @note  POSIX(mmap, pread, pwrite)のみに対応しています。
+ * @note  Reference: D. E. Knuth, "The Art of Computer Programming Vol. 3",
+ * 5.4.1 Multiway Merging and Replacement Selection.
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef EXTERNAL_SORT_HPP
+#define EXTERNAL_SORT_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "sort/intro_sort.hpp"
+#include "sort/k_way_merge.hpp"
+#include "sort/parallel_intro_sort.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//********************************************************************************
+// 型の定義
+//********************************************************************************
+
+/**< @brief 外部マージソートの設定 */
+struct external_sort_options {
+  std::size_t memory_budget = std::size_t(256) << 20; /**< 使うメモリの上限(バイト) */
+  std::filesystem::path temp_dir =
+      std::filesystem::temp_directory_path(); /**< ランを置くディレクトリ */
+  std::size_t io_block = std::size_t(1) << 20; /**< マージ時の読み書きの最小単位(バイト) */
+};
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  外部マージソートクラス
+ * @tparam Record  レコードの型(トリビアルにコピーできる固定長の型)
+ * @tparam Compare 比較述語
+ */
+template <class Record, class Compare> class ExternalSort {
+  static_assert(std::is_trivially_copyable_v<Record>,
+                "Record must be trivially copyable");
+
+private:
+  using rec_t = Record;
+  using cmp_t = Compare;
+
+  template <class Rec, class Cmp, class Pool>
+  friend void external_sort(const std::filesystem::path &input,
+                            const std::filesystem::path &output, Cmp cmp,
+                            const external_sort_options &options, Pool &pool);
+  template <class Rec, class Cmp>
+  friend void external_sort(const std::filesystem::path &input,
+                            const std::filesystem::path &output, Cmp cmp,
+                            const external_sort_options &options);
+
+  ExternalSort(cmp_t cmp, const external_sort_options &options)
+      : cmp_(cmp), options_(options),
+        id_(std::to_string(::getpid()) + "-" +
+            std::to_string(counter().fetch_add(1))) {}
+
+  cmp_t cmp_;                     /**< 比較述語 */
+  external_sort_options options_; /**< 設定 */
+  std::string id_;                /**< 一時ファイル名の接頭辞 */
+  std::size_t runs_ = 0;          /**< 作ったランの数 */
+
+  /**< @brief プロセス内で一時ファイル名を区別するための通し番号 */
+  static std::atomic<std::size_t> &counter() {
+    static std::atomic<std::size_t> c{0};
+    return c;
+  }
+
+  /**< @brief errnoをstd::system_errorとして投げる */
+  [[noreturn]] static void fail__(const std::string &what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  /**< @brief ファイル記述子を閉じるRAIIクラス */
+  class file {
+  public:
+    file(const std::filesystem::path &path, int flags)
+        : fd_(::open(path.c_str(), flags | O_CLOEXEC, 0644)) {
+      if (fd_ < 0) {
+        fail__("open " + path.string());
+      }
+    }
+    file(const file &) = delete;
+    file &operator=(const file &) = delete;
+    ~file() { ::close(fd_); }
+    int get() const noexcept { return fd_; }
+
+  private:
+    int fd_;
+  };
+
+  /**< @brief 破棄するときに削除される一時ファイル(ラン) */
+  class run {
+  public:
+    explicit run(std::filesystem::path path) : path_(std::move(path)) {}
+    run(run &&r) noexcept : path_(std::move(r.path_)) { r.path_.clear(); }
+    run &operator=(run &&r) noexcept {
+      std::swap(path_, r.path_);
+      return *this;
+    }
+    ~run() {
+      if (!path_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+      }
+    }
+    const std::filesystem::path &path() const noexcept { return path_; }
+
+  private:
+    std::filesystem::path path_;
+  };
+
+  /**
+   * @brief ファイルのoffsetからnバイトを読み込む
+   * @return 読み込んだバイト数(ファイルの末尾ではnより少なくなります)
+   */
+  static std::size_t read_all__(int fd, void *buf, std::size_t n, off_t offset) {
+    std::size_t done = 0;
+    while (done < n) {
+      const ssize_t r = ::pread(fd, static_cast<char *>(buf) + done, n - done,
+                                offset + static_cast<off_t>(done));
+      if (r < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        fail__("pread");
+      }
+      if (r == 0) {
+        break;
+      }
+      done += static_cast<std::size_t>(r);
+    }
+    return done;
+  }
+
+  /**< @brief ファイルのoffsetへnバイトを書き込む */
+  static void write_all__(int fd, const void *buf, std::size_t n, off_t offset) {
+    std::size_t done = 0;
+    while (done < n) {
+      const ssize_t r =
+          ::pwrite(fd, static_cast<const char *>(buf) + done, n - done,
+                   offset + static_cast<off_t>(done));
+      if (r < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        fail__("pwrite");
+      }
+      done += static_cast<std::size_t>(r);
+    }
+  }
+
+  /**
+   * @brief ランを先読みしながら1レコードずつ読むクラス
+   * @note  表のバッファを読んでいる間に、裏のバッファへ次のブロックを非同期に読み込みます
+   */
+  class reader {
+  public:
+    reader(const std::filesystem::path &path, std::size_t block)
+        : file_(path, O_RDONLY), front_(block), back_(block) {
+      prefetch__();
+      refill__();
+    }
+    reader(const reader &) = delete;
+    reader &operator=(const reader &) = delete;
+    ~reader() {
+      if (pending_.valid()) {
+        pending_.wait();
+      }
+    }
+
+    /**< @brief 読み終えたかどうか */
+    bool empty() const noexcept { return i_ == n_; }
+    /**< @brief 現在のレコード */
+    const rec_t &front() const noexcept { return front_[i_]; }
+    /**< @brief 次のレコードへ進む */
+    void pop() {
+      if (++i_ == n_) {
+        refill__();
+      }
+    }
+
+  private:
+    file file_;
+    std::vector<rec_t> front_, back_;
+    std::size_t i_ = 0, n_ = 0; /**< 表のバッファの読み出し位置と要素数 */
+    off_t offset_ = 0;          /**< 次に読み込むファイル上の位置 */
+    bool eof_ = false;
+    std::future<std::size_t> pending_;
+
+    /**< @brief 裏のバッファへの読み込みを始める */
+    void prefetch__() {
+      if (eof_) {
+        return;
+      }
+      const int fd = file_.get();
+      rec_t *buf = back_.data();
+      const std::size_t bytes = back_.size() * sizeof(rec_t);
+      const off_t offset = offset_;
+      offset_ += static_cast<off_t>(bytes);
+      pending_ = std::async(std::launch::async, [=] {
+        return read_all__(fd, buf, bytes, offset) / sizeof(rec_t);
+      });
+    }
+
+    /**< @brief 読み込みの完了を待って表と裏を入れ替え、次の読み込みを始める */
+    void refill__() {
+      i_ = n_ = 0;
+      if (!pending_.valid()) {
+        return;
+      }
+      n_ = pending_.get();
+      std::swap(front_, back_);
+      eof_ = n_ < front_.size();
+      prefetch__();
+    }
+  };
+
+  /**
+   * @brief レコードを貯めてファイルへ書き出すクラス
+   * @note  表のバッファへ貯めている間に、裏のバッファを非同期に書き出します
+   */
+  class writer {
+  public:
+    writer(const std::filesystem::path &path, std::size_t block)
+        : file_(path, O_WRONLY | O_CREAT | O_TRUNC) {
+      front_.reserve(block);
+      back_.reserve(block);
+    }
+    writer(const writer &) = delete;
+    writer &operator=(const writer &) = delete;
+    ~writer() {
+      if (pending_.valid()) {
+        pending_.wait();
+      }
+    }
+
+    /**< @brief レコードxを書く */
+    void push(const rec_t &x) {
+      front_.push_back(x);
+      if (front_.size() == front_.capacity()) {
+        flush__();
+      }
+    }
+
+    /**< @brief 残りを書き出して完了を待つ */
+    void close() {
+      flush__();
+      if (pending_.valid()) {
+        pending_.get();
+      }
+    }
+
+  private:
+    file file_;
+    std::vector<rec_t> front_, back_;
+    off_t offset_ = 0; /**< 次に書き込むファイル上の位置 */
+    std::future<void> pending_;
+
+    /**< @brief 前の書き込みの完了を待って表と裏を入れ替え、表を書き出し始める */
+    void flush__() {
+      if (pending_.valid()) {
+        pending_.get();
+      }
+      if (front_.empty()) {
+        return;
+      }
+      std::swap(front_, back_);
+      front_.clear();
+      const int fd = file_.get();
+      const rec_t *buf = back_.data();
+      const std::size_t bytes = back_.size() * sizeof(rec_t);
+      const off_t offset = offset_;
+      offset_ += static_cast<off_t>(bytes);
+      pending_ = std::async(std::launch::async,
+                            [=] { write_all__(fd, buf, bytes, offset); });
+    }
+  };
+
+  /**< @brief 敗者木から読み込みクラスを列として扱うための参照 */
+  struct run_source {
+    reader *r;
+    bool empty() const noexcept { return r->empty(); }
+    const rec_t &front() const noexcept { return r->front(); }
+    void pop() { r->pop(); }
+  };
+
+  /**< @brief 新しい一時ファイルのパスを返す */
+  std::filesystem::path temp_path__() {
+    return options_.temp_dir /
+           ("external_sort-" + id_ + "-" + std::to_string(runs_++) + ".run");
+  }
+
+  /**
+   * @brief inputを整列してoutputへ書き出す
+   * @param sort_fn 配列[a0, aN)を整列する関数
+   */
+  template <class SortFn>
+  void sort__(const std::filesystem::path &input,
+              const std::filesystem::path &output, SortFn sort_fn) {
+    std::vector<run> runs = make_runs__(input, sort_fn);
+    const std::size_t fan_in = fan_in__();
+    while (runs.size() > fan_in) { // マージの次数に収まるまでランをまとめる
+      std::vector<run> next;
+      for (std::size_t i = 0; i < runs.size(); i += fan_in) {
+        const std::size_t j = std::min(i + fan_in, runs.size());
+        run r(temp_path__());
+        merge__(runs.begin() + i, runs.begin() + j, r.path());
+        next.push_back(std::move(r));
+      }
+      runs = std::move(next);
+    }
+    merge__(runs.begin(), runs.end(), output);
+  }
+
+  /**
+   * @brief 入力をメモリ予算の半分ずつ写像して整列し、ランとして書き出す
+   * @note  写像はコピーオンライト(MAP_PRIVATE)なので入力ファイルは書き換えません
+   */
+  template <class SortFn>
+  std::vector<run> make_runs__(const std::filesystem::path &input,
+                               SortFn sort_fn) {
+    const file in(input, O_RDONLY);
+    struct stat st;
+    if (::fstat(in.get(), &st) != 0) {
+      fail__("fstat " + input.string());
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    if (size % sizeof(rec_t) != 0) {
+      throw std::invalid_argument("external_sort: size of " + input.string() +
+                                  " is not a multiple of the record size");
+    }
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    // 整列中のランと書き出し中のランで予算を半分ずつ使う
+    const std::size_t chunk =
+        std::max<std::size_t>(1, options_.memory_budget / 2 / sizeof(rec_t)) *
+        sizeof(rec_t);
+
+    std::vector<run> runs;
+    std::future<void> pending;
+    void *prev = nullptr;
+    std::size_t prev_len = 0;
+    auto release = [&] { // 前のランの書き出しを待って写像を解放する
+      if (pending.valid()) {
+        pending.wait();
+      }
+      if (prev != nullptr) {
+        ::munmap(prev, prev_len);
+        prev = nullptr;
+      }
+    };
+    auto finish = [&] { // 解放して、書き出しの例外があれば投げる
+      release();
+      if (pending.valid()) {
+        pending.get();
+      }
+    };
+    try {
+      for (std::size_t pos = 0; pos < size; pos += chunk) {
+        const std::size_t len = std::min(chunk, size - pos);
+        const std::size_t skew = pos % page; // 写像の開始位置はページ境界に揃える
+        void *map = ::mmap(nullptr, len + skew, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE, in.get(), static_cast<off_t>(pos - skew));
+        if (map == MAP_FAILED) {
+          fail__("mmap " + input.string());
+        }
+        rec_t *a0 = reinterpret_cast<rec_t *>(static_cast<char *>(map) + skew);
+        rec_t *aN = a0 + len / sizeof(rec_t);
+        try {
+          sort_fn(a0, aN);
+        } catch (...) {
+          ::munmap(map, len + skew);
+          throw;
+        }
+        finish();
+        prev = map;
+        prev_len = len + skew;
+        runs.emplace_back(temp_path__());
+        auto out = std::make_shared<file>(runs.back().path(),
+                                          O_WRONLY | O_CREAT | O_TRUNC);
+        pending = std::async(std::launch::async, [out, a0, len] {
+          write_all__(out->get(), a0, len, 0);
+        });
+      }
+      finish();
+    } catch (...) {
+      release();
+      throw;
+    }
+    return runs;
+  }
+
+  /**< @brief マージの次数(2枚ずつのバッファが予算に収まる最大のラン数) */
+  std::size_t fan_in__() const {
+    const std::size_t block = std::max(options_.io_block, sizeof(rec_t));
+    return std::max<std::size_t>(2, options_.memory_budget / (2 * block) - 1);
+  }
+
+  /**< @brief ラン[first, last)を敗者木でマージしてoutputへ書き出す */
+  template <class RunIt>
+  void merge__(RunIt first, RunIt last, const std::filesystem::path &output) {
+    const std::size_t k = static_cast<std::size_t>(std::distance(first, last));
+    // 入力k本と出力1本がそれぞれ2枚のバッファを持つ
+    const std::size_t block =
+        std::max<std::size_t>(1, options_.memory_budget / (2 * (k + 1)) /
+                                     sizeof(rec_t));
+    std::vector<std::unique_ptr<reader>> readers;
+    std::vector<run_source> in;
+    for (auto it = first; it != last; ++it) {
+      readers.push_back(std::make_unique<reader>(it->path(), block));
+      in.push_back({readers.back().get()});
+    }
+    writer out(output, block);
+    LoserTree<run_source, cmp_t> tree(std::move(in), cmp_);
+    while (!tree.empty()) {
+      out.push(tree.top());
+      tree.pop();
+    }
+    out.close();
+  }
+};
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  外部マージソートを行います(ランはスレッドプール上で並列に整列します)
+ * @note   inputとoutputは同じファイルでも構いません
+ * @tparam Record                          レコードの型
+ * @tparam Compare                         比較述語
+ * @tparam Pool                            スレッドプール
+ * @param  const std::filesystem::path& input   入力ファイル(Recordを並べたバイナリ)
+ * @param  const std::filesystem::path& output  出力ファイル
+ * @param  Compare cmp                     比較述語
+ * @param  const external_sort_options& options 設定
+ * @param  Pool& pool                      スレッドプール
+ */
+template <class Record, class Compare, class Pool>
+inline void external_sort(const std::filesystem::path &input,
+                          const std::filesystem::path &output, Compare cmp,
+                          const external_sort_options &options, Pool &pool) {
+  ExternalSort<Record, Compare> s(cmp, options);
+  s.sort__(input, output, [&](Record *a0, Record *aN) {
+    parallel_intro_sort(a0, aN, cmp, pool);
+  });
+}
+
+/**
+ * @brief  外部マージソートを行います(スレッドプールを省略した場合、こちらが呼ばれます)
+ * @tparam Record                          レコードの型
+ * @tparam Compare                         比較述語
+ * @param  const std::filesystem::path& input   入力ファイル(Recordを並べたバイナリ)
+ * @param  const std::filesystem::path& output  出力ファイル
+ * @param  Compare cmp                     比較述語
+ * @param  const external_sort_options& options 設定
+ */
+template <class Record, class Compare>
+inline void external_sort(const std::filesystem::path &input,
+                          const std::filesystem::path &output, Compare cmp,
+                          const external_sort_options &options) {
+  ExternalSort<Record, Compare> s(cmp, options);
+  s.sort__(input, output,
+           [&](Record *a0, Record *aN) { intro_sort(a0, aN, cmp); });
+}
+
+/**
+ * @brief  外部マージソートを行います(比較述語と設定を省略した場合、こちらが呼ばれます)
+ * @tparam Record                          レコードの型
+ * @param  const std::filesystem::path& input   入力ファイル(Recordを並べたバイナリ)
+ * @param  const std::filesystem::path& output  出力ファイル
+ */
+template <class Record>
+inline void external_sort(const std::filesystem::path &input,
+                          const std::filesystem::path &output) {
+  external_sort<Record>(input, output, std::less<Record>(),
+                        external_sort_options());
+}
+
+#endif // endif EXTERNAL_SORT_HPP
@@ -0,0 +1,240 @@
+/**
+ * @brief 間接ソート(キーと添字の組を整列してから、値の列を並べ替える)の実装
+ * @note  大きなレコードを直接整列すると交換の度にレコード全体が動くので、
+ *        (キー, 添字)の小さな配列を整列して置換を求め、値の列(SoA)は最後に
+ *        1回の集める(gather)走査でまとめて並べ替えます。
+ * @note  キーが32ビット以下の算術型で比較述語がstd::lessのときは基数ソート(LSD)、
+ *        それ以外は添字でタイブレークしたイントロソート(ブロック分割)で整列します。
+ *        どちらも等しいキーの元の順序を保ちます(安定)。
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef INDIRECT_SORT_HPP
+#define INDIRECT_SORT_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "sort/intro_sort.hpp"
+#include "sort/radix_sort.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  間接ソートクラス
+ * @tparam Key     キーの型
+ * @tparam Compare 比較述語
+ */
+template <class Key, class Compare> class IndirectSort {
+private:
+  using key_t = Key;
+  using cmp_t = Compare;
+
+  template <class Keys, class Cmp>
+  friend std::vector<std::size_t> sort_indices(const Keys &keys, Cmp cmp);
+  template <class Keys, class Cmp, class... Columns>
+    requires std::is_invocable_r_v<bool, Cmp &,
+                                   const typename Keys::value_type &,
+                                   const typename Keys::value_type &>
+  friend void sort_by_key(Keys &keys, Cmp cmp, Columns &...columns);
+
+  /**< @brief 基数ソートを使うかどうか */
+  static constexpr bool use_radix =
+      std::is_arithmetic_v<key_t> && !std::is_same_v<key_t, bool> &&
+      sizeof(key_t) <= 4 &&
+      (std::is_same_v<cmp_t, std::less<key_t>> ||
+       std::is_same_v<cmp_t, std::less<>>);
+
+  /**< @brief 整列する(キー, 添字)の組 */
+  template <class Index> struct entry {
+    key_t key;
+    Index index;
+  };
+
+  explicit IndirectSort(cmp_t cmp) : cmp_(cmp) {}
+
+  cmp_t cmp_; /**< 比較述語 */
+
+  /**
+   * @brief keysを整列したときの置換を求める
+   * @note  要素数が2^32未満なら添字を32ビットにして組を小さく保ちます
+   * @param fn 整列済みの組の配列を受け取る関数
+   */
+  template <class Keys, class Fn> void sort__(const Keys &keys, Fn fn) {
+    const std::size_t n = std::size(keys);
+    if (n <= std::numeric_limits<std::uint32_t>::max()) {
+      fn(entries__<std::uint32_t>(keys, n));
+    } else {
+      fn(entries__<std::size_t>(keys, n));
+    }
+  }
+
+  /**< @brief (キー, 添字)の組を作って整列する */
+  template <class Index, class Keys>
+  std::vector<entry<Index>> entries__(const Keys &keys, std::size_t n) {
+    std::vector<entry<Index>> e;
+    e.reserve(n);
+    Index i = 0;
+    for (const auto &k : keys) {
+      e.push_back({k, i++});
+    }
+    if constexpr (use_radix) {
+      radix_sort(e.begin(), e.end(),
+                 [](const entry<Index> &x) { return x.key; });
+    } else {
+      intro_sort(
+          e.begin(), e.end(),
+          [this](const entry<Index> &x, const entry<Index> &y) {
+            return cmp_(x.key, y.key) ||
+                   (!cmp_(y.key, x.key) && x.index < y.index);
+          },
+          block_partition());
+    }
+    return e;
+  }
+
+  /**
+   * @brief 置換eに従って値の列columnsを並べ替え、キーを書き戻す
+   * @note  置換を1回走査する間に全ての列から集め、キーは組から順に書き戻します
+   */
+  template <class Keys, class Entries, class... Columns>
+  static void gather__(Keys &keys, const Entries &e, Columns &...columns) {
+    const std::size_t n = e.size();
+    std::tuple<std::vector<typename Columns::value_type>...> out;
+    std::apply([n](auto &...o) { (o.reserve(n), ...); }, out);
+    auto k = std::begin(keys);
+    for (std::size_t i = 0; i < n; ++i, ++k) {
+      if constexpr (sizeof...(Columns) > 0) { // 列が無ければキーを書き戻すだけ
+        if (i + ahead < n) { // 先の要素を読み込んでおき、ランダムアクセスの待ちを隠す
+          const std::size_t q = static_cast<std::size_t>(e[i + ahead].index);
+          (prefetch__(columns, q), ...);
+        }
+        const std::size_t p = static_cast<std::size_t>(e[i].index);
+        std::apply(
+            [&](auto &...o) { (o.push_back(std::move(columns[p])), ...); },
+            out);
+      }
+      *k = e[i].key;
+    }
+    std::apply([&](auto &...o) { (assign__(columns, o), ...); }, out);
+  }
+
+  static constexpr std::size_t ahead = 16; /**< 先読みする距離(要素数) */
+
+  /**
+   * @brief 連続したメモリの列cのi番目をキャッシュへ読み込んでおく
+   * @note  GCC/Clang以外のコンパイラでは何もしません
+   */
+  template <class Column>
+  static void prefetch__([[maybe_unused]] const Column &c,
+                         [[maybe_unused]] std::size_t i) {
+#if defined(__GNUC__)
+    if constexpr (std::contiguous_iterator<decltype(std::begin(c))>) {
+      const char *p = reinterpret_cast<const char *>(std::data(c) + i);
+      for (std::size_t b = 0; b < sizeof(*std::data(c)); b += 64) {
+        __builtin_prefetch(p + b);
+      }
+    }
+#endif
+  }
+
+  /**< @brief 集めた値oを列cに戻す(std::vectorなら入れ替えるだけで済ませる) */
+  template <class Column, class T>
+  static void assign__(Column &c, std::vector<T> &o) {
+    if constexpr (std::is_same_v<Column, std::vector<T>>) {
+      c.swap(o);
+    } else {
+      std::move(o.begin(), o.end(), std::begin(c));
+    }
+  }
+};
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  keysを整列したときの置換を求めます
+ * @note   戻り値のi番目は、整列後にi番目に来る要素のkeysでの添字です(安定)
+ * @tparam Keys        キーの列(ランダムアクセスできるコンテナ)
+ * @tparam Compare     比較述語
+ * @param  const Keys& keys キーの列
+ * @param  Compare     cmp  比較述語
+ * @return 置換
+ */
+template <class Keys, class Compare>
+inline std::vector<std::size_t> sort_indices(const Keys &keys, Compare cmp) {
+  IndirectSort<typename Keys::value_type, Compare> s(cmp);
+  std::vector<std::size_t> perm;
+  s.sort__(keys, [&perm](const auto &e) {
+    perm.reserve(e.size());
+    for (const auto &x : e) {
+      perm.push_back(static_cast<std::size_t>(x.index));
+    }
+  });
+  return perm;
+}
+
+/**
+ * @brief  keysを整列したときの置換を求めます(第2引数を省略した場合、こちらが呼ばれます)
+ * @tparam Keys        キーの列(ランダムアクセスできるコンテナ)
+ * @param  const Keys& keys キーの列
+ * @return 置換
+ */
+template <class Keys>
+inline std::vector<std::size_t> sort_indices(const Keys &keys) {
+  return sort_indices(keys, std::less<typename Keys::value_type>());
+}
+
+/**
+ * @brief  キーの列keysを整列し、値の列columnsを同じ順に並べ替えます(安定)
+ * @tparam Keys               キーの列(ランダムアクセスできるコンテナ)
+ * @tparam Compare            比較述語
+ * @tparam Columns            値の列(keysと同じ長さのランダムアクセスできるコンテナ)
+ * @param  Keys&      keys    キーの列
+ * @param  Compare    cmp     比較述語
+ * @param  Columns&...columns 値の列
+ */
+template <class Keys, class Compare, class... Columns>
+  requires std::is_invocable_r_v<bool, Compare &,
+                                 const typename Keys::value_type &,
+                                 const typename Keys::value_type &>
+inline void sort_by_key(Keys &keys, Compare cmp, Columns &...columns) {
+  using sort_t = IndirectSort<typename Keys::value_type, Compare>;
+  if (((std::size(columns) != std::size(keys)) || ...)) {
+    throw std::invalid_argument("sort_by_key: column size mismatch");
+  }
+  sort_t s(cmp);
+  s.sort__(keys, [&](const auto &e) { sort_t::gather__(keys, e, columns...); });
+}
+
+/**
+ * @brief  キーの列keysを整列し、値の列columnsを同じ順に並べ替えます(比較述語を省略した場合、こちらが呼ばれます)
+ * @tparam Keys               キーの列(ランダムアクセスできるコンテナ)
+ * @tparam Columns            値の列(keysと同じ長さのランダムアクセスできるコンテナ)
+ * @param  Keys&      keys    キーの列
+ * @param  Columns&...columns 値の列
+ */
+template <class Keys, class... Columns>
+inline void sort_by_key(Keys &keys, Columns &...columns) {
+  sort_by_key(keys, std::less<typename Keys::value_type>(), columns...);
+}
+
+#endif // endif INDIRECT_SORT_HPP
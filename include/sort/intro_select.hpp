@@ -0,0 +1,271 @@
+/**
+ * @brief イントロセレクト(選択)と部分ソート、上位k個の逐次集計の実装
+ * @note  イントロソートの分割(3要素中央値によるHoareの分割)を片側にだけ再帰させて
+ *        k番目の要素を選びます。分割3回で範囲が半分以下にならなかったら、以降は
+ *        中央値の中央値(median-of-medians)をピボットとする3分割に切り替えます。
+ *        Hoareの分割にかかる時間は範囲が半分になる毎に減る等比級数で抑えられ、
+ *        中央値の中央値は線形時間なので、最悪でもO(n)になります。
+ * @note  std::nth_element, std::partial_sortと引数依存の名前探索で衝突しないよう、
+ *        intro_select, intro_partial_sortと名付けています。
+ * @note  Reference: D. R. Musser, "Introspective Sorting and Selection
+ * Algorithms", Software: Practice and Experience, 1997.
+ * @note  Reference: M. Blum et al., "Time bounds for selection", JCSS, 1973.
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef INTRO_SELECT_HPP
+#define INTRO_SELECT_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "sort/intro_sort.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  イントロセレクトクラス
+ * @tparam RandomAccessIterator (ランダムアクセス)イテレータ
+ * @tparam Compare              比較述語
+ */
+template <class RandomAccessIterator, class Compare> class IntroSelect {
+private:
+  using iter_t = RandomAccessIterator;
+  using cmp_t = Compare;
+  using intro_t = IntroSort<iter_t, cmp_t>;
+  using val_t = typename std::iterator_traits<iter_t>::value_type;
+  using dif_t = typename std::iterator_traits<iter_t>::difference_type;
+  using depth_t = std::size_t;
+
+  template <class RAI, class Cmp>
+  friend void intro_select(RAI a0, RAI nth, RAI aN, Cmp cmp);
+
+  static constexpr dif_t k = 16; /**< これ以下の部分配列は挿入ソートで選びます */
+
+  explicit IntroSelect(cmp_t cmp) : intro_(cmp, k), cmp_(cmp) {}
+
+  intro_t intro_; /**< 分割を行うイントロソート */
+  cmp_t cmp_;     /**< 比較述語 */
+
+  static constexpr int window = 3; /**< 範囲が半分になるのを待つ分割の回数 */
+
+  /**
+   * @brief [a0, aN)を並べ替え、nthの位置に整列したときと同じ要素を置く
+   * @note  [a0, nth)の要素はnth以下、(nth, aN)の要素はnth以上になります
+   * @param iter_t a0  先頭イテレータ
+   * @param iter_t nth 選ぶ位置
+   * @param iter_t aN  末尾の次を指すイテレータ
+   * @param bool   mom 最初から中央値の中央値だけを使うかどうか
+   */
+  void select__(iter_t a0, const iter_t nth, iter_t aN, bool mom = false) {
+    dif_t start = std::distance(a0, aN); // 今の窓の始めの要素数
+    int steps = 0;
+    while (std::distance(a0, aN) > k) {
+      if (mom) {
+        // 中央値の中央値で必ず3割以上を取り除く
+        const val_t pivot = median_of_medians__(a0, aN);
+        const auto p = intro_.partition3__(a0, aN, pivot);
+        if (nth < p.first) {
+          aN = p.first;
+        } else if (nth < p.second) {
+          return; // nthはピボットと等しい
+        } else {
+          a0 = p.second;
+        }
+        continue;
+      }
+      // [a0, aP)はピボット以下、[aP, aN)はピボット以上
+      const iter_t aP = std::next(intro_.partition__(
+          a0, std::prev(aN), std::distance(a0, aN) - 1));
+      if (nth < aP) {
+        aN = aP;
+      } else {
+        a0 = aP;
+      }
+      if (++steps == window) {
+        // 分割が偏り続けたので、中央値の中央値に切り替える
+        const dif_t n = std::distance(a0, aN);
+        mom = n * 2 > start;
+        start = n;
+        steps = 0;
+      }
+    }
+    intro_t::final_insertion_sort__(a0, aN, cmp_);
+  }
+
+  /**
+   * @brief [a0, aN)の中央値の中央値を求める
+   * @note  5要素ずつの組の中央値を先頭に集め、その中央値を中央値の中央値だけで再帰的に選びます
+   *        (Hoareの分割からやり直すと線形時間の保証が崩れるため)
+   */
+  val_t median_of_medians__(const iter_t a0, const iter_t aN) {
+    const dif_t n = std::distance(a0, aN);
+    dif_t groups = 0;
+    for (dif_t i = 0; i < n; i += 5, groups++) {
+      const iter_t g0 = a0 + i, gN = a0 + std::min(i + 5, n);
+      intro_t::final_insertion_sort__(g0, gN, cmp_);
+      std::iter_swap(a0 + groups, g0 + std::distance(g0, gN) / 2);
+    }
+    const iter_t mid = a0 + groups / 2;
+    select__(a0, mid, a0 + groups, true);
+    return *mid;
+  }
+};
+
+/**
+ * @brief  上位k個の逐次集計クラス
+ * @note   要素数kのヒープだけを持ち、終わりの分からない入力から比較述語の順で大きい方のk個を保ちます.
+ *         1要素あたりO(log k)、メモリはO(k)です
+ * @tparam T       要素の型
+ * @tparam Compare 比較述語(std::lessなら大きい方のk個を保ちます)
+ */
+template <class T, class Compare = std::less<T>> class top_k {
+public:
+  /**
+   * @brief コンストラクタ
+   * @param std::size_t k   保つ要素数
+   * @param Compare     cmp 比較述語
+   */
+  explicit top_k(std::size_t k, Compare cmp = Compare())
+      : k_(k), heap_cmp_{cmp} {
+    heap_.reserve(k);
+  }
+
+  /**< @brief 要素xを加える */
+  void push(const T &x) {
+    if (heap_.size() < k_) {
+      heap_.push_back(x);
+      std::push_heap(heap_.begin(), heap_.end(), heap_cmp_);
+    } else if (k_ != 0 && heap_cmp_.cmp(heap_.front(), x)) {
+      // 保っている中で最も小さい要素より大きいときだけ入れ替える
+      std::pop_heap(heap_.begin(), heap_.end(), heap_cmp_);
+      heap_.back() = x;
+      std::push_heap(heap_.begin(), heap_.end(), heap_cmp_);
+    }
+  }
+
+  /**< @brief 要素[first, last)を加える */
+  template <class InputIt> void push(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      push(*first);
+    }
+  }
+
+  /**< @brief 保っている要素数を返す */
+  std::size_t size() const noexcept { return heap_.size(); }
+
+  /**< @brief 保っている中で最も小さい要素(k番目)を返す */
+  const T &threshold() const { return heap_.front(); }
+
+  /**< @brief 保っている要素を大きい順に並べて返す */
+  std::vector<T> sorted() const {
+    std::vector<T> v = heap_;
+    std::sort_heap(v.begin(), v.end(), heap_cmp_); // 比較述語の逆順(大きい順)
+    return v;
+  }
+
+  /**< @brief 空にする */
+  void clear() noexcept { heap_.clear(); }
+
+private:
+  /**< @brief 先頭に最も小さい要素を置くヒープの比較述語 */
+  struct heap_cmp {
+    Compare cmp;
+    bool operator()(const T &x, const T &y) const { return cmp(y, x); }
+  };
+
+  std::size_t k_;      /**< 保つ要素数 */
+  heap_cmp heap_cmp_;  /**< ヒープの比較述語 */
+  std::vector<T> heap_; /**< 保っている要素のヒープ */
+};
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  イントロセレクトを行います
+ * @note   nthの位置には整列したときと同じ要素が置かれ、[a0, nth)にはそれ以下、
+ *         (nth, aN)にはそれ以上の要素が集まります
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator nth   選ぶ位置
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ */
+template <class RandomAccessIterator, class Compare>
+inline void intro_select(RandomAccessIterator a0, RandomAccessIterator nth,
+                         RandomAccessIterator aN, Compare cmp) {
+  if (nth == aN) {
+    return;
+  }
+  IntroSelect<RandomAccessIterator, Compare> select(cmp);
+  select.select__(a0, nth, aN);
+}
+
+/**
+ * @brief  イントロセレクトを行います(第4引数を省略した場合、こちらが呼ばれます)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator nth   選ぶ位置
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ */
+template <class RandomAccessIterator>
+inline void intro_select(RandomAccessIterator a0, RandomAccessIterator nth,
+                         RandomAccessIterator aN) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  intro_select(a0, nth, aN, std::less<val_t>());
+}
+
+/**
+ * @brief  部分ソートを行います
+ * @note   [a0, aM)に整列したときの先頭の要素を整列して置きます.
+ *         イントロセレクトで先頭の要素を集めてからイントロソートするので、O(n + m log m)です
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aM    整列する範囲の末尾の次を指すイテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ */
+template <class RandomAccessIterator, class Compare>
+inline void intro_partial_sort(RandomAccessIterator a0,
+                               RandomAccessIterator aM,
+                               RandomAccessIterator aN, Compare cmp) {
+  if (a0 == aM) {
+    return;
+  }
+  intro_select(a0, std::prev(aM), aN, cmp);
+  intro_sort(a0, std::prev(aM), cmp); // aM - 1は既に正しい位置にある
+}
+
+/**
+ * @brief  部分ソートを行います(第4引数を省略した場合、こちらが呼ばれます)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aM    整列する範囲の末尾の次を指すイテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ */
+template <class RandomAccessIterator>
+inline void intro_partial_sort(RandomAccessIterator a0,
+                               RandomAccessIterator aM,
+                               RandomAccessIterator aN) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  intro_partial_sort(a0, aM, aN, std::less<val_t>());
+}
+
+#endif // endif INTRO_SELECT_HPP
@@ -16,11 +16,34 @@
 // 必要なヘッダファイルのインクルード
 //********************************************************************************
 
+#include "bit/bit.hpp"
+#include "sort/sorting_network.hpp"
 #include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <iterator>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
+//********************************************************************************
+// 分割方法(ポリシー)の定義
+//********************************************************************************
+
+/**< @brief Hoareの分割(従来の方法) */
+struct hoare_partition {};
+
+/**
+ * @brief ブロック分割(BlockQuicksort/pattern-defeating quicksort)
+ * @note  要素を64個ずつのブロックで比較し、反対側に移すべき要素の位置を分岐なしで記録してから
+ *        まとめて交換します. 偏った分割の後は要素をいくつか入れ替えてパターンを崩し、
+ *        交換の要らなかった分割の後は部分的な挿入ソートで整列済みかどうかを確かめます
+ * @note  Reference: S. Edelkamp and A. Weiss, "BlockQuicksort: How Branch
+ * Mispredictions don't affect Quicksort", ESA 2016.
+ * @note  Reference: O. R. L. Peters, "Pattern-defeating Quicksort", 2021.
+ */
+struct block_partition {};
+
 //********************************************************************************
 // クラスの定義
 //********************************************************************************
@@ -29,11 +52,15 @@
  * @brief  イントロソートクラス
  * @tparam RandomAccessIterator (ランダムアクセス)イテレータ
  * @tparam Compare              比較述語
+ * @tparam Partition            分割方法(hoare_partition または block_partition)
  */
-template <class RandomAccessIterator, class Compare> class IntroSort {
+template <class RandomAccessIterator, class Compare,
+          class Partition = hoare_partition>
+class IntroSort {
 private:
   using iter_t = RandomAccessIterator;
   using cmp_t = Compare;
+  using partition_t = Partition;
   using val_t = typename std::iterator_traits<iter_t>::value_type;
   using dif_t = typename std::iterator_traits<iter_t>::difference_type;
   using ref_t = typename std::iterator_traits<iter_t>::reference;
@@ -42,36 +69,37 @@ private:
 
   constexpr IntroSort(cmp_t cmp, dif_t k) : cmp_(cmp), k_(k) {}
 
-  template <class RAI, class Cmp>
-  friend void intro_sort(RAI a0, RAI aN, Cmp cmp);
+  template <class RAI, class Cmp, class Part>
+  friend void intro_sort(RAI a0, RAI aN, Cmp cmp, Part);
+  template <class RAI, class Cmp> friend class ParallelIntroSort;
+  template <class RAI, class Cmp> friend class IntroSelect;
+  template <class RAI> friend class StringSort;
+
+  using network_t = SortingNetwork<val_t, cmp_t>;
+
+  /**
+   * @brief 要素数k未満の部分配列をソーティングネットワークで整列するかどうか
+   * @note  連続したメモリ上の算術型をstd::less/std::greaterで整列するときに使われます.
+   *        このとき分割はすべて正確なので、最後の挿入ソートは要りません
+   */
+  static constexpr bool use_network =
+      network_t::enabled && std::contiguous_iterator<iter_t>;
+
+  static constexpr dif_t block_size = 64; /**< ブロック分割のブロックの大きさ */
+  static constexpr dif_t ninther_threshold =
+      128; /**< これより大きな部分配列ではピボットを9要素から選びます */
 
   static void sort(const iter_t a0, const iter_t aN, cmp_t cmp) {
-    intro_sort__(a0, aN, cmp);           // 最初はイントロソート
-    final_insertion_sort__(a0, aN, cmp); // 最後に挿入ソート
+    intro_sort__(a0, aN, cmp); // 最初はイントロソート
+    if constexpr (!use_network) {
+      final_insertion_sort__(a0, aN, cmp); // 最後に挿入ソート
+    }
   }
 
   cmp_t cmp_; /**< 比較述語 */
   const dif_t
       k_; /**< 部分配列の要素数がk以下のとき、挿入ソートに切り替わります */
 
-  /**
-   * @brief  符号なし整数vの先頭から続くゼロの数を数える
-   * @note   IEEE 754形式をサポートしているアーキテクチャにのみ対応
-   * @note   エンディアンはリトル、ビッグどちらにも対応
-   * @param  std::uint32_t v 符号なし整数v
-   * @return vのゼロの数
-   */
-  static constexpr std::int32_t nlz(std::uint32_t v) {
-    union {
-      std::uint64_t asu64;
-      double asf64;
-    } u; // 無名共用体を準備
-    u.asf64 =
-        (double)v + 0.5; // 0は例外表現なので0.5(1.0 * 2^(-1))を加算しておく
-    return 1054 -
-           (u.asu64 >> 52); // 1054(ゲタ(bias)の数+32-1) - vの指数部を返す
-  }
-
   /**
    * @brief  3要素x, y, zの中央値(median-of-3)を取得する
    * @tparam T              要素
@@ -113,6 +141,9 @@ private:
    */
   static void final_insertion_sort__(const iter_t a0, const iter_t aN,
                                      cmp_t cmp) {
+    if (a0 == aN) {
+      return;
+    } // 空の配列はソート済みです
     iter_t j = a0;
     // for文の各繰り返しが開始されるときには、部分配列A[0..j-1]には
     // 開始時点でA[0..j-1]に格納されていた要素がソートされた状態で格納されている
@@ -136,6 +167,21 @@ private:
     // 全体配列であることに注意すると、配列全体がソート済みであると結論できる
   }
 
+  /**
+   * @brief 要素数k未満の部分配列を整列する
+   * @note  ソーティングネットワークが使えるときだけ整列し、それ以外は最後の挿入ソートに任せます
+   * @param iter_t a0 先頭イテレータ
+   * @param dif_t  d  要素数
+   */
+  static void small_sort__([[maybe_unused]] const iter_t a0,
+                           [[maybe_unused]] dif_t d) {
+    if constexpr (use_network) {
+      static_assert(network_t::max_size >= 16,
+                    "sorting network must cover the insertion sort cutoff");
+      network_t::sort(std::to_address(a0), d);
+    }
+  }
+
   /**
    * @brief  ヒープソートを行います
    * @note   イントロソートから呼び出されます
@@ -182,8 +228,10 @@ private:
    */
   static void intro_sort__(const iter_t a0, const iter_t aN, cmp_t cmp) {
     const dif_t n = std::distance(a0, aN);
-    const depth_t limit = (31 - nlz(n))
-                          << 1; // 再帰の深さの限界はfloor(lg(a.length)) * 2
+    const depth_t limit =
+        n < 2 ? 0
+              : bit::log2(static_cast<std::size_t>(n))
+                    << 1; // 再帰の深さの限界はfloor(lg(a.length)) * 2
     const dif_t k = 16;         // ここは適当
     IntroSort intro(cmp, k);
     intro.sort__(a0, aN, limit);
@@ -195,10 +243,17 @@ private:
    * @param iter_t  aN     末尾の次を指すイテレータ
    * @param depth_t limit  再帰の深さ制限
    */
-  void sort__(const iter_t a0, const iter_t aN, depth_t limit) {
+  void sort__(const iter_t a0, const iter_t aN, depth_t limit,
+              const val_t *prev = nullptr) {
+    if constexpr (std::is_same_v<partition_t, block_partition>) {
+      block_sort__(a0, aN, limit, true);
+      return;
+    }
+
     // 要素数がk以下の部分配列上でイントロソートが呼ばれたときには、その配列をソートせず、そのまま返る
     const dif_t d = std::distance(a0, aN);
     if (d < k_) {
+      small_sort__(a0, d);
       return;
     }
 
@@ -207,16 +262,28 @@ private:
       heap_sort__(a0, d);
       return;
     }
+    limit = limit - 1;
 
-    // 分割: ピボット値を2つの分割のどちらかに置く
     const dif_t r = d - 1;
-    iter_t aR = std::prev(aN);
-    iter_t aP = partition__(a0, aR, r);
+    const val_t pivot =
+        median_of_3(a0[0], a0[r >> 1], a0[r], cmp_); // 3要素中央値を取得
+
+    // ピボットが親の分割のピボットと等しいとき、重複の多い部分配列とみなして3分割し、
+    // ピボットと等しい要素を再帰の対象から外す
+    if (prev != nullptr && equal__(*prev, pivot)) {
+      const pair_t p = partition3__(a0, aN, pivot);
+      sort__(a0, p.first, limit, &pivot);
+      sort__(p.second, aN, limit, &pivot);
+      return;
+    }
+
+    // 分割: [a0, aP]にピボット以下、(aP, aN)にピボット以上の要素を集める
+    const iter_t aP =
+        std::next(hoare_partition__(a0, std::prev(aN), pivot));
 
     // 統治: 2つの部分配列をイントロソートを再帰的に呼び出すことでソートする
-    limit = limit - 1;
-    sort__(a0, aP, limit);
-    sort__(++aP, aN, limit);
+    sort__(a0, aP, limit, &pivot);
+    sort__(aP, aN, limit, &pivot);
   }
 
   /**
@@ -229,7 +296,18 @@ private:
     const iter_t &A = first;
     const val_t pivot =
         median_of_3(A[0], A[d >> 1], A[d], cmp_); // 3要素中央値を取得
+    return hoare_partition__(first, last, pivot);
+  }
 
+  /**
+   * @brief 部分配列Aをピボットpivotで再配置する
+   * @note  pivotは部分配列Aの要素の3要素中央値でなければなりません
+   * @param const iter_t first 先頭イテレータ
+   * @param const iter_t last  末尾イテレータ
+   * @param const val_t& pivot ピボット
+   */
+  iter_t hoare_partition__(const iter_t first, const iter_t last,
+                           const val_t &pivot) {
     iter_t i = first, j = last;
     while (true) { // 以下、反復子iとjは部分配列Aの外側を参照しない
       while (cmp_(*i, pivot)) {
@@ -246,6 +324,292 @@ private:
       --j; // i < j のとき、iとjの値を交換する
     }
   }
+
+  /**< @brief 比較述語のもとでxとyが等しいかどうか */
+  bool equal__(const val_t &x, const val_t &y) {
+    return !cmp_(x, y) && !cmp_(y, x);
+  }
+
+  /**
+   * @brief 部分配列[a0, aN)をピボットpivotで3分割する(Dijkstraのオランダ国旗問題)
+   * @param iter_t       a0    先頭イテレータ
+   * @param iter_t       aN    末尾の次を指すイテレータ
+   * @param const val_t& pivot ピボット(部分配列の外にある値)
+   * @return [a0, lt)がピボット未満、[lt, gt)がピボットと等しく、[gt, aN)がピボットより大きくなる(lt, gt)
+   */
+  pair_t partition3__(const iter_t a0, const iter_t aN, const val_t &pivot) {
+    iter_t lt = a0, i = a0, gt = aN;
+    // [a0, lt) < pivot, [lt, i) == pivot, [i, gt)は未確認, [gt, aN) > pivot
+    while (i < gt) {
+      if (cmp_(*i, pivot)) {
+        std::iter_swap(lt++, i++);
+      } else if (cmp_(pivot, *i)) {
+        std::iter_swap(i, --gt);
+      } else {
+        ++i;
+      }
+    }
+    return pair_t(lt, gt);
+  }
+
+  /**
+   * @brief 要素*a, *bを比較述語の順に並べる
+   */
+  void sort2__(iter_t a, iter_t b) {
+    if (cmp_(*b, *a)) {
+      std::iter_swap(a, b);
+    }
+  }
+
+  /**
+   * @brief 要素*a, *b, *cを比較述語の順に並べる
+   */
+  void sort3__(iter_t a, iter_t b, iter_t c) {
+    sort2__(a, b);
+    sort2__(b, c);
+    sort2__(a, b);
+  }
+
+  /**
+   * @brief 部分的な挿入ソートを行います
+   * @note  要素の移動が8回を超えたら諦めてfalseを返します
+   * @param iter_t a0 先頭イテレータ
+   * @param iter_t aN 末尾の次を指すイテレータ
+   * @return 部分配列が整列できたかどうか
+   */
+  bool partial_insertion_sort__(const iter_t a0, const iter_t aN) {
+    if (a0 == aN) {
+      return true;
+    }
+    dif_t moved = 0;
+    for (iter_t j = std::next(a0); j != aN; ++j) {
+      iter_t k = j, i = std::prev(j);
+      if (cmp_(*k, *i)) {
+        val_t key = std::move(*k);
+        do {
+          *k-- = std::move(*i);
+        } while (k != a0 && cmp_(key, *--i));
+        *k = std::move(key);
+        moved += std::distance(k, j);
+      }
+      if (moved > 8) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief ブロック分割を行います
+   * @note  *a0をピボットとし、[a0, aP)にピボット未満の要素、(aP, aN)にピボット以上の要素を
+   *        集めてaPにピボットを置きます. 右端の要素はピボット以上でなければなりません
+   * @param iter_t a0          先頭イテレータ
+   * @param iter_t aN          末尾の次を指すイテレータ
+   * @param bool&  partitioned 交換なしで分割済みだったかどうか
+   * @return ピボットの位置aP
+   */
+  iter_t block_partition__(const iter_t a0, const iter_t aN,
+                           bool &partitioned) {
+    val_t pivot = std::move(*a0);
+    iter_t first = a0, last = aN;
+    // 左右から、反対側に移すべき最初の要素を探す
+    while (cmp_(*++first, pivot)) {
+    }
+    if (std::prev(first) == a0) {
+      while (first < last && !cmp_(*--last, pivot)) {
+      }
+    } else {
+      while (!cmp_(*--last, pivot)) { // 左側の要素が番兵になる
+      }
+    }
+    partitioned = first >= last;
+
+    if (!partitioned) {
+      std::iter_swap(first, last);
+      ++first;
+
+      // 反対側に移すべき要素のブロック内での位置(右側は末尾からの距離)
+      unsigned char offsets_l[block_size], offsets_r[block_size];
+      iter_t base_l = first, base_r = last;
+      dif_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+      while (first < last) {
+        // 記録が空の側だけ、残りの要素から次のブロックを取る
+        const dif_t unknown = std::distance(first, last);
+        const dif_t split_l =
+            num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+        const dif_t split_r = num_r == 0 ? unknown - split_l : 0;
+
+        // 比較結果を分岐なしで記録に足し込む
+        for (dif_t i = 0, n = std::min(split_l, block_size); i < n; i++) {
+          offsets_l[num_l] = static_cast<unsigned char>(i);
+          num_l += !cmp_(*first, pivot);
+          ++first;
+        }
+        for (dif_t i = 0, n = std::min(split_r, block_size); i < n;) {
+          offsets_r[num_r] = static_cast<unsigned char>(++i);
+          num_r += cmp_(*--last, pivot);
+        }
+
+        // 左右で記録された要素を組にして入れ替える
+        const dif_t num = std::min(num_l, num_r);
+        swap_offsets__(base_l, base_r, offsets_l + start_l,
+                       offsets_r + start_r, num, num_l == num_r);
+        num_l -= num;
+        num_r -= num;
+        start_l += num;
+        start_r += num;
+        if (num_l == 0) {
+          start_l = 0;
+          base_l = first;
+        }
+        if (num_r == 0) {
+          start_r = 0;
+          base_r = last;
+        }
+      }
+
+      // 片側に残った要素を境界の反対側へ送る
+      if (num_l != 0) {
+        while (num_l--) {
+          std::iter_swap(base_l + offsets_l[start_l + num_l], --last);
+        }
+        first = last;
+      }
+      if (num_r != 0) {
+        while (num_r--) {
+          std::iter_swap(base_r - offsets_r[start_r + num_r], first);
+          ++first;
+        }
+      }
+    }
+
+    // ピボットを正しい位置に置く
+    const iter_t aP = std::prev(first);
+    *a0 = std::move(*aP);
+    *aP = std::move(pivot);
+    return aP;
+  }
+
+  /**
+   * @brief 記録された位置の要素を左右で入れ替える
+   * @note  交換の代わりに巡回的な移動で済ませます. 左右の数が等しいときは逆順の入力で
+   *        O(n)を保つため、通常の交換を使います
+   */
+  static void swap_offsets__(const iter_t base_l, const iter_t base_r,
+                             const unsigned char *offsets_l,
+                             const unsigned char *offsets_r, dif_t num,
+                             bool use_swaps) {
+    if (use_swaps) {
+      for (dif_t i = 0; i < num; i++) {
+        std::iter_swap(base_l + offsets_l[i], base_r - offsets_r[i]);
+      }
+    } else if (num > 0) {
+      iter_t l = base_l + offsets_l[0], r = base_r - offsets_r[0];
+      val_t tmp = std::move(*l);
+      *l = std::move(*r);
+      for (dif_t i = 1; i < num; i++) {
+        l = base_l + offsets_l[i];
+        *r = std::move(*l);
+        r = base_r - offsets_r[i];
+        *l = std::move(*r);
+      }
+      *r = std::move(tmp);
+    }
+  }
+
+  /**
+   * @brief ピボットを選んで先頭に置く
+   * @note  要素数がninther_thresholdを超えるときは9要素の擬似中央値(ninther)を、
+   *        それ以外は3要素中央値を使います. いずれも右側にピボット以上の要素が残ります
+   */
+  void choose_pivot__(const iter_t a0, const iter_t aN) {
+    const dif_t d = std::distance(a0, aN), h = d / 2;
+    const iter_t aR = std::prev(aN);
+    if (d > ninther_threshold) {
+      sort3__(a0, a0 + h, aR);
+      sort3__(a0 + 1, a0 + (h - 1), aR - 1);
+      sort3__(a0 + 2, a0 + (h + 1), aR - 2);
+      sort3__(a0 + (h - 1), a0 + h, a0 + (h + 1));
+      std::iter_swap(a0, a0 + h);
+    } else {
+      sort3__(a0 + h, a0, aR);
+    }
+  }
+
+  /**
+   * @brief ブロック分割によるイントロソート
+   * @note  小さい側を再帰的に、大きい側をループで処理します.
+   *        ヒープソートに切り替わるのは偏った分割がlimit回起きたときです
+   * @note  直前の要素(親の分割のピボット)が選んだピボットと等しいときは、ピボットと等しい要素を
+   *        3分割で取り除いてから残りを処理します
+   * @param iter_t  a0       先頭イテレータ
+   * @param iter_t  aN       末尾の次を指すイテレータ
+   * @param depth_t limit    偏った分割の許容回数
+   * @param bool    leftmost a0が配列全体の先頭かどうか
+   */
+  void block_sort__(iter_t a0, iter_t aN, depth_t limit, bool leftmost) {
+    while (true) {
+      const dif_t d = std::distance(a0, aN);
+      if (d < k_) {
+        small_sort__(a0, d); // 残りは最後の挿入ソートに任せる
+        return;
+      }
+
+      choose_pivot__(a0, aN);
+
+      // 分割は正確なので、a0の直前の要素は[a0, aN)のどの要素以下でもある.
+      // それがピボット以上なら、ピボットは最小値であり直前の要素と等しい
+      if (!leftmost && !cmp_(*std::prev(a0), *a0)) {
+        const val_t pivot = *a0;
+        a0 = partition3__(a0, aN, pivot).second;
+        continue;
+      }
+      bool partitioned = false;
+      const iter_t aP = block_partition__(a0, aN, partitioned);
+      const dif_t l = std::distance(a0, aP), r = std::distance(aP, aN) - 1;
+
+      if (l < d / 8 || r < d / 8) { // 偏った分割
+        if (limit < 1) {
+          heap_sort__(a0, d);
+          return;
+        }
+        limit = limit - 1;
+        // 要素を入れ替えて入力のパターンを崩す
+        if (l >= k_) {
+          std::iter_swap(a0, a0 + l / 4);
+          std::iter_swap(aP - 1, aP - l / 4);
+          if (l > ninther_threshold) {
+            std::iter_swap(a0 + 1, a0 + (l / 4 + 1));
+            std::iter_swap(a0 + 2, a0 + (l / 4 + 2));
+            std::iter_swap(aP - 2, aP - (l / 4 + 1));
+            std::iter_swap(aP - 3, aP - (l / 4 + 2));
+          }
+        }
+        if (r >= k_) {
+          std::iter_swap(aP + 1, aP + (1 + r / 4));
+          std::iter_swap(aN - 1, aN - r / 4);
+          if (r > ninther_threshold) {
+            std::iter_swap(aP + 2, aP + (2 + r / 4));
+            std::iter_swap(aP + 3, aP + (3 + r / 4));
+            std::iter_swap(aN - 2, aN - (1 + r / 4));
+            std::iter_swap(aN - 3, aN - (2 + r / 4));
+          }
+        }
+      } else if (partitioned && partial_insertion_sort__(a0, aP) &&
+                 partial_insertion_sort__(std::next(aP), aN)) {
+        return; // 交換なしで分割でき、両側とも整列済みだった
+      }
+
+      if (l < r) {
+        block_sort__(a0, aP, limit, leftmost);
+        a0 = std::next(aP);
+        leftmost = false;
+      } else {
+        block_sort__(std::next(aP), aN, limit, false);
+        aN = aP;
+      }
+    }
+  }
 };
 
 //********************************************************************************
@@ -263,7 +627,23 @@ private:
 template <class RandomAccessIterator, class Compare>
 inline void intro_sort(RandomAccessIterator a0, RandomAccessIterator aN,
                        Compare cmp) {
-  IntroSort<RandomAccessIterator, Compare>::sort(a0, aN, cmp);
+  intro_sort(a0, aN, cmp, hoare_partition());
+}
+
+/**
+ * @brief  分割方法を指定してイントロソートを行います
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @tparam Partition                  分割方法(hoare_partition または block_partition)
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ * @param  Partition                  分割方法のタグ
+ */
+template <class RandomAccessIterator, class Compare, class Partition>
+inline void intro_sort(RandomAccessIterator a0, RandomAccessIterator aN,
+                       Compare cmp, Partition) {
+  IntroSort<RandomAccessIterator, Compare, Partition>::sort(a0, aN, cmp);
 }
 
 /**
@@ -0,0 +1,517 @@
+/**
+ * @brief 敗者木(loser tree)によるk-wayマージの実装
+ * @note  k本の整列済みの列の先頭をトーナメントで比べ、節点には試合の敗者を、根には勝者を持ちます。
+ *        勝者を取り出したときは、その葉から根への1経路だけを再試合するので、
+ *        1要素あたりの比較はceil(lg k)回で、要素毎の確保もありません。
+ * @note  要素が32ビット整数で比較述語がstd::lessのとき、k <= 8なら全ての先頭の最小値を
+ *        分岐なしで求めます。AVX2は起動後にcpu::dispatcherで検出して使います。
+ * @note  等しい要素は番号の小さい列から先に出力します(安定)。
+ * @note  型の異なる列(std::vectorとstd::dequeなど)は、std::tieなどでstd::tupleにまとめて
+ *        k_way_merge(std::tie(ranges...), out, cmp)のように渡します。列の型が揃っていれば
+ *        列の配列と同じ処理になり、揃っていなければstd::variantで列を切り替えます。
+ * @note  Reference: D. E. Knuth, "The Art of Computer Programming Vol. 3",
+ * 5.4.1 Multiway Merging and Replacement Selection.
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef K_WAY_MERGE_HPP
+#define K_WAY_MERGE_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "bit/bit.hpp"
+#include "cpu/cpu_features.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+#define K_WAY_MERGE_SIMD 1
+#include <immintrin.h>
+#endif
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  敗者木クラス
+ * @tparam Source  列の型(empty(), front(), pop()を持つ)
+ * @tparam Compare 比較述語
+ */
+template <class Source, class Compare> class LoserTree {
+public:
+  /**
+   * @brief コンストラクタ
+   * @param std::vector<Source> sources 整列済みの列
+   * @param Compare             cmp     比較述語
+   */
+  LoserTree(std::vector<Source> sources, Compare cmp)
+      : sources_(std::move(sources)), cmp_(cmp), tree_(sources_.size()) {
+    if (!sources_.empty()) {
+      tree_[0] = build__(1);
+    }
+  }
+
+  /**< @brief 全ての列を出力し終えたかどうか */
+  bool empty() const noexcept {
+    return sources_.empty() || sources_[tree_[0]].empty();
+  }
+
+  /**< @brief 最小の要素 */
+  decltype(auto) top() const { return sources_[tree_[0]].front(); }
+
+  /**< @brief 最小の要素を持つ列の番号 */
+  std::size_t winner() const noexcept { return tree_[0]; }
+
+  /**< @brief 最小の要素を取り除き、その列の葉から根までを再試合する */
+  void pop() {
+    std::size_t w = tree_[0];
+    sources_[w].pop();
+    for (std::size_t node = (w + sources_.size()) >> 1; node > 0;
+         node >>= 1) {
+      if (less__(tree_[node], w)) {
+        std::swap(tree_[node], w);
+      }
+    }
+    tree_[0] = w;
+  }
+
+private:
+  std::vector<Source> sources_;   /**< 列 */
+  Compare cmp_;                   /**< 比較述語 */
+  std::vector<std::size_t> tree_; /**< 節点毎の敗者(tree_[0]は勝者) */
+
+  /**
+   * @brief 列iの先頭が列jの先頭より先に出るかどうか
+   * @note  出力し終えた列は最後に回し、等しいときは番号の小さい列を先にします
+   */
+  bool less__(std::size_t i, std::size_t j) const {
+    const Source &x = sources_[i], &y = sources_[j];
+    if (x.empty() || y.empty()) {
+      return y.empty() && (!x.empty() || i < j);
+    }
+    if (cmp_(x.front(), y.front())) {
+      return true;
+    }
+    return !cmp_(y.front(), x.front()) && i < j;
+  }
+
+  /**
+   * @brief 節点nodeの部分木で試合を行い、敗者を記録して勝者を返す
+   * @note  節点1..k-1が内部節点、k..2k-1が葉(列0..k-1)の完全二分木です
+   */
+  std::size_t build__(std::size_t node) {
+    const std::size_t k = sources_.size();
+    if (node >= k) {
+      return node - k;
+    }
+    const std::size_t l = build__(node << 1), r = build__((node << 1) + 1);
+    const bool left = less__(l, r);
+    tree_[node] = left ? r : l;
+    return left ? l : r;
+  }
+};
+
+/**
+ * @brief  イテレータの組[first, last)を列として扱うクラス
+ * @tparam Iterator イテレータ
+ */
+template <class Iterator> struct range_source {
+  Iterator first, last;
+  bool empty() const { return first == last; }
+  decltype(auto) front() const { return *first; }
+  void pop() { ++first; }
+};
+
+/**
+ * @brief  型の異なるイテレータの組を1つの列の型として扱うクラス
+ * @note   front()は全てのイテレータの参照型に共通する参照型を返します
+ * @tparam Iterators 列毎のイテレータ(重複してもよい)
+ */
+template <class... Iterators> class variant_source {
+public:
+  using reference =
+      std::common_reference_t<std::iter_reference_t<Iterators>...>;
+
+  /**
+   * @brief コンストラクタ
+   * @param std::in_place_index_t<I> i     列の番号(Iterators中の位置)
+   * @param It                       first 先頭イテレータ
+   * @param It                       last  末尾の次を指すイテレータ
+   */
+  template <std::size_t I, class It>
+  variant_source(std::in_place_index_t<I> i, It first, It last)
+      : s_(i, range_source<It>{first, last}) {}
+
+  bool empty() const {
+    return std::visit([](const auto &s) { return s.empty(); }, s_);
+  }
+  reference front() const {
+    return std::visit([](const auto &s) -> reference { return s.front(); },
+                      s_);
+  }
+  void pop() {
+    std::visit([](auto &s) { s.pop(); }, s_);
+  }
+
+private:
+  std::variant<range_source<Iterators>...> s_; /**< 列 */
+};
+
+/**
+ * @brief  k本の整列済みの列を遅延評価でマージするクラス
+ * @note   begin()から要素を1つずつ取り出す度に、敗者木を1経路だけ再試合します
+ * @tparam Iterator 列のイテレータ
+ * @tparam Compare  比較述語
+ */
+template <class Iterator, class Compare> class KWayMerge {
+private:
+  using tree_t = LoserTree<range_source<Iterator>, Compare>;
+
+public:
+  using value_type = typename std::iterator_traits<Iterator>::value_type;
+
+  /**< @brief マージした結果を順に指す入力イテレータ */
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = typename KWayMerge::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    iterator() = default;
+    explicit iterator(tree_t *tree) : tree_(tree) {}
+
+    reference operator*() const { return tree_->top(); }
+    pointer operator->() const { return &tree_->top(); }
+    iterator &operator++() {
+      tree_->pop();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    /**< @brief 全ての列を出力し終えたかどうか */
+    friend bool operator==(const iterator &it, std::default_sentinel_t) {
+      return it.tree_->empty();
+    }
+
+  private:
+    tree_t *tree_ = nullptr;
+  };
+
+  /**
+   * @brief コンストラクタ
+   * @param std::vector<std::pair<Iterator, Iterator>> ranges 整列済みの列
+   * @param Compare cmp 比較述語
+   */
+  KWayMerge(const std::vector<std::pair<Iterator, Iterator>> &ranges,
+            Compare cmp)
+      : tree_(sources__(ranges), cmp) {}
+
+  iterator begin() { return iterator(&tree_); }
+  std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+  tree_t tree_; /**< 敗者木 */
+
+  static std::vector<range_source<Iterator>>
+  sources__(const std::vector<std::pair<Iterator, Iterator>> &ranges) {
+    std::vector<range_source<Iterator>> s;
+    s.reserve(ranges.size());
+    for (const auto &r : ranges) {
+      s.push_back({r.first, r.second});
+    }
+    return s;
+  }
+};
+
+/**
+ * @brief  32ビット整数の列をAVX2でマージするクラス
+ * @note   8本までの列の先頭を1レジスタに並べ、水平方向の最小値と一致する最初のレーンを
+ *         選ぶので、分岐予測の外れる比較がありません
+ * @note   AVX2が無いCPUでは、同じ順に先頭を1つずつ比べる実装を使います
+ * @tparam T 要素の型(std::int32_tまたはstd::uint32_t)
+ */
+template <class T> class SimdMerge {
+public:
+  /**< @brief この型と比較述語で使えるかどうか */
+  template <class Compare>
+  static constexpr bool enabled =
+      (std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t>) &&
+      (std::is_same_v<Compare, std::less<T>> ||
+       std::is_same_v<Compare, std::less<>>);
+
+  /**< @brief 一度にマージできる最大の列数 */
+  static constexpr std::size_t max_ways = 8;
+
+  /**
+   * @brief 列[first[i], last[i])(i < k)をマージしてoutへ書き出す
+   * @return 書き出した末尾の次
+   */
+  template <class OutputIterator>
+  static OutputIterator merge(const T *const *first, const T *const *last,
+                              std::size_t k, OutputIterator out) {
+    static const cpu::dispatcher<std::size_t(state &, T *, std::size_t)> f = {
+#if defined(K_WAY_MERGE_SIMD)
+        {cpu::avx2, merge_avx2__},
+#endif
+        {cpu::none, merge_scalar__}};
+    state s;
+    s.alive = 0;
+    for (std::size_t i = 0; i < max_ways; i++) {
+      s.head[i] = std::numeric_limits<T>::max();
+      s.cur[i] = s.end[i] = nullptr;
+      if (i < k && first[i] != last[i]) {
+        s.cur[i] = first[i];
+        s.end[i] = last[i];
+        s.head[i] = *s.cur[i];
+        s.alive |= 1u << i;
+      }
+    }
+    if constexpr (std::is_same_v<OutputIterator, T *>) {
+      std::size_t n = 0;
+      for (std::size_t i = 0; i < k; i++) {
+        n += static_cast<std::size_t>(last[i] - first[i]);
+      }
+      return out + f(s, out, n);
+    } else {
+      T buf[512]; // 任意の出力イテレータへは一旦バッファに書いてから写す
+      for (std::size_t n; (n = f(s, buf, std::size(buf))) != 0;) {
+        out = std::copy(buf, buf + n, out);
+      }
+      return out;
+    }
+  }
+
+private:
+  /**< @brief マージの途中の状態 */
+  struct state {
+    alignas(32) T head[max_ways]; /**< @note 各列の先頭(尽きた列は最大値) */
+    const T *cur[max_ways];       /**< @note 各列の現在位置 */
+    const T *end[max_ways];       /**< @note 各列の末尾 */
+    std::uint32_t alive;          /**< @note 残っている列のビット集合 */
+  };
+
+  /**< @brief 先頭iを出力して列iを1つ進める */
+  static void pop__(state &s, int i) {
+    if (++s.cur[i] != s.end[i]) {
+      s.head[i] = *s.cur[i];
+    } else {
+      s.head[i] = std::numeric_limits<T>::max();
+      s.alive &= ~(1u << i);
+    }
+  }
+
+  /**< @brief 最大n個をoutへ書き出し、書き出した数を返す(先頭を順に比べる版) */
+  static std::size_t merge_scalar__(state &s, T *out, std::size_t n) {
+    std::size_t j = 0;
+    for (; j < n && s.alive != 0; j++) {
+      int i = bit::ntz(s.alive);
+      for (std::uint32_t a = s.alive & (s.alive - 1); a != 0; a &= a - 1) {
+        const int t = bit::ntz(a);
+        if (s.head[t] < s.head[i]) {
+          i = t;
+        }
+      }
+      out[j] = s.head[i];
+      pop__(s, i);
+    }
+    return j;
+  }
+
+#if defined(K_WAY_MERGE_SIMD)
+  CPU_TARGET("avx2")
+  static __m256i min__(__m256i x, __m256i y) {
+    if constexpr (std::is_signed_v<T>) {
+      return _mm256_min_epi32(x, y);
+    } else {
+      return _mm256_min_epu32(x, y);
+    }
+  }
+
+  /**< @brief 最大n個をoutへ書き出し、書き出した数を返す(AVX2版) */
+  CPU_TARGET("avx2")
+  static std::size_t merge_avx2__(state &s, T *out, std::size_t n) {
+    std::size_t j = 0;
+    for (; j < n && s.alive != 0; j++) {
+      const __m256i v =
+          _mm256_load_si256(reinterpret_cast<const __m256i *>(s.head));
+      __m256i m = min__(v, _mm256_permute2x128_si256(v, v, 0x01));
+      m = min__(m, _mm256_shuffle_epi32(m, 0x4E));
+      m = min__(m, _mm256_shuffle_epi32(m, 0xB1)); // 全てのレーンが最小値になる
+      // 最小値と等しく、まだ残っている最初の列を選ぶ
+      const std::uint32_t eq =
+          static_cast<std::uint32_t>(_mm256_movemask_ps(
+              _mm256_castsi256_ps(_mm256_cmpeq_epi32(v, m)))) &
+          s.alive;
+      const int i = bit::ntz(eq);
+      out[j] = s.head[i];
+      pop__(s, i);
+    }
+    return j;
+  }
+#endif
+};
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  k本の整列済みの列を遅延評価でマージするオブジェクトを作ります
+ * @note   返り値は範囲for文で回せます。元の列は返り値より長く生存しなければなりません
+ * @tparam Ranges        列の配列(各要素はstd::begin, std::endで回せる整列済みの列)
+ * @tparam Compare       比較述語
+ * @param  const Ranges& ranges 列の配列
+ * @param  Compare       cmp    比較述語
+ * @return KWayMerge
+ */
+template <class Ranges, class Compare>
+inline auto make_k_way_merge(const Ranges &ranges, Compare cmp) {
+  using iter_t = decltype(std::begin(*std::begin(ranges)));
+  std::vector<std::pair<iter_t, iter_t>> r;
+  for (const auto &x : ranges) {
+    r.emplace_back(std::begin(x), std::end(x));
+  }
+  return KWayMerge<iter_t, Compare>(r, cmp);
+}
+
+/**
+ * @brief  k本の整列済みの列を遅延評価でマージするオブジェクトを作ります(比較述語を省略した場合、こちらが呼ばれます)
+ * @tparam Ranges        列の配列
+ * @param  const Ranges& ranges 列の配列
+ * @return KWayMerge
+ */
+template <class Ranges> inline auto make_k_way_merge(const Ranges &ranges) {
+  using iter_t = decltype(std::begin(*std::begin(ranges)));
+  using val_t = typename std::iterator_traits<iter_t>::value_type;
+  return make_k_way_merge(ranges, std::less<val_t>());
+}
+
+/**
+ * @brief  k本の整列済みの列をマージしてoutへ書き出します
+ * @tparam Ranges         列の配列(各要素はstd::begin, std::endで回せる整列済みの列)
+ * @tparam OutputIterator 出力イテレータ
+ * @tparam Compare        比較述語
+ * @param  const Ranges&  ranges 列の配列
+ * @param  OutputIterator out    出力先
+ * @param  Compare        cmp    比較述語
+ * @return 書き出した末尾の次
+ */
+template <class Ranges, class OutputIterator, class Compare>
+inline OutputIterator k_way_merge(const Ranges &ranges, OutputIterator out,
+                                  Compare cmp) {
+  using iter_t = decltype(std::begin(*std::begin(ranges)));
+  using val_t = typename std::iterator_traits<iter_t>::value_type;
+  using simd_t = SimdMerge<val_t>;
+  if constexpr (simd_t::template enabled<Compare> &&
+                std::contiguous_iterator<iter_t>) {
+    const std::size_t k =
+        static_cast<std::size_t>(std::distance(std::begin(ranges),
+                                               std::end(ranges)));
+    if (k <= simd_t::max_ways) {
+      const val_t *first[simd_t::max_ways], *last[simd_t::max_ways];
+      std::size_t i = 0;
+      for (const auto &x : ranges) {
+        first[i] = std::to_address(std::begin(x));
+        last[i++] = std::to_address(std::end(x));
+      }
+      return simd_t::merge(first, last, k, out);
+    }
+  }
+  for (auto &&x : make_k_way_merge(ranges, cmp)) {
+    *out++ = x;
+  }
+  return out;
+}
+
+/**
+ * @brief  k本の整列済みの列をマージしてoutへ書き出します(比較述語を省略した場合、こちらが呼ばれます)
+ * @tparam Ranges         列の配列
+ * @tparam OutputIterator 出力イテレータ
+ * @param  const Ranges&  ranges 列の配列
+ * @param  OutputIterator out    出力先
+ * @return 書き出した末尾の次
+ */
+template <class Ranges, class OutputIterator>
+inline OutputIterator k_way_merge(const Ranges &ranges, OutputIterator out) {
+  using iter_t = decltype(std::begin(*std::begin(ranges)));
+  using val_t = typename std::iterator_traits<iter_t>::value_type;
+  return k_way_merge(ranges, out, std::less<val_t>());
+}
+
+/**
+ * @brief  型の異なるk本の整列済みの列をマージしてoutへ書き出します
+ * @note   列はstd::tie(a, b, ...)のようにstd::tupleにまとめて渡します.
+ *         列のイテレータの型が全て等しいときは列の配列を渡したときと同じ処理(SIMD版を含む)になります
+ * @tparam Ranges         列の型(それぞれstd::begin, std::endで回せる整列済みの列)
+ * @tparam OutputIterator 出力イテレータ
+ * @tparam Compare        比較述語
+ * @param  const std::tuple<Ranges...>& ranges 列の組
+ * @param  OutputIterator               out    出力先
+ * @param  Compare                      cmp    比較述語
+ * @return 書き出した末尾の次
+ */
+template <class... Ranges, class OutputIterator, class Compare>
+inline OutputIterator k_way_merge(const std::tuple<Ranges...> &ranges,
+                                  OutputIterator out, Compare cmp) {
+  return [&]<std::size_t... I>(std::index_sequence<I...>) {
+    using source_t =
+        variant_source<decltype(std::begin(std::get<I>(ranges)))...>;
+    if constexpr (sizeof...(I) == 0) {
+      return out;
+    } else if constexpr ((std::is_same_v<
+                              decltype(std::begin(std::get<0>(ranges))),
+                              decltype(std::begin(std::get<I>(ranges)))> &&
+                          ...)) {
+      using iter_t = decltype(std::begin(std::get<0>(ranges)));
+      const std::vector<std::ranges::subrange<iter_t>> r = {
+          {std::begin(std::get<I>(ranges)), std::end(std::get<I>(ranges))}...};
+      return k_way_merge(r, out, cmp);
+    } else {
+      std::vector<source_t> s;
+      s.reserve(sizeof...(I));
+      (s.emplace_back(std::in_place_index<I>, std::begin(std::get<I>(ranges)),
+                      std::end(std::get<I>(ranges))),
+       ...);
+      for (LoserTree<source_t, Compare> tree(std::move(s), cmp); !tree.empty();
+           tree.pop()) {
+        *out++ = tree.top();
+      }
+      return out;
+    }
+  }(std::index_sequence_for<Ranges...>());
+}
+
+/**
+ * @brief  型の異なるk本の整列済みの列をマージしてoutへ書き出します(比較述語を省略した場合、こちらが呼ばれます)
+ * @note   要素の型が異なってもよいよう、std::less<>で比べます
+ * @tparam Ranges         列の型
+ * @tparam OutputIterator 出力イテレータ
+ * @param  const std::tuple<Ranges...>& ranges 列の組
+ * @param  OutputIterator               out    出力先
+ * @return 書き出した末尾の次
+ */
+template <class... Ranges, class OutputIterator>
+inline OutputIterator k_way_merge(const std::tuple<Ranges...> &ranges,
+                                  OutputIterator out) {
+  return k_way_merge(ranges, out, std::less<>());
+}
+
+#endif // endif K_WAY_MERGE_HPP
@@ -0,0 +1,387 @@
+/**
+ * @brief 並列イントロソートの実装
+ * @note  大きな部分配列を分割するたびに片側をタスクとしてスレッドプールに投げ、
+ *        閾値以下になった部分配列は各タスクで逐次のイントロソートと挿入ソートを行います。
+ * @note  分割後の2つの部分配列は互いに独立なので、最後の挿入ソートも部分配列毎に完結します。
+ * @note  投げた部分配列はこのソートが持つキューに入れ、プールのスレッドと待っている呼び出し元の
+ *        どちらもそこから取り出して処理します。呼び出し元がプールのスレッドでも
+ *        (1スレッドのプールでも)自分で残りを処理するので、デッドロックしません。
+ * @note  部分配列がn / (2p)より大きい間(pはハードウェアスレッド数)は、分割自体も帯に分けて並列に
+ *        行います。独立した部分配列がスレッド数より少ない上の段でも全スレッドが働くので、
+ *        逐次に分割される部分のスパンはn / (2p) + n / (4p) + ... = O(n / p)に収まります。
+ * @note  Reference: P. Tsigas and Y. Zhang, "A Simple, Fast Parallel
+ * Implementation of Quicksort and its Performance Evaluation on SUN Enterprise
+ * 10000", PDP 2003.
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef PARALLEL_INTRO_SORT_HPP
+#define PARALLEL_INTRO_SORT_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "sort/detail/parallel_for.hpp"
+#include "sort/intro_sort.hpp"
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+//********************************************************************************
+// 関数の宣言
+//********************************************************************************
+
+template <class RandomAccessIterator, class Compare, class Pool>
+void parallel_intro_sort(
+    RandomAccessIterator a0, RandomAccessIterator aN, Compare cmp, Pool &pool,
+    typename std::iterator_traits<RandomAccessIterator>::difference_type
+        cutoff = 1 << 14);
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  並列イントロソートクラス
+ * @tparam RandomAccessIterator (ランダムアクセス)イテレータ
+ * @tparam Compare              比較述語
+ */
+template <class RandomAccessIterator, class Compare>
+class ParallelIntroSort
+    : public std::enable_shared_from_this<
+          ParallelIntroSort<RandomAccessIterator, Compare>> {
+private:
+  using iter_t = RandomAccessIterator;
+  using cmp_t = Compare;
+  using intro_t = IntroSort<iter_t, cmp_t>;
+  using val_t = typename std::iterator_traits<iter_t>::value_type;
+  using dif_t = typename std::iterator_traits<iter_t>::difference_type;
+  using depth_t = std::size_t;
+  using range_t = std::pair<iter_t, iter_t>;
+
+  template <class RAI, class Cmp, class Pool>
+  friend void
+  parallel_intro_sort(RAI a0, RAI aN, Cmp cmp, Pool &pool,
+                      typename std::iterator_traits<RAI>::difference_type);
+
+  ParallelIntroSort(cmp_t cmp, dif_t n, dif_t cutoff)
+      : cmp_(cmp), cutoff_(std::max<dif_t>(cutoff, 1)),
+        stripes_(4 * static_cast<dif_t>(
+                         std::max(1u, std::thread::hardware_concurrency()))),
+        spread_(std::max(4 * cutoff_, n / (stripes_ / 2))), remain_(n) {}
+
+  /**< @brief 要素数nの配列に対する再帰の深さ制限floor(lg(n)) * 2を返す */
+  static constexpr depth_t depth_limit__(dif_t n) {
+    return n < 2 ? 0 : bit::log2(static_cast<std::size_t>(n)) << 1;
+  }
+
+  cmp_t cmp_; /**< 比較述語 */
+  const dif_t
+      cutoff_; /**< 部分配列の要素数がcutoff以下のとき、逐次処理に切り替わります */
+  const dif_t stripes_; /**< 並列な分割で部分配列を分ける帯の数の上限 */
+  const dif_t
+      spread_; /**< 部分配列の要素数がspreadより大きいとき、分割を並列に行います */
+  dif_t remain_;         /**< まだ整列が終わっていない要素数 */
+  std::exception_ptr e_; /**< タスク内で最初に送出された例外 */
+  std::deque<std::tuple<iter_t, iter_t, depth_t>>
+      queue_; /**< まだ誰も処理していない部分配列 */
+  std::mutex m_;
+  std::condition_variable cv_;
+
+  /**
+   * @brief 部分配列[a0, aN)をソートするタスク
+   * @note  閾値を超える間は分割して片側をプールに投げ、もう片側を自分で続けて処理します
+   * @param Pool&   pool  スレッドプール
+   * @param iter_t  a0    先頭イテレータ
+   * @param iter_t  aN    末尾の次を指すイテレータ
+   * @param depth_t limit 再帰の深さ制限
+   */
+  template <class Pool>
+  void task__(Pool &pool, iter_t a0, iter_t aN, depth_t limit) {
+    try {
+      intro_t intro(cmp_, 16);
+      while (std::distance(a0, aN) > cutoff_ && limit > 0) {
+        // 分割: [a0, aP)の要素はピボット以下、[aP, aN)の要素はピボット以上となる
+        const dif_t d = std::distance(a0, aN);
+        bool equal = false;
+        const iter_t aP =
+            d > spread_
+                ? parallel_partition__(pool, a0, aN, equal)
+                : std::next(intro.partition__(a0, std::prev(aN), d - 1));
+        limit = limit - 1;
+        if (equal) {
+          // [a0, aP)はすべてピボットと等しいので、整列済みとして数える
+          done__(std::distance(a0, aP), nullptr);
+          a0 = aP;
+          continue;
+        }
+        // 大きい側をタスクとして投げ、小さい側を続けて処理する
+        const bool left = std::distance(a0, aP) >= std::distance(aP, aN);
+        const iter_t b0 = left ? a0 : aP, bN = left ? aP : aN;
+        spawn__(pool, b0, bN, limit);
+        (left ? a0 : aN) = aP;
+      }
+      // 逐次処理: 部分配列毎にイントロソートと挿入ソートを行う
+      intro.sort__(a0, aN, limit);
+      intro_t::final_insertion_sort__(a0, aN, cmp_);
+    } catch (...) {
+      // 手元に残っている部分配列は整列を諦め、終わったものとして数える
+      done__(std::distance(a0, aN), std::current_exception());
+      return;
+    }
+    done__(std::distance(a0, aN), nullptr);
+  }
+
+  /**
+   * @brief 部分配列[a0, aN)をスレッドプール上で分割する
+   * @note  9要素の擬似中央値をピボットとし、ピボット未満の要素を左に集めます.
+   *        ピボット未満の要素が1つもなければピボット以下の要素を左に集め直し、equalをtrueにします.
+   *        このとき[a0, aP)の要素はすべてピボットと等しくなります
+   * @param Pool&  pool  スレッドプール
+   * @param iter_t a0    先頭イテレータ
+   * @param iter_t aN    末尾の次を指すイテレータ
+   * @param bool&  equal 左側がピボットと等しい要素だけになったかどうか
+   * @return 分割の境界aP(a0 < aP < aN)
+   */
+  template <class Pool>
+  iter_t parallel_partition__(Pool &pool, const iter_t a0, const iter_t aN,
+                              bool &equal) {
+    const dif_t h = std::distance(a0, aN) / 2;
+    const iter_t aR = std::prev(aN);
+    const val_t pivot = intro_t::median_of_3(
+        intro_t::median_of_3(a0[0], a0[1], a0[2], cmp_),
+        intro_t::median_of_3(a0[h - 1], a0[h], a0[h + 1], cmp_),
+        intro_t::median_of_3(aR[-2], aR[-1], aR[0], cmp_), cmp_);
+    const iter_t aP = stripe_partition__(
+        pool, a0, aN, [&](const val_t &x) { return cmp_(x, pivot); });
+    equal = aP == a0;
+    if (!equal) {
+      return aP;
+    }
+    return stripe_partition__(
+        pool, a0, aN, [&](const val_t &x) { return !cmp_(pivot, x); });
+  }
+
+  /**
+   * @brief 部分配列[a0, aN)をpredを満たす要素とそれ以外に並列に分ける
+   * @note  区間を帯に分けて帯毎に並列に分割した後、境界aPの左に残ったpredを満たさない要素と
+   *        右に残ったpredを満たす要素(両者は同数)を、先頭から順に組にして並列に交換します
+   * @return predを満たす要素の個数だけa0から進めた境界aP
+   */
+  template <class Pool, class Pred>
+  iter_t stripe_partition__(Pool &pool, const iter_t a0, const iter_t aN,
+                            Pred pred) {
+    const dif_t d = std::distance(a0, aN);
+    const dif_t k = std::min(d / cutoff_, stripes_);
+    auto bound = [&](dif_t i) { return a0 + d * i / k; };
+    std::vector<iter_t> mids(static_cast<std::size_t>(k));
+    sort_detail::parallel_for(pool, mids.size(), [&](std::size_t i) {
+      const dif_t j = static_cast<dif_t>(i);
+      mids[i] = std::partition(bound(j), bound(j + 1), pred);
+    });
+    dif_t n = 0;
+    for (dif_t i = 0; i < k; i++) {
+      n += std::distance(bound(i), mids[static_cast<std::size_t>(i)]);
+    }
+    const iter_t aP = a0 + n;
+
+    // 境界の左に残ったpredを満たさない区間と、右に残ったpredを満たす区間を集める
+    std::vector<range_t> ls, rs;
+    std::vector<dif_t> pl, pr; /**< 各区間より前にある要素数 */
+    dif_t m = 0, mr = 0;
+    for (dif_t i = 0; i < k; i++) {
+      const iter_t mid = mids[static_cast<std::size_t>(i)];
+      const iter_t l0 = mid, lN = std::min(bound(i + 1), aP);
+      if (l0 < lN) {
+        ls.emplace_back(l0, lN);
+        pl.push_back(m);
+        m += std::distance(l0, lN);
+      }
+      const iter_t r0 = std::max(bound(i), aP), rN = mid;
+      if (r0 < rN) {
+        rs.emplace_back(r0, rN);
+        pr.push_back(mr);
+        mr += std::distance(r0, rN);
+      }
+    }
+
+    // 左右のj番目同士を交換する. cutoff個ずつの小片に分けて並列に処理する
+    const std::size_t count =
+        static_cast<std::size_t>((m + cutoff_ - 1) / cutoff_);
+    sort_detail::parallel_for(pool, count, [&](std::size_t c) {
+      dif_t j0 = static_cast<dif_t>(c) * cutoff_;
+      const dif_t jN = std::min(j0 + cutoff_, m);
+      auto [i, x] = seek__(ls, pl, j0);
+      auto [j, y] = seek__(rs, pr, j0);
+      while (j0 < jN) {
+        if (x == ls[i].second) {
+          x = ls[++i].first;
+        }
+        if (y == rs[j].second) {
+          y = rs[++j].first;
+        }
+        const dif_t len = std::min({jN - j0, std::distance(x, ls[i].second),
+                                    std::distance(y, rs[j].second)});
+        y = std::swap_ranges(x, x + len, y);
+        x += len;
+        j0 += len;
+      }
+    });
+    return aP;
+  }
+
+  /**
+   * @brief  区間の列を連結したときのj番目の要素を探す
+   * @param  const std::vector<range_t>& rs  空でない区間の列
+   * @param  const std::vector<dif_t>&   pre 各区間より前にある要素数
+   * @param  dif_t                       j   要素の番号
+   * @return 要素を含む区間の番号とその要素を指すイテレータ
+   */
+  static std::pair<std::size_t, iter_t>
+  seek__(const std::vector<range_t> &rs, const std::vector<dif_t> &pre,
+         dif_t j) {
+    const std::size_t i = static_cast<std::size_t>(
+        std::upper_bound(pre.begin(), pre.end(), j) - pre.begin() - 1);
+    return {i, rs[i].first + (j - pre[i])};
+  }
+
+  /**
+   * @brief 部分配列[a0, aN)をキューに入れ、取り出して処理するタスクをプールに投げる
+   * @note  タスクはshared_ptrでこのオブジェクトを保持するので、ソートが終わった後に
+   *        実行されても安全です(キューが空なら何もしません)
+   */
+  template <class Pool>
+  void spawn__(Pool &pool, iter_t a0, iter_t aN, depth_t limit) {
+    {
+      std::lock_guard<std::mutex> lock(m_);
+      queue_.emplace_back(a0, aN, limit);
+    }
+    cv_.notify_all();
+    boost::asio::post(pool, [self = this->shared_from_this(), &pool] {
+      self->help__(pool);
+    });
+  }
+
+  /**
+   * @brief  キューから部分配列を1つ取り出す
+   * @note   m_をロックし、キューが空でないことを確かめてから呼ぶこと
+   * @return 取り出した部分配列と再帰の深さ制限
+   */
+  std::tuple<iter_t, iter_t, depth_t> pop__() {
+    auto t = queue_.front();
+    queue_.pop_front();
+    return t;
+  }
+
+  /**< @brief キューに部分配列があれば1つ取り出して処理する */
+  template <class Pool> void help__(Pool &pool) {
+    std::unique_lock<std::mutex> lock(m_);
+    if (queue_.empty()) {
+      return;
+    }
+    const auto [a0, aN, limit] = pop__();
+    lock.unlock();
+    task__(pool, a0, aN, limit);
+  }
+
+  /**
+   * @brief 要素数nの部分配列の処理が終わったことを通知する
+   * @param dif_t              n 整列を終えた要素数
+   * @param std::exception_ptr e 送出された例外(なければnullptr)
+   */
+  void done__(dif_t n, std::exception_ptr e) {
+    std::lock_guard<std::mutex> lock(m_);
+    if (e && !e_) {
+      e_ = e;
+    }
+    remain_ -= n;
+    if (remain_ <= 0) {
+      cv_.notify_all();
+    }
+  }
+
+  /**
+   * @brief すべてのタスクが終わるまで、キューの部分配列を処理しながら待つ
+   * @note  タスク内で例外が送出されていた場合は再送出します
+   */
+  template <class Pool> void wait__(Pool &pool) {
+    std::unique_lock<std::mutex> lock(m_);
+    while (true) {
+      cv_.wait(lock, [this] { return remain_ <= 0 || !queue_.empty(); });
+      if (remain_ <= 0) {
+        break;
+      }
+      const auto [a0, aN, limit] = pop__();
+      lock.unlock();
+      task__(pool, a0, aN, limit);
+      lock.lock();
+    }
+    if (e_) {
+      std::rethrow_exception(e_);
+    }
+  }
+};
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  スレッドプール上で並列イントロソートを行います
+ * @note   呼び出し元のスレッドも、すべてのタスクが終わるまで部分配列の処理を手伝います
+ * @note   poolはboost::asio::post可能なもの(boost::asio::thread_poolなど)を渡してください.
+ *         poolのタスクの中から呼び出しても構いません
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @tparam Pool                       スレッドプール
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ * @param  Pool& pool                 スレッドプール
+ * @param  difference_type cutoff     これ以下の部分配列はタスク内で逐次にソートされます. 並列な分割の小片の最小の大きさにもなります
+ */
+template <class RandomAccessIterator, class Compare, class Pool>
+inline void parallel_intro_sort(
+    RandomAccessIterator a0, RandomAccessIterator aN, Compare cmp, Pool &pool,
+    typename std::iterator_traits<RandomAccessIterator>::difference_type
+        cutoff) {
+  using sort_t = ParallelIntroSort<RandomAccessIterator, Compare>;
+  const auto n = std::distance(a0, aN);
+  if (n <= cutoff) {
+    intro_sort(a0, aN, cmp);
+    return;
+  }
+  const std::shared_ptr<sort_t> s(new sort_t(cmp, n, cutoff));
+  s->spawn__(pool, a0, aN, sort_t::depth_limit__(n));
+  s->wait__(pool);
+}
+
+/**
+ * @brief  スレッドプール上で並列イントロソートを行います(比較述語を省略した場合、こちらが呼ばれます)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Pool                       スレッドプール
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Pool& pool                 スレッドプール
+ */
+template <class RandomAccessIterator, class Pool>
+inline void parallel_intro_sort(RandomAccessIterator a0,
+                                RandomAccessIterator aN, Pool &pool) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  parallel_intro_sort(a0, aN, std::less<val_t>(), pool);
+}
+
+#endif // endif PARALLEL_INTRO_SORT_HPP
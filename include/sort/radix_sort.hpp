@@ -0,0 +1,257 @@
+/**
+ * @brief 基数ソートの実装
+ * @note  キーが32ビット以下のときはLSD(下位桁から)、64ビットのときはMSD(上位桁から)で
+ *        8ビットずつ整列します。MSDでは小さなバケットをイントロソートに任せます。
+ * @note  符号付き整数は符号ビットを反転し、浮動小数点数は負のとき全ビットを、
+ *        非負のとき符号ビットを反転することで符号なし整数の大小関係に揃えます。
+ * @note  作業領域はpmrアロケータから確保します。
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef RADIX_SORT_HPP
+#define RADIX_SORT_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "sort/intro_sort.hpp"
+#include <array>
+#include <bit>
+#include <boost/container/pmr/global_resource.hpp>
+#include <boost/container/pmr/memory_resource.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  算術型の値xを、大小関係を保ったまま同じ幅の符号なし整数に変換する
+ * @tparam T 算術型
+ * @param  T x 値
+ * @return 符号なし整数としての比較がxの比較と一致する値
+ */
+template <class T> constexpr auto radix_key(T x) noexcept {
+  static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+                "radix_key requires an arithmetic key type");
+  using u_t = std::conditional_t<
+      sizeof(T) == 1, std::uint8_t,
+      std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                         std::conditional_t<sizeof(T) == 4, std::uint32_t,
+                                            std::uint64_t>>>;
+  static_assert(sizeof(T) == sizeof(u_t), "unsupported key width");
+  constexpr u_t sign = u_t(1) << (sizeof(u_t) * 8 - 1);
+  if constexpr (std::is_floating_point_v<T>) {
+    const u_t u = std::bit_cast<u_t>(x);
+    return static_cast<u_t>((u & sign) ? ~u : (u | sign));
+  } else if constexpr (std::is_signed_v<T>) {
+    return static_cast<u_t>(static_cast<u_t>(x) ^ sign);
+  } else {
+    return static_cast<u_t>(x);
+  }
+}
+
+/**< @brief 要素自身をキーとする関数オブジェクト */
+struct radix_identity {
+  template <class T> constexpr const T &operator()(const T &x) const noexcept {
+    return x;
+  }
+};
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  基数ソートクラス
+ * @tparam RandomAccessIterator (ランダムアクセス)イテレータ
+ * @tparam KeyExtract           要素から算術型のキーを取り出す関数オブジェクト
+ */
+template <class RandomAccessIterator, class KeyExtract> class RadixSort {
+private:
+  using iter_t = RandomAccessIterator;
+  using val_t = typename std::iterator_traits<iter_t>::value_type;
+  using dif_t = typename std::iterator_traits<iter_t>::difference_type;
+  using key_t = std::decay_t<std::invoke_result_t<KeyExtract, const val_t &>>;
+  using ukey_t = decltype(radix_key(std::declval<key_t>()));
+  using alloc_t = boost::container::pmr::polymorphic_allocator<val_t>;
+  using buf_t = std::vector<val_t, alloc_t>;
+  using hist_t = std::array<dif_t, 256>;
+
+  static constexpr std::size_t digits = sizeof(ukey_t); /**< 8ビット桁の数 */
+  static constexpr dif_t fallback = 128; /**< MSDでイントロソートに任せる要素数 */
+
+  template <class RAI, class Key>
+  friend void radix_sort(RAI a0, RAI aN, Key key,
+                         boost::container::pmr::memory_resource *mr);
+
+  RadixSort(KeyExtract key, alloc_t alloc) : key_(key), buf_(alloc) {}
+
+  KeyExtract key_; /**< キーの取り出し */
+  buf_t buf_;      /**< 作業領域 */
+
+  /**< @brief 要素xの変換後のキーのshiftビット目から8ビットを取り出す */
+  std::size_t digit__(const val_t &x, std::size_t shift) const {
+    return static_cast<std::size_t>((radix_key(key_(x)) >> shift) & 0xff);
+  }
+
+  /**
+   * @brief LSD基数ソート
+   * @note  全桁のヒストグラムを1度の走査で数え、全要素が同じ値を持つ桁は飛ばします
+   * @param iter_t a0 先頭イテレータ
+   * @param iter_t aN 末尾の次を指すイテレータ
+   */
+  void lsd__(const iter_t a0, const iter_t aN) {
+    const dif_t n = std::distance(a0, aN);
+    std::array<hist_t, digits> hist{};
+    for (iter_t it = a0; it != aN; ++it) {
+      const ukey_t k = radix_key(key_(*it));
+      for (std::size_t d = 0; d < digits; d++) {
+        hist[d][(k >> (d * 8)) & 0xff]++;
+      }
+    }
+    buf_.assign(std::make_move_iterator(a0), std::make_move_iterator(aN));
+    bool in_buf = true; // 最新の並びが作業領域にあるかどうか
+    auto scatter = [&](auto src, auto dst, hist_t &h, std::size_t shift) {
+      dif_t sum = 0;
+      for (auto &c : h) { // 度数を各バケットの書き込み位置に変える
+        sum += c;
+        c = sum - c;
+      }
+      for (dif_t i = 0; i < n; i++) {
+        dst[h[digit__(src[i], shift)]++] = std::move(src[i]);
+      }
+    };
+    for (std::size_t d = 0; d < digits; d++) {
+      if (hist[d][digit__(in_buf ? buf_[0] : a0[0], d * 8)] == n) {
+        continue; // 全要素がこの桁で同じ値なので並びは変わらない
+      }
+      if (in_buf) {
+        scatter(buf_.begin(), a0, hist[d], d * 8);
+      } else {
+        scatter(a0, buf_.begin(), hist[d], d * 8);
+      }
+      in_buf = !in_buf;
+    }
+    if (in_buf) {
+      std::move(buf_.begin(), buf_.end(), a0);
+    }
+  }
+
+  /**
+   * @brief MSD基数ソート
+   * @note  shiftビット目からの8ビットで振り分け、各バケットを次の桁で再帰的に整列します.
+   *        要素数がfallback以下のバケットはイントロソートで整列します
+   * @param iter_t      a0    先頭イテレータ
+   * @param iter_t      aN    末尾の次を指すイテレータ
+   * @param std::size_t shift 注目する桁の位置(ビット)
+   */
+  void msd__(const iter_t a0, const iter_t aN, std::size_t shift) {
+    const dif_t n = std::distance(a0, aN);
+    if (n <= fallback) {
+      intro_sort(a0, aN, [this](const val_t &x, const val_t &y) {
+        return radix_key(key_(x)) < radix_key(key_(y));
+      });
+      return;
+    }
+    hist_t hist{};
+    for (iter_t it = a0; it != aN; ++it) {
+      hist[digit__(*it, shift)]++;
+    }
+    if (hist[digit__(*a0, shift)] != n) { // 全要素が同じ値の桁は振り分けない
+      hist_t pos{};
+      for (std::size_t b = 1; b < pos.size(); b++) {
+        pos[b] = pos[b - 1] + hist[b - 1];
+      }
+      buf_.assign(std::make_move_iterator(a0), std::make_move_iterator(aN));
+      for (auto &x : buf_) {
+        a0[pos[digit__(x, shift)]++] = std::move(x);
+      }
+    }
+    if (shift == 0) {
+      return;
+    }
+    iter_t b0 = a0;
+    for (const dif_t c : hist) {
+      if (c > 1) {
+        msd__(b0, std::next(b0, c), shift - 8);
+      }
+      std::advance(b0, c);
+    }
+  }
+
+  /**
+   * @brief 基数ソートの本体呼び出し
+   * @param iter_t a0 先頭イテレータ
+   * @param iter_t aN 末尾の次を指すイテレータ
+   */
+  void sort__(const iter_t a0, const iter_t aN) {
+    if (std::distance(a0, aN) < 2) {
+      return;
+    }
+    if constexpr (digits <= 4) {
+      lsd__(a0, aN);
+    } else {
+      buf_.reserve(std::distance(a0, aN));
+      msd__(a0, aN, (digits - 1) * 8);
+    }
+  }
+};
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  基数ソートを行います
+ * @note   キーの等しい要素の順序はLSD(キーが32ビット以下)では保たれ、MSDでは保たれません
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam KeyExtract                 要素から算術型のキーを取り出す関数オブジェクト
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  KeyExtract key             キーの取り出し
+ * @param  memory_resource* mr        作業領域を確保するメモリリソース
+ */
+template <class RandomAccessIterator, class KeyExtract>
+inline void radix_sort(RandomAccessIterator a0, RandomAccessIterator aN,
+                       KeyExtract key,
+                       boost::container::pmr::memory_resource *mr) {
+  using sort_t = RadixSort<RandomAccessIterator, KeyExtract>;
+  sort_t radix(key, typename sort_t::alloc_t(mr));
+  radix.sort__(a0, aN);
+}
+
+/**
+ * @brief  基数ソートを行います(メモリリソースを省略した場合、こちらが呼ばれます)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam KeyExtract                 要素から算術型のキーを取り出す関数オブジェクト
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  KeyExtract key             キーの取り出し
+ */
+template <class RandomAccessIterator, class KeyExtract>
+inline void radix_sort(RandomAccessIterator a0, RandomAccessIterator aN,
+                       KeyExtract key) {
+  radix_sort(a0, aN, key, boost::container::pmr::get_default_resource());
+}
+
+/**
+ * @brief  基数ソートを行います(算術型の要素をそのままキーとする場合、こちらが呼ばれます)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ */
+template <class RandomAccessIterator>
+inline void radix_sort(RandomAccessIterator a0, RandomAccessIterator aN) {
+  radix_sort(a0, aN, radix_identity());
+}
+
+#endif // endif RADIX_SORT_HPP
@@ -0,0 +1,305 @@
+/**
+ * @brief AVX2によるソーティングネットワークの実装
+ * @note  16要素以下の配列を、番兵で埋めた8要素または16要素のバイトニックソートで整列します。
+ *        32ビットの要素は1レジスタに8要素、64ビットの要素は1レジスタに4要素を載せ、
+ *        比較交換はレジスタ内の並べ替えとmin/maxとブレンドで行います。
+ * @note  要素型がint32/uint32/float/int64/uint64/doubleで、比較述語がstd::lessまたは
+ *        std::greaterのときだけ使えます(enabledで判定してください)。
+ * @note  AVX2の実装はCPU_TARGETでコンパイルし、実行時にcpu::dispatcherで選びます。
+ *        AVX2が無いCPUでは同じ要素数の挿入ソートを行います。
+ * @note  比較交換は1回の比較のマスクから小さい方と大きい方を作るので、
+ *        +0.0と-0.0のように比較で順序の付かない要素も失われません.
+ *        NaNを含む配列は番兵の位置が定まらないので挿入ソートで整列します
+ * @note  Reference: K. E. Batcher, "Sorting networks and their applications", 1968.
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef SORTING_NETWORK_HPP
+#define SORTING_NETWORK_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "cpu/cpu_features.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+#define SORTING_NETWORK_SIMD 1
+#include <immintrin.h>
+#endif
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  ソーティングネットワーククラス
+ * @tparam T       要素の型
+ * @tparam Compare 比較述語
+ */
+template <class T, class Compare> class SortingNetwork {
+private:
+  static constexpr bool is_less = std::is_same_v<Compare, std::less<T>> ||
+                                  std::is_same_v<Compare, std::less<>>;
+  static constexpr bool is_greater =
+      std::is_same_v<Compare, std::greater<T>> ||
+      std::is_same_v<Compare, std::greater<>>;
+
+public:
+  /**< @brief この型と比較述語でソーティングネットワークが使えるかどうか */
+#if defined(SORTING_NETWORK_SIMD)
+  static constexpr bool enabled =
+      std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+      (sizeof(T) == 4 || sizeof(T) == 8) && (is_less || is_greater);
+#else
+  static constexpr bool enabled = false;
+#endif
+
+  /**< @brief 一度に整列できる最大の要素数 */
+  static constexpr std::ptrdiff_t max_size = 16;
+
+#if defined(SORTING_NETWORK_SIMD)
+  /**
+   * @brief 配列a[0..n)を整列する
+   * @note  実行時の機能に応じてAVX2のネットワークか挿入ソートを選びます
+   * @param T*             a 配列の先頭
+   * @param std::ptrdiff_t n 要素数(max_size以下)
+   */
+  static void sort(T *a, std::ptrdiff_t n) {
+    static const cpu::dispatcher<void(T *, std::ptrdiff_t)> f = {
+        {cpu::avx2, sort_avx2__}, {cpu::none, sort_scalar__}};
+    f(a, n);
+  }
+
+  /**< @brief AVX2のネットワークで配列a[0..n)を整列する */
+  CPU_TARGET("avx2") static void sort_avx2__(T *a, std::ptrdiff_t n) {
+    if (n < 2) {
+      return;
+    }
+    if constexpr (std::is_floating_point_v<T>) {
+      // NaNがあると番兵が末尾に来るとは限らないので、挿入ソートに任せる
+      for (std::ptrdiff_t i = 0; i < n; i++) {
+        if (a[i] != a[i]) {
+          sort_scalar__(a, n);
+          return;
+        }
+      }
+    }
+    if (n <= 8) {
+      sort_n__<8>(a, n);
+    } else {
+      sort_n__<16>(a, n);
+    }
+  }
+
+  /**< @brief AVX2が無いときに配列a[0..n)を挿入ソートで整列する */
+  static void sort_scalar__(T *a, std::ptrdiff_t n) {
+    const Compare cmp{};
+    for (std::ptrdiff_t i = 1; i < n; i++) {
+      const T x = a[i];
+      std::ptrdiff_t j = i;
+      for (; j > 0 && cmp(x, a[j - 1]); j--) {
+        a[j] = a[j - 1];
+      }
+      a[j] = x;
+    }
+  }
+
+private:
+  static constexpr int lanes = 32 / sizeof(T); /**< 1レジスタの要素数 */
+
+  /**< @brief 昇順に並べたとき末尾に来る番兵 */
+  static constexpr T pad() {
+    if constexpr (std::is_floating_point_v<T>) {
+      return is_less ? std::numeric_limits<T>::infinity()
+                     : -std::numeric_limits<T>::infinity();
+    } else {
+      return is_less ? std::numeric_limits<T>::max()
+                     : std::numeric_limits<T>::lowest();
+    }
+  }
+
+  /**< @brief レーン毎の最小値 */
+  CPU_TARGET("avx2") static __m256i min__(__m256i x, __m256i y) {
+    if constexpr (std::is_same_v<T, float>) {
+      return _mm256_castps_si256(
+          _mm256_min_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(y)));
+    } else if constexpr (std::is_same_v<T, double>) {
+      return _mm256_castpd_si256(
+          _mm256_min_pd(_mm256_castsi256_pd(x), _mm256_castsi256_pd(y)));
+    } else if constexpr (sizeof(T) == 4) {
+      return std::is_signed_v<T> ? _mm256_min_epi32(x, y)
+                                 : _mm256_min_epu32(x, y);
+    } else {
+      return _mm256_blendv_epi8(x, y, gt64__(x, y));
+    }
+  }
+
+  /**< @brief レーン毎の最大値 */
+  CPU_TARGET("avx2") static __m256i max__(__m256i x, __m256i y) {
+    if constexpr (std::is_same_v<T, float>) {
+      return _mm256_castps_si256(
+          _mm256_max_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(y)));
+    } else if constexpr (std::is_same_v<T, double>) {
+      return _mm256_castpd_si256(
+          _mm256_max_pd(_mm256_castsi256_pd(x), _mm256_castsi256_pd(y)));
+    } else if constexpr (sizeof(T) == 4) {
+      return std::is_signed_v<T> ? _mm256_max_epi32(x, y)
+                                 : _mm256_max_epu32(x, y);
+    } else {
+      return _mm256_blendv_epi8(y, x, gt64__(x, y));
+    }
+  }
+
+  /**< @brief 64ビット整数のレーン毎のx > y(符号なしは符号ビットを反転して比べる) */
+  CPU_TARGET("avx2") static __m256i gt64__(__m256i x, __m256i y) {
+    if constexpr (std::is_unsigned_v<T>) {
+      const __m256i s = _mm256_set1_epi64x(std::int64_t(1) << 63);
+      return _mm256_cmpgt_epi64(_mm256_xor_si256(x, s),
+                                _mm256_xor_si256(y, s));
+    } else {
+      return _mm256_cmpgt_epi64(x, y);
+    }
+  }
+
+  /**< @brief レーン毎のx < y(浮動小数点数はNaNを含むと偽) */
+  CPU_TARGET("avx2") static __m256i lt__(__m256i x, __m256i y) {
+    if constexpr (std::is_same_v<T, float>) {
+      return _mm256_castps_si256(_mm256_cmp_ps(
+          _mm256_castsi256_ps(x), _mm256_castsi256_ps(y), _CMP_LT_OQ));
+    } else if constexpr (std::is_same_v<T, double>) {
+      return _mm256_castpd_si256(_mm256_cmp_pd(
+          _mm256_castsi256_pd(x), _mm256_castsi256_pd(y), _CMP_LT_OQ));
+    } else if constexpr (sizeof(T) == 4) {
+      // min(x, y) != yならばx < y
+      return _mm256_andnot_si256(_mm256_cmpeq_epi32(min__(x, y), y),
+                                 _mm256_set1_epi32(-1));
+    } else {
+      return gt64__(y, x);
+    }
+  }
+
+  /**
+   * @brief レジスタ内の比較交換
+   * @note  レーンiをレーンi ^ jと比べ、maskの立つ(32ビット単位の)レーンに大きい方を残す.
+   *        組になる2つのレーンでmin/maxの引数の順が逆になるので、
+   *        順序の付かない要素(+0.0と-0.0, NaN)も一方が失われることはない
+   */
+  CPU_TARGET("avx2") static __m256i exchange__(__m256i v, __m256i perm,
+                                               __m256i mask) {
+    const __m256i p = _mm256_permutevar8x32_epi32(v, perm);
+    return _mm256_blendv_epi8(min__(v, p), max__(v, p), mask);
+  }
+
+  /**< @brief レジスタ内の比較交換1回分の並べ替えとブレンドのマスク */
+  struct stage {
+    alignas(32) std::int32_t perm[8];
+    alignas(32) std::int32_t mask[8];
+  };
+
+  /**
+   * @brief 要素数N個のバイトニックソートのレジスタ内の比較交換を、段と
+   *        レジスタの順に並べた表を作る
+   * @note  レーンiはレーンi ^ jと比べ、昇順の区間では上側、降順の区間では下側が大きい方を取る
+   */
+  template <int N> static constexpr auto make_stages() {
+    constexpr int regs = N / lanes;
+    constexpr int count = [] {
+      int c = 0;
+      for (int k = 2; k <= N; k <<= 1) {
+        for (int j = k >> 1; j > 0; j >>= 1) {
+          c += j < lanes ? regs : 0;
+        }
+      }
+      return c;
+    }();
+    std::array<stage, count> t{};
+    int c = 0;
+    for (int k = 2; k <= N; k <<= 1) {
+      for (int j = k >> 1; j > 0; j >>= 1) {
+        if (j >= lanes) {
+          continue;
+        }
+        for (int r = 0; r < regs; r++, c++) {
+          for (int w = 0; w < 8; w++) {
+            const int l = w * lanes / 8;     // 32ビット単位wが属するレーン
+            const int s = w - l * 8 / lanes; // レーン内の位置
+            const int i = r * lanes + l;
+            const bool ascending = (i & k) == 0;
+            t[c].perm[w] = (l ^ j) * 8 / lanes + s;
+            t[c].mask[w] = ((i & j) != 0) == ascending ? -1 : 0;
+          }
+        }
+      }
+    }
+    return t;
+  }
+
+  /**
+   * @brief バイトニックソートで要素数N個の配列を昇順に整列し、先頭n個をaに書き戻す
+   * @note  比較述語がstd::greaterのときは降順になるよう逆から書き戻します
+   */
+  template <int N>
+  CPU_TARGET("avx2")
+  static void sort_n__(T *a, std::ptrdiff_t n) {
+    constexpr int regs = N / lanes;
+    static constexpr auto stages = make_stages<N>();
+    alignas(32) T buf[N];
+    for (int i = 0; i < N; i++) {
+      buf[i] = i < n ? a[i] : pad();
+    }
+    __m256i v[regs];
+    for (int r = 0; r < regs; r++) {
+      v[r] = _mm256_load_si256(reinterpret_cast<const __m256i *>(buf) + r);
+    }
+
+    int c = 0;
+    for (int k = 2; k <= N; k <<= 1) {
+      for (int j = k >> 1; j > 0; j >>= 1) {
+        if (j >= lanes) { // レジスタ間の比較交換
+          const int d = j / lanes;
+          for (int r = 0; r < regs; r++) {
+            if ((r & d) != 0) {
+              continue;
+            }
+            // 同じマスクから両方を作るので、順序の付かない要素も入れ替わるだけで失われない
+            const __m256i m = lt__(v[r + d], v[r]);
+            const __m256i lo = _mm256_blendv_epi8(v[r], v[r + d], m);
+            const __m256i hi = _mm256_blendv_epi8(v[r + d], v[r], m);
+            const bool ascending = ((r * lanes) & k) == 0;
+            v[r] = ascending ? lo : hi;
+            v[r + d] = ascending ? hi : lo;
+          }
+          continue;
+        }
+        for (int r = 0; r < regs; r++, c++) { // レジスタ内の比較交換
+          v[r] = exchange__(
+              v[r],
+              _mm256_load_si256(
+                  reinterpret_cast<const __m256i *>(stages[c].perm)),
+              _mm256_load_si256(
+                  reinterpret_cast<const __m256i *>(stages[c].mask)));
+        }
+      }
+    }
+
+    for (int r = 0; r < regs; r++) {
+      _mm256_store_si256(reinterpret_cast<__m256i *>(buf) + r, v[r]);
+    }
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+      a[i] = is_less ? buf[i] : buf[N - 1 - i];
+    }
+  }
+#endif
+};
+
+#endif // endif SORTING_NETWORK_HPP
@@ -0,0 +1,397 @@
+/**
+ * @brief 安定なマージソートの実装
+ * @note  作業領域はpmrアロケータから確保し、確保できなかったときは回転(rotate)による
+ *        作業領域なしのマージに切り替えます。
+ * @note  並列版は区間毎に安定ソートした後、マージパス(merge path)で各マージを
+ *        独立した小片に分けてスレッドプール上で並列にマージします。
+ * @note  std::stable_sortと引数依存の名前探索で衝突しないよう、stable_merge_sortと名付けています。
+ * @note  Reference: O. Green, R. McColl and D. A. Bader, "GPU Merge Path: A GPU
+ * Merging Algorithm", ICS 2012.
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef STABLE_SORT_HPP
+#define STABLE_SORT_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "sort/detail/parallel_for.hpp"
+#include <algorithm>
+#include <boost/container/pmr/global_resource.hpp>
+#include <boost/container/pmr/memory_resource.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <vector>
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  安定なマージソートクラス
+ * @tparam RandomAccessIterator (ランダムアクセス)イテレータ
+ * @tparam Compare              比較述語
+ */
+template <class RandomAccessIterator, class Compare> class StableSort {
+private:
+  using iter_t = RandomAccessIterator;
+  using cmp_t = Compare;
+  using val_t = typename std::iterator_traits<iter_t>::value_type;
+  using dif_t = typename std::iterator_traits<iter_t>::difference_type;
+  using alloc_t = boost::container::pmr::polymorphic_allocator<val_t>;
+  using buf_t = std::vector<val_t, alloc_t>;
+
+  template <class RAI, class Cmp>
+  friend void stable_merge_sort(RAI a0, RAI aN, Cmp cmp,
+                                boost::container::pmr::memory_resource *mr);
+  template <class RAI, class Cmp, class Pool>
+  friend void
+  parallel_stable_merge_sort(RAI a0, RAI aN, Cmp cmp, Pool &pool,
+                             boost::container::pmr::memory_resource *mr);
+
+  static constexpr dif_t insertion_threshold = 32; /**< 挿入ソートに切り替える要素数 */
+  static constexpr dif_t grain = 1 << 14; /**< 並列処理の1タスクあたりの要素数 */
+
+  StableSort(cmp_t cmp, alloc_t alloc) : cmp_(cmp), buf_(alloc) {}
+
+  cmp_t cmp_; /**< 比較述語 */
+  buf_t buf_; /**< 作業領域 */
+
+  /**
+   * @brief 安定なマージソートの本体
+   * @note  要素数の半分の作業領域が確保できなければ作業領域なしで整列します
+   * @param iter_t a0 先頭イテレータ
+   * @param iter_t aN 末尾の次を指すイテレータ
+   */
+  void sort__(const iter_t a0, const iter_t aN) {
+    const dif_t n = std::distance(a0, aN);
+    if (n <= insertion_threshold) {
+      insertion_sort__(a0, aN);
+      return;
+    }
+    try {
+      buf_.reserve(static_cast<std::size_t>((n + 1) / 2));
+    } catch (const std::bad_alloc &) {
+      inplace_sort__(a0, aN);
+      return;
+    }
+    merge_sort__(a0, aN);
+  }
+
+  /**
+   * @brief 安定な挿入ソート
+   */
+  void insertion_sort__(const iter_t a0, const iter_t aN) {
+    if (a0 == aN) {
+      return;
+    }
+    for (iter_t j = std::next(a0); j != aN; ++j) {
+      if (!cmp_(*j, *std::prev(j))) {
+        continue;
+      }
+      val_t key = std::move(*j);
+      iter_t k = j;
+      do {
+        *k = std::move(*std::prev(k));
+        --k;
+      } while (k != a0 && cmp_(key, *std::prev(k)));
+      *k = std::move(key);
+    }
+  }
+
+  /**
+   * @brief 作業領域を使うマージソート
+   */
+  void merge_sort__(const iter_t a0, const iter_t aN) {
+    const dif_t n = std::distance(a0, aN);
+    if (n <= insertion_threshold) {
+      insertion_sort__(a0, aN);
+      return;
+    }
+    const iter_t m = std::next(a0, n / 2);
+    merge_sort__(a0, m);
+    merge_sort__(m, aN);
+    if (!cmp_(*m, *std::prev(m))) {
+      return; // 既に並んでいる
+    }
+    // 左側を作業領域に移して前からマージする(等しい要素は左側を先に置く)
+    buf_.assign(std::make_move_iterator(a0), std::make_move_iterator(m));
+    auto l = buf_.begin();
+    iter_t r = m, out = a0;
+    while (l != buf_.end() && r != aN) {
+      if (cmp_(*r, *l)) {
+        *out++ = std::move(*r++);
+      } else {
+        *out++ = std::move(*l++);
+      }
+    }
+    std::move(l, buf_.end(), out);
+  }
+
+  /**
+   * @brief 作業領域を使わないマージソート(O(n log^2 n))
+   */
+  void inplace_sort__(const iter_t a0, const iter_t aN) {
+    const dif_t n = std::distance(a0, aN);
+    if (n <= insertion_threshold) {
+      insertion_sort__(a0, aN);
+      return;
+    }
+    const iter_t m = std::next(a0, n / 2);
+    inplace_sort__(a0, m);
+    inplace_sort__(m, aN);
+    inplace_merge__(a0, m, aN, n / 2, n - n / 2);
+  }
+
+  /**
+   * @brief 隣り合う[a, m)と[m, b)を回転によって作業領域なしでマージする
+   * @note  長い方の中央の要素の位置をもう一方から二分探索し、その間を回転して2つの小さなマージに分けます
+   */
+  void inplace_merge__(const iter_t a, const iter_t m, const iter_t b,
+                       dif_t n1, dif_t n2) {
+    if (n1 == 0 || n2 == 0) {
+      return;
+    }
+    if (n1 + n2 == 2) {
+      if (cmp_(*m, *a)) {
+        std::iter_swap(a, m);
+      }
+      return;
+    }
+    iter_t cut1 = a, cut2 = m;
+    dif_t n11 = 0, n22 = 0;
+    if (n1 > n2) {
+      n11 = n1 / 2;
+      std::advance(cut1, n11);
+      cut2 = std::lower_bound(m, b, *cut1, cmp_);
+      n22 = std::distance(m, cut2);
+    } else {
+      n22 = n2 / 2;
+      std::advance(cut2, n22);
+      cut1 = std::upper_bound(a, m, *cut2, cmp_);
+      n11 = std::distance(a, cut1);
+    }
+    const iter_t mid = std::rotate(cut1, m, cut2);
+    inplace_merge__(a, cut1, mid, n11, n22);
+    inplace_merge__(mid, cut2, b, n1 - n11, n2 - n22);
+  }
+
+  /**
+   * @brief 整列済みのa[0..m)とb[0..k)をマージした列の先頭d個に含まれるaの要素数を求める(マージパス)
+   * @note  等しい要素はaを先に取るので、安定なマージの分割点になります
+   */
+  template <class It>
+  dif_t merge_path__(It a, dif_t m, It b, dif_t k, dif_t d) {
+    dif_t lo = std::max<dif_t>(0, d - k), hi = std::min(d, m);
+    while (lo < hi) {
+      const dif_t mid = lo + (hi - lo) / 2;
+      if (!cmp_(b[d - mid - 1], a[mid])) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  /**
+   * @brief 幅wの整列済みの区間を隣同士でマージし、srcからdstへ書き出す
+   * @note  各マージをマージパスでgrain要素ずつの独立した小片に分けて並列に処理します
+   */
+  template <class Pool, class Src, class Dst>
+  void merge_level__(Pool &pool, Src src, Dst dst, dif_t n, dif_t w) {
+    struct piece {
+      dif_t s, m, e; /**< マージする2区間[s, m), [m, e) */
+      dif_t d0, d1;  /**< 出力のうち担当する範囲 */
+    };
+    std::vector<piece> pieces;
+    for (dif_t s = 0; s < n; s += 2 * w) {
+      const dif_t m = std::min(s + w, n), e = std::min(s + 2 * w, n);
+      for (dif_t d = 0; d < e - s; d += grain) {
+        pieces.push_back({s, m, e, d, std::min(d + grain, e - s)});
+      }
+    }
+    sort_detail::parallel_for(pool, pieces.size(), [&](std::size_t i) {
+      const piece &p = pieces[i];
+      const Src a = src + p.s, b = src + p.m;
+      const dif_t na = p.m - p.s, nb = p.e - p.m;
+      const dif_t i0 = merge_path__(a, na, b, nb, p.d0);
+      const dif_t i1 = merge_path__(a, na, b, nb, p.d1);
+      std::merge(std::make_move_iterator(a + i0),
+                 std::make_move_iterator(a + i1),
+                 std::make_move_iterator(b + (p.d0 - i0)),
+                 std::make_move_iterator(b + (p.d1 - i1)), dst + (p.s + p.d0),
+                 cmp_);
+    });
+  }
+
+  /**
+   * @brief 並列な安定マージソートの本体
+   * @note  区間毎に安定ソートした後、作業領域と入力の間を往復しながら区間の幅を倍にしてマージします
+   */
+  template <class Pool>
+  void parallel_sort__(Pool &pool, const iter_t a0, const iter_t aN) {
+    const dif_t n = std::distance(a0, aN);
+    const dif_t w = std::max(grain, (n + 63) / 64); // 最初の区間の幅
+    {
+      // mrはスレッドセーフとは限らないので、区間毎の作業領域は呼び出し元で先に確保しておく
+      const std::size_t count = static_cast<std::size_t>((n + w - 1) / w);
+      std::vector<StableSort> parts;
+      parts.reserve(count);
+      for (std::size_t i = 0; i < count; i++) {
+        parts.push_back(StableSort(cmp_, buf_.get_allocator()));
+        try {
+          parts.back().buf_.reserve(static_cast<std::size_t>((w + 1) / 2));
+        } catch (const std::bad_alloc &) {
+          // 確保できなかった区間は作業領域なしで整列する
+        }
+      }
+      sort_detail::parallel_for(pool, count, [&](std::size_t i) {
+        const iter_t b0 = a0 + static_cast<dif_t>(i) * w;
+        const iter_t bN = b0 + std::min(w, std::distance(b0, aN));
+        StableSort &s = parts[i];
+        if (s.buf_.capacity() > 0) {
+          s.merge_sort__(b0, bN);
+        } else {
+          s.inplace_sort__(b0, bN);
+        }
+      });
+    }
+    try {
+      buf_.assign(std::make_move_iterator(a0), std::make_move_iterator(aN));
+    } catch (const std::bad_alloc &) {
+      // 作業領域が取れなければ逐次にマージする(入力はそのまま残っている)
+      for (dif_t v = w; v < n; v *= 2) {
+        for (dif_t s = 0; s + v < n; s += 2 * v) {
+          inplace_merge__(a0 + s, a0 + (s + v), a0 + std::min(s + 2 * v, n),
+                          v, std::min(s + 2 * v, n) - (s + v));
+        }
+      }
+      return;
+    }
+    bool in_buf = true; // 最新の並びが作業領域にあるかどうか
+    for (dif_t v = w; v < n; v *= 2, in_buf = !in_buf) {
+      if (in_buf) {
+        merge_level__(pool, buf_.begin(), a0, n, v);
+      } else {
+        merge_level__(pool, a0, buf_.begin(), n, v);
+      }
+    }
+    if (in_buf) {
+      const std::size_t count = static_cast<std::size_t>((n + grain - 1) / grain);
+      sort_detail::parallel_for(pool, count, [&](std::size_t i) {
+        const dif_t s = static_cast<dif_t>(i) * grain;
+        std::move(buf_.begin() + s, buf_.begin() + std::min(s + grain, n),
+                  a0 + s);
+      });
+    }
+  }
+};
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  安定なマージソートを行います
+ * @note   要素数の半分の作業領域をmrから確保します. 確保できないときはO(n log^2 n)の
+ *         作業領域なしのマージソートになります
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ * @param  memory_resource* mr        作業領域を確保するメモリリソース
+ */
+template <class RandomAccessIterator, class Compare>
+inline void stable_merge_sort(RandomAccessIterator a0, RandomAccessIterator aN,
+                              Compare cmp,
+                              boost::container::pmr::memory_resource *mr) {
+  using sort_t = StableSort<RandomAccessIterator, Compare>;
+  sort_t s(cmp, typename sort_t::alloc_t(mr));
+  s.sort__(a0, aN);
+}
+
+/**
+ * @brief  安定なマージソートを行います(メモリリソースを省略した場合、こちらが呼ばれます)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ */
+template <class RandomAccessIterator, class Compare>
+inline void stable_merge_sort(RandomAccessIterator a0, RandomAccessIterator aN,
+                              Compare cmp) {
+  stable_merge_sort(a0, aN, cmp,
+                    boost::container::pmr::get_default_resource());
+}
+
+/**
+ * @brief  安定なマージソートを行います(比較述語を省略した場合、こちらが呼ばれます)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ */
+template <class RandomAccessIterator>
+inline void stable_merge_sort(RandomAccessIterator a0,
+                              RandomAccessIterator aN) {
+  using val_t = typename std::iterator_traits<RandomAccessIterator>::value_type;
+  stable_merge_sort(a0, aN, std::less<val_t>());
+}
+
+/**
+ * @brief  スレッドプール上で安定なマージソートを行います
+ * @note   入力と同じ要素数の作業領域をmrから確保します. mrからの確保と解放はすべて呼び出し元のスレッドで行うので、
+ *         mrはスレッドセーフでなくても構いません
+ * @note   呼び出し元のスレッドも、すべてのタスクが終わるまで処理を手伝います. poolのタスクの中から呼び出しても構いません
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @tparam Pool                       スレッドプール(boost::asio::post可能なもの)
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ * @param  Pool& pool                 スレッドプール
+ * @param  memory_resource* mr        作業領域を確保するメモリリソース
+ */
+template <class RandomAccessIterator, class Compare, class Pool>
+inline void
+parallel_stable_merge_sort(RandomAccessIterator a0, RandomAccessIterator aN,
+                           Compare cmp, Pool &pool,
+                           boost::container::pmr::memory_resource *mr) {
+  using sort_t = StableSort<RandomAccessIterator, Compare>;
+  sort_t s(cmp, typename sort_t::alloc_t(mr));
+  if (std::distance(a0, aN) <= sort_t::grain) {
+    s.sort__(a0, aN);
+    return;
+  }
+  s.parallel_sort__(pool, a0, aN);
+}
+
+/**
+ * @brief  スレッドプール上で安定なマージソートを行います(メモリリソースを省略した場合、こちらが呼ばれます)
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @tparam Compare                    比較述語
+ * @tparam Pool                       スレッドプール(boost::asio::post可能なもの)
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ * @param  Compare cmp                比較述語
+ * @param  Pool& pool                 スレッドプール
+ */
+template <class RandomAccessIterator, class Compare, class Pool>
+inline void parallel_stable_merge_sort(RandomAccessIterator a0,
+                                       RandomAccessIterator aN, Compare cmp,
+                                       Pool &pool) {
+  parallel_stable_merge_sort(a0, aN, cmp, pool,
+                             boost::container::pmr::get_default_resource());
+}
+
+#endif // endif STABLE_SORT_HPP
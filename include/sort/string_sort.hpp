@@ -0,0 +1,233 @@
+/**
+ * @brief 文字列ソート(8バイトの接頭辞をキャッシュしたマルチキークイックソート)の実装
+ * @note  各文字列の深さdからの8バイトをビッグエンディアンの64ビット整数(キー)として
+ *        文字列へのポインタ、長さと組にしてキャッシュし、キーの比較で3分割します。
+ *        キーの等しい部分配列は深さを8バイト進めてキーを読み直すので、共通の接頭辞を
+ *        何度も比較しません。キーの比較は2^64進の基数で1桁ずつ分けるのと同じなので、
+ *        1バイトずつのMSD基数ソートより1回の分割で多くの接頭辞を片付けます。
+ * @note  同じ深さで分割が偏り続けたときは、その部分配列をイントロソートに任せます。
+ * @note  要素はdata()とsize()を持つ文字列(std::string, std::string_view,
+ *        boost::beast::string_view)で、std::less<std::string>と同じ(バイト単位の)順に並べます。
+ * @note  Reference: J. L. Bentley and R. Sedgewick, "Fast Algorithms for Sorting
+ * and Searching Strings", SODA 1997.
+ */
+
+//********************************************************************************
+// インクルードガード
+//********************************************************************************
+
+#ifndef STRING_SORT_HPP
+#define STRING_SORT_HPP
+
+//********************************************************************************
+// 必要なヘッダファイルのインクルード
+//********************************************************************************
+
+#include "sort/intro_sort.hpp"
+#include <algorithm>
+#include <boost/endian/conversion.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//********************************************************************************
+// クラスの定義
+//********************************************************************************
+
+/**
+ * @brief  文字列ソートクラス
+ * @tparam RandomAccessIterator (ランダムアクセス)イテレータ
+ */
+template <class RandomAccessIterator> class StringSort {
+private:
+  using iter_t = RandomAccessIterator;
+  using val_t = typename std::iterator_traits<iter_t>::value_type;
+
+  template <class RAI> friend void string_sort(RAI a0, RAI aN);
+
+  /**< @brief キャッシュした接頭辞のキーと文字列 */
+  struct item {
+    std::uint64_t key; /**< 深さdからの8バイト */
+    const char *ptr;   /**< 文字列の先頭 */
+    std::size_t len;   /**< 文字列の長さ */
+    std::size_t index; /**< 元の位置 */
+  };
+
+  static constexpr std::ptrdiff_t k = 16; /**< これ以下は挿入ソート */
+
+  std::vector<item> items_; /**< 整列する組 */
+
+  /**< @brief 文字列xの深さdからの8バイトを読む(足りない分は0で埋める) */
+  static std::uint64_t load__(const item &x, std::size_t d) {
+    if (x.len <= d) {
+      return 0;
+    }
+    std::uint64_t u = 0;
+    std::memcpy(&u, x.ptr + d, std::min<std::size_t>(8, x.len - d));
+    return boost::endian::big_to_native(u);
+  }
+
+  /**< @brief 深さdまで等しい文字列xとyについて、xがyより小さいかどうか */
+  static bool less__(const item &x, const item &y, std::size_t d) {
+    if (x.key != y.key) {
+      return x.key < y.key;
+    }
+    if (std::min(x.len, y.len) <= d + 8) { // 短い方はキーの中で終わっている
+      return x.len < y.len;
+    }
+    return std::string_view(x.ptr + d + 8, x.len - d - 8) <
+           std::string_view(y.ptr + d + 8, y.len - d - 8);
+  }
+
+  /**< @brief 全ての要素を整列してから元の配列に並べ直す */
+  void sort__(const iter_t a0, const iter_t aN) {
+    const std::size_t n = static_cast<std::size_t>(std::distance(a0, aN));
+    items_.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+      const auto &s = a0[i];
+      items_.push_back({0, std::data(s), std::size(s), i});
+      items_.back().key = load__(items_.back(), 0);
+    }
+    item *const b0 = items_.data();
+    mkqs__(b0, b0 + n, 0, depth_limit__(n));
+
+    std::vector<val_t> out;
+    out.reserve(n);
+    for (const item &x : items_) {
+      out.push_back(std::move(a0[x.index]));
+    }
+    std::move(out.begin(), out.end(), a0);
+  }
+
+  /**< @brief 同じ深さで許す分割の回数 */
+  static std::size_t depth_limit__(std::size_t n) {
+    return n < 2 ? 0 : static_cast<std::size_t>(bit::log2(n)) << 1;
+  }
+
+  /**
+   * @brief 深さdまで等しい部分配列[a0, aN)をマルチキークイックソートする
+   * @param item*       a0    先頭
+   * @param item*       aN    末尾の次
+   * @param std::size_t d     深さ(キーは[d, d + 8)バイト目)
+   * @param std::size_t limit この深さで残っている分割の回数
+   */
+  void mkqs__(item *a0, item *aN, std::size_t d, std::size_t limit) {
+    while (aN - a0 > k) {
+      if (limit < 1) { // 分割が偏り続けたので、この深さからの比較で整列する
+        intro_sort(a0, aN, [d](const item &x, const item &y) {
+          return less__(x, y, d);
+        });
+        return;
+      }
+      limit = limit - 1;
+      const std::ptrdiff_t r = (aN - a0) - 1;
+      const std::uint64_t pivot = IntroSort<item *, std::less<std::uint64_t>>::
+          median_of_3(a0[0].key, a0[r >> 1].key, a0[r].key,
+                      std::less<std::uint64_t>());
+      // [a0, lt) < pivot, [lt, i) == pivot, [i, gt)は未確認, [gt, aN) > pivot
+      item *lt = a0, *i = a0, *gt = aN;
+      while (i < gt) {
+        if (i->key < pivot) {
+          std::swap(*lt++, *i++);
+        } else if (pivot < i->key) {
+          std::swap(*i, *--gt);
+        } else {
+          ++i;
+        }
+      }
+      // 3つのうち最大の部分をループで処理し、残りを再帰で処理する.
+      // 再帰する部分は要素数の半分以下なので、スタックの深さはO(log n)に収まる
+      if (gt - lt >= lt - a0 && gt - lt >= aN - gt) {
+        // 等しい部分が最大: 深さを8バイト進めてループで続ける
+        // (共通の接頭辞が長くても再帰しない)
+        mkqs__(a0, lt, d, limit);
+        mkqs__(gt, aN, d, limit);
+        a0 = advance__(lt, gt, d);
+        aN = gt;
+        d += 8;
+        limit = depth_limit__(aN - a0);
+      } else {
+        equal__(lt, gt, d);
+        if (lt - a0 < aN - gt) {
+          mkqs__(a0, lt, d, limit);
+          a0 = gt;
+        } else {
+          mkqs__(gt, aN, d, limit);
+          aN = lt;
+        }
+      }
+    }
+    insertion_sort__(a0, aN, d);
+  }
+
+  /**
+   * @brief  キーの等しい部分配列[a0, aN)のうち、キーの中で終わる文字列を先頭に集めて整列する
+   * @note   キーの中で終わる文字列は続く文字列より小さく、長さの順に並びます。
+   *         続く文字列は深さを8バイト進めてキーを読み直します
+   * @return 続く文字列の先頭
+   */
+  item *advance__(item *a0, item *aN, std::size_t d) {
+    item *const aM = std::partition(
+        a0, aN, [d](const item &x) { return x.len <= d + 8; });
+    by_length__(a0, aM);
+    for (item *p = aM; p != aN; ++p) {
+      p->key = load__(*p, d + 8);
+    }
+    return aM;
+  }
+
+  /**< @brief キーの等しい部分配列[a0, aN)を整列する */
+  void equal__(item *a0, item *aN, std::size_t d) {
+    item *const aM = advance__(a0, aN, d);
+    if (aN - aM > 1) {
+      mkqs__(aM, aN, d + 8, depth_limit__(aN - aM));
+    }
+  }
+
+  /**< @brief 深さdまで等しく、その先のない文字列を長さの順に並べる */
+  static void by_length__(item *a0, item *aN) {
+    if (aN - a0 > 1) {
+      intro_sort(a0, aN, [](const item &x, const item &y) {
+        return x.len < y.len;
+      });
+    }
+  }
+
+  /**< @brief 深さdまで等しい部分配列[a0, aN)を挿入ソートする */
+  static void insertion_sort__(item *a0, item *aN, std::size_t d) {
+    for (item *j = a0 + 1; j < aN; ++j) {
+      const item key = *j;
+      item *i = j;
+      while (i != a0 && less__(key, *(i - 1), d)) {
+        *i = *(i - 1);
+        --i;
+      }
+      *i = key;
+    }
+  }
+};
+
+//********************************************************************************
+// 関数の定義
+//********************************************************************************
+
+/**
+ * @brief  文字列の配列をバイト単位の辞書順に整列します
+ * @tparam RandomAccessIterator       (ランダムアクセス)イテレータ
+ * @param  RandomAccessIterator a0    先頭イテレータ
+ * @param  RandomAccessIterator aN    末尾の次を指すイテレータ
+ */
+template <class RandomAccessIterator>
+inline void string_sort(RandomAccessIterator a0, RandomAccessIterator aN) {
+  if (std::distance(a0, aN) < 2) {
+    return;
+  }
+  StringSort<RandomAccessIterator> s;
+  s.sort__(a0, aN);
+}
+
+#endif // endif STRING_SORT_HPP
@@ -0,0 +1,281 @@
+/**
+ * @brief ソートのベンチマーク
+ * @note  入力の分布(乱数、整列済み、逆順、山型、少種類、のこぎり波、Zipf)と
+ *        要素型(int32, int64, double, 文字列, 128バイトのレコード)と要素数の組毎に、
+ *        各ソートの1要素あたりのサイクル数をCSVで標準出力に書き出します。
+ * @note  サイクル数はx86ではタイムスタンプカウンタ(rdtsc)、それ以外ではナノ秒です。
+ * @note  使い方: sort_benchmark [最大の要素数(既定 10^6)] [入力1つあたりの最大バイト数(既定 2^31)]
+ *        要素数は10から10倍ずつ最大の要素数まで増やします。
+ */
+
+#include "sort/adaptive_sort.hpp"
+#include "sort/intro_sort.hpp"
+#include "sort/radix_sort.hpp"
+#include "sort/stable_sort.hpp"
+#include "sort/string_sort.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+//********************************************************************************
+// 計測
+//********************************************************************************
+
+/**< @brief 現在のサイクル数(x86以外ではナノ秒) */
+std::uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+/**< @brief 1回の計測で整列する要素数の合計(小さな入力は何組も並べて計測する) */
+constexpr std::size_t batch_elements = 1000000;
+
+//********************************************************************************
+// 入力の分布
+//********************************************************************************
+
+/**< @brief 分布の名前と、要素数nの列を作る関数 */
+struct distribution {
+  const char *name;
+  std::vector<std::uint32_t> (*make)(std::size_t n, std::mt19937 &rng);
+};
+
+/**< @brief Zipf分布(s = 1)に従う順位を返す(順位の数は高々2^16) */
+std::vector<std::uint32_t> make_zipf(std::size_t n, std::mt19937 &rng) {
+  const std::size_t m = std::min<std::size_t>(n, 1 << 16);
+  std::vector<double> cdf(m);
+  double sum = 0.0;
+  for (std::size_t i = 0; i < m; i++) {
+    sum += 1.0 / static_cast<double>(i + 1);
+    cdf[i] = sum;
+  }
+  std::uniform_real_distribution<double> u(0.0, sum);
+  std::vector<std::uint32_t> v(n);
+  for (auto &x : v) {
+    x = static_cast<std::uint32_t>(
+        std::upper_bound(cdf.begin(), cdf.end() - 1, u(rng)) - cdf.begin());
+  }
+  return v;
+}
+
+const std::array<distribution, 7> distributions = {{
+    {"random",
+     [](std::size_t n, std::mt19937 &rng) {
+       std::vector<std::uint32_t> v(n);
+       for (auto &x : v) {
+         x = rng();
+       }
+       return v;
+     }},
+    {"sorted",
+     [](std::size_t n, std::mt19937 &) {
+       std::vector<std::uint32_t> v(n);
+       for (std::size_t i = 0; i < n; i++) {
+         v[i] = static_cast<std::uint32_t>(i);
+       }
+       return v;
+     }},
+    {"reversed",
+     [](std::size_t n, std::mt19937 &) {
+       std::vector<std::uint32_t> v(n);
+       for (std::size_t i = 0; i < n; i++) {
+         v[i] = static_cast<std::uint32_t>(n - i);
+       }
+       return v;
+     }},
+    {"organ_pipe",
+     [](std::size_t n, std::mt19937 &) {
+       std::vector<std::uint32_t> v(n);
+       for (std::size_t i = 0; i < n; i++) {
+         v[i] = static_cast<std::uint32_t>(std::min(i, n - i));
+       }
+       return v;
+     }},
+    {"few_unique",
+     [](std::size_t n, std::mt19937 &rng) {
+       std::vector<std::uint32_t> v(n);
+       for (auto &x : v) {
+         x = rng() % 16;
+       }
+       return v;
+     }},
+    {"sawtooth",
+     [](std::size_t n, std::mt19937 &) {
+       std::vector<std::uint32_t> v(n);
+       for (std::size_t i = 0; i < n; i++) {
+         v[i] = static_cast<std::uint32_t>(i % 1024);
+       }
+       return v;
+     }},
+    {"zipf", make_zipf},
+}};
+
+//********************************************************************************
+// 要素型
+//********************************************************************************
+
+/**< @brief 128バイトのレコード(キーは先頭の8バイト) */
+struct record {
+  std::uint64_t key;
+  char payload[120];
+};
+
+/**< @brief 要素型の名前と、分布の値から大小関係を保って要素を作る関数 */
+template <class T> struct element;
+
+template <> struct element<std::int32_t> {
+  static constexpr const char *name = "int32";
+  static std::int32_t make(std::uint32_t x) {
+    return static_cast<std::int32_t>(x - 0x80000000u);
+  }
+};
+template <> struct element<std::int64_t> {
+  static constexpr const char *name = "int64";
+  static std::int64_t make(std::uint32_t x) {
+    return static_cast<std::int64_t>(x) * 0x10001 - (std::int64_t(1) << 40);
+  }
+};
+template <> struct element<double> {
+  static constexpr const char *name = "double";
+  static double make(std::uint32_t x) { return static_cast<double>(x) * 0.25; }
+};
+template <> struct element<std::string> {
+  static constexpr const char *name = "string";
+  static std::string make(std::uint32_t x) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "assets/%010u", x); // 共通の接頭辞を持つ
+    return buf;
+  }
+};
+template <> struct element<record> {
+  static constexpr const char *name = "record128";
+  static record make(std::uint32_t x) {
+    record r{};
+    r.key = x;
+    return r;
+  }
+};
+
+/**< @brief 要素型毎の比較述語 */
+template <class T> auto compare() {
+  if constexpr (std::is_same_v<T, record>) {
+    return [](const record &x, const record &y) { return x.key < y.key; };
+  } else {
+    return std::less<T>();
+  }
+}
+
+//********************************************************************************
+// ソート
+//********************************************************************************
+
+/**
+ * @brief 要素型Tでソートalgoを計測してCSVの1行を書き出す
+ * @param batch 同じ入力をreps組並べた配列(計測前に毎回コピーします)
+ */
+template <class T, class Sort>
+void measure(const char *algo, const char *dist, std::size_t n,
+             const std::vector<T> &batch, Sort sort) {
+  std::vector<T> v = batch;
+  const std::size_t reps = batch.size() / n;
+  const std::uint64_t t0 = cycles();
+  for (std::size_t r = 0; r < reps; r++) {
+    sort(v.begin() + r * n, v.begin() + (r + 1) * n);
+  }
+  const std::uint64_t t1 = cycles();
+  for (std::size_t r = 0; r < reps; r++) {
+    if (!std::is_sorted(v.begin() + r * n, v.begin() + (r + 1) * n,
+                        compare<T>())) {
+      std::fprintf(stderr, "%s failed on %s/%s/%zu\n", algo, element<T>::name,
+                   dist, n);
+      std::exit(EXIT_FAILURE);
+    }
+  }
+  std::printf("%s,%s,%s,%zu,%.2f\n", algo, element<T>::name, dist, n,
+              static_cast<double>(t1 - t0) / static_cast<double>(reps * n));
+  std::fflush(stdout);
+}
+
+/**< @brief 要素型Tの全ての分布と要素数で各ソートを計測する */
+template <class T> void run(std::size_t max_n, std::size_t max_bytes) {
+  using iter_t = typename std::vector<T>::iterator;
+  const auto cmp = compare<T>();
+  std::mt19937 rng(2021);
+  for (std::size_t n = 10; n <= max_n; n *= 10) {
+    if (n * sizeof(T) > max_bytes) {
+      break;
+    }
+    for (const distribution &d : distributions) {
+      const std::vector<std::uint32_t> base = d.make(n, rng);
+      const std::size_t reps = std::max<std::size_t>(1, batch_elements / n);
+      std::vector<T> batch;
+      batch.reserve(reps * n);
+      for (std::size_t r = 0; r < reps; r++) {
+        for (const std::uint32_t x : base) {
+          batch.push_back(element<T>::make(x));
+        }
+      }
+
+      measure("std::sort", d.name, n, batch,
+              [&](iter_t a0, iter_t aN) { std::sort(a0, aN, cmp); });
+      measure("std::stable_sort", d.name, n, batch,
+              [&](iter_t a0, iter_t aN) { std::stable_sort(a0, aN, cmp); });
+      measure("intro_sort", d.name, n, batch,
+              [&](iter_t a0, iter_t aN) { intro_sort(a0, aN, cmp); });
+      measure("intro_sort/block", d.name, n, batch, [&](iter_t a0, iter_t aN) {
+        intro_sort(a0, aN, cmp, block_partition());
+      });
+      measure("adaptive_sort", d.name, n, batch,
+              [&](iter_t a0, iter_t aN) { adaptive_sort(a0, aN, cmp); });
+      measure("stable_merge_sort", d.name, n, batch,
+              [&](iter_t a0, iter_t aN) { stable_merge_sort(a0, aN, cmp); });
+      if constexpr (std::is_arithmetic_v<T>) {
+        measure("radix_sort", d.name, n, batch,
+                [&](iter_t a0, iter_t aN) { radix_sort(a0, aN); });
+      } else if constexpr (std::is_same_v<T, record>) {
+        measure("radix_sort", d.name, n, batch, [&](iter_t a0, iter_t aN) {
+          radix_sort(a0, aN, [](const record &x) { return x.key; });
+        });
+      } else {
+        measure("string_sort", d.name, n, batch,
+                [&](iter_t a0, iter_t aN) { string_sort(a0, aN); });
+      }
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::size_t max_n =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  const std::size_t max_bytes =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : std::size_t(1) << 31;
+  std::printf("algorithm,type,distribution,n,cycles_per_element\n");
+  run<std::int32_t>(max_n, max_bytes);
+  run<std::int64_t>(max_n, max_bytes);
+  run<double>(max_n, max_bytes);
+  run<std::string>(max_n, max_bytes);
+  run<record>(max_n, max_bytes);
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include "../sort_inputs.hpp"
+#include "sort/adaptive_sort.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+/**< @brief 整列済みに近い配列を作る */
+std::vector<std::vector<int>> make_near_sorted(std::size_t n,
+                                                std::mt19937 &rng) {
+  std::vector<int> sorted(n), jitter(n), runs(n);
+  for (std::size_t i = 0; i < n; i++) {
+    sorted[i] = static_cast<int>(i / 3); // 重複あり
+    jitter[i] = static_cast<int>(i * 10 + rng() % 15); // 時刻の揺らぎ
+  }
+  std::size_t i = 0; // 昇順と降順のランを交互に並べる
+  for (bool up = true; i < n; up = !up) {
+    const std::size_t len = 1 + rng() % 5000;
+    const int base = static_cast<int>(rng() % 100000);
+    for (std::size_t j = 0; j < len && i < n; j++, i++) {
+      runs[i] = up ? base + static_cast<int>(j) : base - static_cast<int>(j);
+    }
+  }
+  return {sorted, sort_inputs::reversed(n), jitter, runs,
+          sort_inputs::few_unique(n, rng, 1000)};
+}
+} // namespace
+
+TEST_CASE("Adaptive sort Test against std::sort") {
+  std::mt19937 rng(21);
+  for (const std::size_t n : {0, 1, 2, 31, 32, 33, 1000, 100000, 1000000}) {
+    for (auto v : make_near_sorted(n, rng)) {
+      auto expect = v;
+      std::sort(expect.begin(), expect.end());
+      adaptive_sort(v.begin(), v.end());
+      REQUIRE(v == expect);
+    }
+  }
+}
+
+TEST_CASE("Adaptive sort Merge keeps equal elements in order") {
+  struct event {
+    int time;
+    int seq;
+  };
+  auto by_time = [](const event &x, const event &y) { return x.time < y.time; };
+  std::mt19937 rng(22);
+  // ランの長い入力: 各ランは時刻の昇順、ランの間で時刻が重なる
+  std::vector<event> v;
+  for (int r = 0; r < 40; r++) {
+    int t = static_cast<int>(rng() % 100);
+    for (int j = 0; j < 2000; j++) {
+      t += static_cast<int>(rng() % 2);
+      v.push_back({t, static_cast<int>(v.size())});
+    }
+  }
+  auto expect = v;
+  std::stable_sort(expect.begin(), expect.end(), by_time);
+  adaptive_sort(v.begin(), v.end(), by_time);
+  for (std::size_t i = 0; i < v.size(); i++) {
+    REQUIRE(v[i].time == expect[i].time);
+    REQUIRE(v[i].seq == expect[i].seq);
+  }
+}
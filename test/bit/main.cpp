@@ -1,4 +1,5 @@
 #include "bit/bit.hpp"
+#include <cstdint>
 
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
@@ -34,3 +35,77 @@ TEST_CASE("Number of Leading Zero (NLZ)") {
   REQUIRE(bit::nlz(0b0000'0000'0000'0000'1000'0000'0000'1000) ==
           bit::nlz(0b1000'0000'0000'1000));
 }
+
+TEST_CASE("Population count and Number of Trailing Zero (NTZ)") {
+  REQUIRE(bit::popcount(std::uint8_t{0b1001'0110}) == 4);
+  REQUIRE(bit::popcount(~std::uint64_t{0}) == 64);
+  REQUIRE(bit::ntz(std::uint32_t{0b1000}) == 3);
+  REQUIRE(bit::ntz(std::uint64_t{0}) == 64);
+}
+
+TEST_CASE("Bit operations on every width") {
+  // 定数式では移植可能な実装で評価する
+  static_assert(bit::nlz(std::uint8_t{0x10}) == 3);
+  static_assert(bit::nlz(std::uint16_t{0}) == 16);
+  static_assert(bit::nlz(std::uint64_t{1} << 40) == 23);
+  static_assert(bit::ntz(std::uint16_t{0x8000}) == 15);
+  static_assert(bit::popcount(std::uint32_t{0xf0f0'0001}) == 9);
+  static_assert(bit::log2(std::uint64_t{1000}) == 9);
+  static_assert(bit::bit_ceil(std::uint16_t{257}) == 512);
+  static_assert(bit::bit_floor(std::uint8_t{255}) == 128);
+  static_assert(bit::pext(std::uint32_t{0b1011'0110}, 0b1111'0000u) == 0b1011);
+  static_assert(bit::pdep(std::uint32_t{0b1011}, 0b1111'0000u) == 0b1011'0000);
+  static_assert(bit::byteswap(std::uint32_t{0x1234'5678}) == 0x7856'3412);
+
+  // 実行時の実装と移植可能な実装を比べる
+  std::uint64_t x = 0x9e37'79b9'7f4a'7c15;
+  for (int i = 0; i < 10000; i++) {
+    x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+    const std::uint64_t v = x >> (i % 64), m = x * 0xbf58'476d'1ce4'e5b9;
+    const auto u8 = static_cast<std::uint8_t>(v);
+    const auto u16 = static_cast<std::uint16_t>(v);
+    const auto u32 = static_cast<std::uint32_t>(v);
+    REQUIRE(bit::nlz(u8) == bit::detail::nlz_portable(u8));
+    REQUIRE(bit::nlz(u16) == bit::detail::nlz_portable(u16));
+    REQUIRE(bit::nlz(u32) == bit::detail::nlz_portable(u32));
+    REQUIRE(bit::nlz(v) == bit::detail::nlz_portable(v));
+    REQUIRE(bit::ntz(u8) == bit::detail::ntz_portable(u8));
+    REQUIRE(bit::ntz(u16) == bit::detail::ntz_portable(u16));
+    REQUIRE(bit::ntz(u32) == bit::detail::ntz_portable(u32));
+    REQUIRE(bit::ntz(v) == bit::detail::ntz_portable(v));
+    REQUIRE(bit::popcount(u16) == bit::detail::popcount_portable(u16));
+    REQUIRE(bit::popcount(v) == bit::detail::popcount_portable(v));
+    REQUIRE(bit::pext(u32, static_cast<std::uint32_t>(m)) ==
+            bit::detail::pext_portable(u32, static_cast<std::uint32_t>(m)));
+    REQUIRE(bit::pext(v, m) == bit::detail::pext_portable(v, m));
+    REQUIRE(bit::pdep(u32, static_cast<std::uint32_t>(m)) ==
+            bit::detail::pdep_portable(u32, static_cast<std::uint32_t>(m)));
+    REQUIRE(bit::pdep(v, m) == bit::detail::pdep_portable(v, m));
+    const std::uint64_t low =
+        bit::popcount(m) == 64 ? ~std::uint64_t{0}
+                               : (std::uint64_t{1} << bit::popcount(m)) - 1;
+    REQUIRE(bit::pext(bit::pdep(v, m), m) == (v & low));
+    REQUIRE(bit::byteswap(u16) == bit::detail::byteswap_portable(u16));
+    REQUIRE(bit::byteswap(v) == bit::detail::byteswap_portable(v));
+  }
+}
+
+TEST_CASE("Power of two and logarithm") {
+  REQUIRE(bit::log2(std::uint32_t{0}) == -1);
+  REQUIRE(bit::log2(std::uint32_t{1}) == 0);
+  REQUIRE(bit::log2(~std::uint64_t{0}) == 63);
+  REQUIRE(bit::bit_floor(std::uint32_t{0}) == 0);
+  REQUIRE(bit::bit_ceil(std::uint32_t{0}) == 1);
+  REQUIRE(bit::bit_ceil(std::uint32_t{1}) == 1);
+  for (std::uint32_t v = 2; v < 5000; v++) {
+    const std::uint32_t c = bit::bit_ceil(v), f = bit::bit_floor(v);
+    REQUIRE(bit::popcount(c) == 1);
+    REQUIRE(bit::popcount(f) == 1);
+    REQUIRE(f <= v);
+    REQUIRE(v < 2 * f);
+    REQUIRE(c / 2 < v);
+    REQUIRE(v <= c);
+  }
+  REQUIRE(bit::byteswap(std::uint8_t{0xab}) == 0xab);
+  REQUIRE(bit::byteswap(std::uint16_t{0xabcd}) == 0xcdab);
+}
@@ -0,0 +1,84 @@
+#include "bit/bulk.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+std::vector<std::uint64_t> make_bits(std::size_t n, std::mt19937_64 &rng) {
+  std::vector<std::uint64_t> v(n);
+  for (auto &x : v) {
+    x = rng() & rng(); // 疎なビット列
+  }
+  return v;
+}
+
+std::size_t count(const std::vector<std::uint64_t> &v) {
+  std::size_t c = 0;
+  for (const std::uint64_t x : v) {
+    for (int i = 0; i < 64; i++) {
+      c += (x >> i) & 1;
+    }
+  }
+  return c;
+}
+} // namespace
+
+TEST_CASE("Bulk bit kernels Popcount") {
+  std::mt19937_64 rng(45);
+  // Harley-Seal法の1周(64語)の前後と端数
+  for (const std::size_t n : {0, 1, 3, 4, 5, 63, 64, 65, 127, 128, 1000, 4099}) {
+    const auto a = make_bits(n, rng);
+    const auto b = make_bits(n, rng);
+    std::vector<std::uint64_t> ab(n);
+    for (std::size_t i = 0; i < n; i++) {
+      ab[i] = a[i] & b[i];
+    }
+    REQUIRE(bit::bulk::popcount(a) == count(a));
+    REQUIRE(bit::bulk::and_popcount(a, b) == count(ab));
+    REQUIRE(bit::bulk::detail::popcount_scalar(a.data(), n) == count(a));
+#if defined(BIT_BULK_AVX2)
+    if (cpu::detect().has(cpu::avx2)) {
+      REQUIRE(bit::bulk::detail::popcount_avx2(a.data(), n) == count(a));
+      REQUIRE(bit::bulk::detail::and_popcount_avx2(a.data(), b.data(), n) ==
+              count(ab));
+    }
+#endif
+  }
+  const std::vector<std::uint64_t> full(1 << 16, ~std::uint64_t(0));
+  REQUIRE(bit::bulk::popcount(full) == (std::size_t(1) << 22));
+  REQUIRE(bit::bulk::and_popcount(full, full) == (std::size_t(1) << 22));
+}
+
+TEST_CASE("Bulk bit kernels In-place logical operations") {
+  std::mt19937_64 rng(46);
+  for (const std::size_t n : {0, 1, 4, 7, 1024, 1029}) {
+    const auto a = make_bits(n, rng);
+    const auto b = make_bits(n, rng);
+    auto x = a, y = a, z = a, w = a;
+    bit::bulk::assign_and(x, b);
+    bit::bulk::assign_or(y, b);
+    bit::bulk::assign_xor(z, b);
+    bit::bulk::assign_andnot(w, b);
+    for (std::size_t i = 0; i < n; i++) {
+      REQUIRE(x[i] == (a[i] & b[i]));
+      REQUIRE(y[i] == (a[i] | b[i]));
+      REQUIRE(z[i] == (a[i] ^ b[i]));
+      REQUIRE(w[i] == (a[i] & ~b[i]));
+    }
+    // 部分列にも使える
+    if (n > 3) {
+      auto v = a;
+      bit::bulk::assign_xor(std::span(v).subspan(1, n - 2),
+                            std::span(a).subspan(1, n - 2));
+      REQUIRE(v.front() == a.front());
+      REQUIRE(v.back() == a.back());
+      REQUIRE(bit::bulk::popcount(std::span(v).subspan(1, n - 2)) == 0);
+    }
+  }
+  std::vector<std::uint64_t> a(3), b(4);
+  REQUIRE_THROWS_AS(bit::bulk::assign_or(a, b), std::invalid_argument);
+  REQUIRE_THROWS_AS(bit::bulk::and_popcount(a, b), std::invalid_argument);
+}
@@ -0,0 +1,88 @@
+#include "cpu/cpu_features.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+std::int64_t sum_scalar(const std::int32_t *a, std::size_t n) {
+  std::int64_t s = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    s += a[i];
+  }
+  return s;
+}
+
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+CPU_TARGET("avx2")
+std::int64_t sum_avx2(const std::int32_t *a, std::size_t n) {
+  __m256i s = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i x =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    s = _mm256_add_epi64(s, _mm256_cvtepi32_epi64(x));
+  }
+  alignas(32) std::int64_t lane[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lane), s);
+  return lane[0] + lane[1] + lane[2] + lane[3] + sum_scalar(a + i, n - i);
+}
+#endif
+} // namespace
+
+TEST_CASE("CPU features Detection") {
+  const cpu::features f = cpu::detect();
+  REQUIRE((cpu::current().bits() & ~f.bits()) == 0); // 無効にするだけ
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+  __builtin_cpu_init();
+  REQUIRE(f.has(cpu::ssse3) == !!__builtin_cpu_supports("ssse3"));
+  REQUIRE(f.has(cpu::sse42) == !!__builtin_cpu_supports("sse4.2"));
+  REQUIRE(f.has(cpu::popcnt) == !!__builtin_cpu_supports("popcnt"));
+  REQUIRE(f.has(cpu::avx2) == !!__builtin_cpu_supports("avx2"));
+  REQUIRE(f.has(cpu::bmi2) == !!__builtin_cpu_supports("bmi2"));
+  REQUIRE(f.has(cpu::avx512f) == !!__builtin_cpu_supports("avx512f"));
+#endif
+#if defined(__AVX2__)
+  REQUIRE(f.has(cpu::avx | cpu::avx2)); // コンパイルオプションで有効なら実行できる
+#endif
+}
+
+TEST_CASE("CPU features Parse and format") {
+  REQUIRE(cpu::parse("") == cpu::none);
+  REQUIRE(cpu::parse("avx2") == cpu::avx2);
+  REQUIRE(cpu::parse(" avx512f , avx2,unknown,") == (cpu::avx512f | cpu::avx2));
+  REQUIRE(cpu::parse("all") == ~std::uint32_t(0));
+  REQUIRE(cpu::features(cpu::sse42 | cpu::sha).to_string() == "sse42,sha");
+  REQUIRE(cpu::features(cpu::parse("bmi1,bmi2")).has(cpu::bmi2));
+  REQUIRE_FALSE(cpu::features(cpu::bmi1).has(cpu::bmi1 | cpu::bmi2));
+}
+
+TEST_CASE("CPU features Dispatcher") {
+  using sum_t = cpu::dispatcher<std::int64_t(const std::int32_t *, std::size_t)>;
+  std::vector<std::int32_t> a(1003);
+  std::iota(a.begin(), a.end(), -500);
+  const std::int64_t expect = sum_scalar(a.data(), a.size());
+
+  // 機能を指定して、それぞれの実装を選ばせる
+  const sum_t scalar({{cpu::avx2, nullptr}, {cpu::none, sum_scalar}},
+                     cpu::features(cpu::none));
+  REQUIRE(scalar.get() == &sum_scalar);
+  REQUIRE(scalar(a.data(), a.size()) == expect);
+#if defined(CPU_FEATURES_X86) && defined(__GNUC__)
+  const sum_t masked({{cpu::avx2, sum_avx2}, {cpu::none, sum_scalar}},
+                     cpu::features(cpu::detect().bits() & ~cpu::avx2));
+  REQUIRE(masked.get() == &sum_scalar);
+  const sum_t best = {{cpu::avx2, sum_avx2}, {cpu::none, sum_scalar}};
+  REQUIRE((best.get() == &sum_avx2) == cpu::current().has(cpu::avx2));
+  REQUIRE(best(a.data(), a.size()) == expect);
+#endif
+  REQUIRE_THROWS_AS(sum_t({{cpu::sha, sum_scalar}}, cpu::features()),
+                    std::invalid_argument);
+}
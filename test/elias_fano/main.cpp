@@ -0,0 +1,82 @@
+#include "container/elias_fano.hpp"
+#include "container/rank_select_bitvector.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Rank/select bitvector Test against brute force") {
+  std::mt19937_64 rng(3);
+  for (const std::size_t n : {0, 1, 63, 64, 65, 511, 512, 513, 5000, 70000}) {
+    for (const double density : {0.0, 0.01, 0.5, 0.99, 1.0}) {
+      std::bernoulli_distribution coin(density);
+      container::rank_select_bitvector bv(n);
+      std::vector<bool> ref(n);
+      for (std::size_t i = 0; i < n; i++) {
+        if (coin(rng)) {
+          bv.set(i);
+          ref[i] = true;
+        }
+      }
+      bv.build();
+      std::size_t ones = 0, zeros = 0;
+      for (std::size_t i = 0; i < n; i++) {
+        REQUIRE(bv.rank1(i) == ones);
+        REQUIRE(bv[i] == ref[i]);
+        if (ref[i]) {
+          REQUIRE(bv.select1(ones) == i);
+          ones++;
+        } else {
+          REQUIRE(bv.select0(zeros) == i);
+          zeros++;
+        }
+      }
+      REQUIRE(bv.rank1(n) == ones);
+      REQUIRE(bv.ones() == ones);
+    }
+  }
+}
+
+TEST_CASE("Elias-Fano Access NextGEQ Iteration Test") {
+  std::mt19937_64 rng(5);
+  for (const std::uint64_t u : {1ULL, 1000ULL, 1ULL << 20, 1ULL << 40}) {
+    std::uniform_int_distribution<std::uint64_t> dist(0, u);
+    std::vector<std::uint64_t> xs(3000);
+    for (auto &&x : xs) {
+      x = dist(rng);
+    }
+    std::sort(xs.begin(), xs.end()); // 重複も含む
+    const container::elias_fano ef(xs.begin(), xs.end(), u);
+    REQUIRE(ef.size() == xs.size());
+    for (std::size_t i = 0; i < xs.size(); i++) {
+      REQUIRE(ef[i] == xs[i]);
+    }
+    REQUIRE(std::equal(ef.begin(), ef.end(), xs.begin(), xs.end()));
+    for (int t = 0; t < 2000; t++) {
+      const std::uint64_t x = dist(rng);
+      const auto it = std::lower_bound(xs.begin(), xs.end(), x);
+      const auto jt = ef.next_geq(x);
+      if (it == xs.end()) {
+        REQUIRE(jt == ef.end());
+      } else {
+        REQUIRE(jt.index() == static_cast<std::size_t>(it - xs.begin()));
+        REQUIRE(*jt == *it);
+      }
+    }
+    REQUIRE(ef.next_geq(xs.front()).index() == 0);
+  }
+}
+
+TEST_CASE("Elias-Fano Space Test") {
+  std::vector<std::uint64_t> xs(100000);
+  for (std::size_t i = 0; i < xs.size(); i++) {
+    xs[i] = i * 16 + (i % 7); // 平均間隔16(l = 4)
+  }
+  const container::elias_fano ef(xs.begin(), xs.end());
+  // 上位2ビット + 下位4ビットに、索引分の余裕を見込む
+  REQUIRE(ef.bytes() * 8 < xs.size() * 8);
+  REQUIRE(ef.next_geq(xs.back() + 1) == ef.end());
+  REQUIRE(*ef.next_geq(17) == 17);
+}
@@ -0,0 +1,84 @@
+#include "bit/endian.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+/**< @brief 1バイトずつ組み立てるビッグエンディアンの読み込み */
+template <class T> T load_reference(const std::uint8_t *p) {
+  T v = 0;
+  for (std::size_t i = 0; i < sizeof(T); i++) {
+    v = static_cast<T>((v << 8) | p[i]);
+  }
+  return v;
+}
+
+template <class T> void check_bulk(std::mt19937 &rng) {
+  for (const std::size_t n : {0, 1, 7, 8, 9, 31, 32, 33, 100, 1000}) {
+    std::vector<std::uint8_t> bytes(n * sizeof(T) + 3);
+    for (auto &b : bytes) {
+      b = static_cast<std::uint8_t>(rng());
+    }
+    // アラインメントのずれた位置から読む
+    const std::span<const std::uint8_t> in =
+        std::span(bytes).subspan(3, n * sizeof(T));
+    std::vector<T> words(n);
+    bit::load_be(in, std::span(words));
+    for (std::size_t i = 0; i < n; i++) {
+      REQUIRE(words[i] == load_reference<T>(in.data() + i * sizeof(T)));
+      REQUIRE(words[i] == bit::load_be<T>(in.data() + i * sizeof(T)));
+    }
+    std::vector<std::uint8_t> out(n * sizeof(T));
+    bit::store_be(std::span(words), std::span(out));
+    REQUIRE(std::equal(out.begin(), out.end(), in.begin()));
+
+    auto swapped = words;
+    bit::byteswap(std::span(swapped));
+    for (std::size_t i = 0; i < n; i++) {
+      REQUIRE(swapped[i] == bit::byteswap(words[i]));
+    }
+#if defined(BIT_ENDIAN_SIMD)
+    const auto f = cpu::detect();
+    std::vector<T> simd(n);
+    auto *const dst = reinterpret_cast<std::uint8_t *>(simd.data());
+    if (f.has(cpu::ssse3)) {
+      bit::detail::byteswap_copy_ssse3<T>(in.data(), dst, n);
+      REQUIRE(simd == words);
+    }
+    if (f.has(cpu::avx2)) {
+      bit::detail::byteswap_copy_avx2<T>(in.data(), dst, n);
+      REQUIRE(simd == words);
+    }
+#endif
+  }
+}
+} // namespace
+
+TEST_CASE("Endian Single values") {
+  const std::uint8_t b[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+  REQUIRE(bit::load_be<std::uint16_t>(b) == 0x0102);
+  REQUIRE(bit::load_be<std::uint32_t>(b + 1) == 0x02030405);
+  REQUIRE(bit::load_be<std::uint64_t>(b) == 0x0102030405060708);
+  REQUIRE(bit::load_le<std::uint32_t>(b) == 0x04030201);
+  std::uint8_t out[8] = {};
+  bit::store_be<std::uint32_t>(out + 2, 0xdeadbeef);
+  REQUIRE(out[2] == 0xde);
+  REQUIRE(out[5] == 0xef);
+  bit::store_le<std::uint16_t>(out, 0xabcd);
+  REQUIRE(out[0] == 0xcd);
+  REQUIRE(out[1] == 0xab);
+}
+
+TEST_CASE("Endian Bulk conversion") {
+  std::mt19937 rng(48);
+  check_bulk<std::uint16_t>(rng);
+  check_bulk<std::uint32_t>(rng);
+  check_bulk<std::uint64_t>(rng);
+  std::vector<std::uint8_t> bytes(7);
+  std::vector<std::uint32_t> words(2);
+  REQUIRE_THROWS_AS(bit::load_be(bytes, std::span(words)),
+                    std::invalid_argument);
+}
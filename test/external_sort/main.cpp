@@ -0,0 +1,127 @@
+#include "sort/external_sort.hpp"
+#include <algorithm>
+#include <boost/asio/thread_pool.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+/**< @brief 固定長のイベントレコード */
+struct event {
+  std::uint64_t time;
+  std::uint32_t id;
+  std::uint32_t kind;
+};
+
+bool by_time(const event &x, const event &y) {
+  return x.time < y.time || (x.time == y.time && x.id < y.id);
+}
+
+/**< @brief テスト毎の作業ディレクトリ */
+struct workdir {
+  std::filesystem::path path;
+  explicit workdir(const char *name)
+      : path(std::filesystem::temp_directory_path() / name) {
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+  }
+  ~workdir() { std::filesystem::remove_all(path); }
+};
+
+template <class T>
+void save(const std::filesystem::path &path, const std::vector<T> &v) {
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T));
+}
+
+template <class T> std::vector<T> load(const std::filesystem::path &path) {
+  std::vector<T> v(std::filesystem::file_size(path) / sizeof(T));
+  std::ifstream in(path, std::ios::binary);
+  in.read(reinterpret_cast<char *>(v.data()), v.size() * sizeof(T));
+  return v;
+}
+
+/**< @brief ランを多数作り、複数回のマージになる小さな設定 */
+external_sort_options small_options(const std::filesystem::path &dir) {
+  external_sort_options options;
+  options.memory_budget = 64 << 10;
+  options.io_block = 8 << 10; // マージの次数は3
+  options.temp_dir = dir;
+  return options;
+}
+} // namespace
+
+TEST_CASE("External sort Test against std::sort") {
+  const workdir dir("external_sort_test");
+  std::mt19937_64 rng(21);
+  for (const std::size_t n : {0, 1, 1000, 4096, 200000}) {
+    std::vector<event> v(n);
+    for (std::uint32_t i = 0; i < n; i++) {
+      v[i] = {rng() % 100000, i, static_cast<std::uint32_t>(rng())};
+    }
+    const auto input = dir.path / "events.bin";
+    const auto output = dir.path / "sorted.bin";
+    save(input, v);
+    external_sort<event>(input, output, by_time, small_options(dir.path));
+    std::sort(v.begin(), v.end(), by_time);
+    const auto sorted = load<event>(output);
+    REQUIRE(sorted.size() == v.size());
+    REQUIRE(std::equal(v.begin(), v.end(), sorted.begin(),
+                       [](const event &x, const event &y) {
+                         return x.time == y.time && x.id == y.id &&
+                                x.kind == y.kind;
+                       }));
+    // 一時ファイルは残らない
+    std::size_t files = 0;
+    for (const auto &e : std::filesystem::directory_iterator(dir.path)) {
+      files += e.path().extension() == ".run";
+    }
+    REQUIRE(files == 0);
+  }
+}
+
+TEST_CASE("External sort Parallel runs and in-place output") {
+  const workdir dir("external_sort_parallel_test");
+  std::mt19937 rng(22);
+  std::vector<std::uint32_t> v(300000);
+  for (auto &x : v) {
+    x = static_cast<std::uint32_t>(rng());
+  }
+  const auto path = dir.path / "keys.bin";
+  save(path, v);
+  boost::asio::thread_pool pool(4);
+  auto options = small_options(dir.path);
+  options.memory_budget = 256 << 10;
+  external_sort<std::uint32_t>(path, path, std::greater<std::uint32_t>(),
+                               options, pool);
+  pool.join();
+  std::sort(v.begin(), v.end(), std::greater<std::uint32_t>());
+  REQUIRE(load<std::uint32_t>(path) == v);
+
+  std::vector<double> d(5000);
+  for (auto &x : d) {
+    x = static_cast<double>(rng()) / 7.0;
+  }
+  save(path, d);
+  external_sort<double>(path, path); // 既定の設定
+  std::sort(d.begin(), d.end());
+  REQUIRE(load<double>(path) == d);
+}
+
+TEST_CASE("External sort Errors") {
+  const workdir dir("external_sort_error_test");
+  const auto path = dir.path / "broken.bin";
+  save(path, std::vector<char>(10)); // レコード長の倍数でない
+  REQUIRE_THROWS_AS(external_sort<event>(path, dir.path / "out.bin", by_time,
+                                         small_options(dir.path)),
+                    std::invalid_argument);
+  REQUIRE_THROWS_AS(external_sort<event>(dir.path / "missing.bin",
+                                         dir.path / "out.bin", by_time,
+                                         small_options(dir.path)),
+                    std::system_error);
+}
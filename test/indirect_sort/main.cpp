@@ -0,0 +1,97 @@
+#include "sort/indirect_sort.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+/**< @brief std::stable_sortで求めた置換 */
+template <class T, class Compare = std::less<T>>
+std::vector<std::size_t> expected_indices(const std::vector<T> &keys,
+                                          Compare cmp = Compare()) {
+  std::vector<std::size_t> perm(keys.size());
+  std::iota(perm.begin(), perm.end(), 0);
+  std::stable_sort(perm.begin(), perm.end(), [&](std::size_t i, std::size_t j) {
+    return cmp(keys[i], keys[j]);
+  });
+  return perm;
+}
+} // namespace
+
+TEST_CASE("Sort indices Test against std::stable_sort") {
+  std::mt19937_64 rng(31);
+  for (const std::size_t n : {0, 1, 2, 17, 1000, 100000}) {
+    std::vector<std::int32_t> i32(n);
+    std::vector<std::uint8_t> u8(n);
+    std::vector<double> f64(n);
+    std::vector<std::string> str(n);
+    for (std::size_t i = 0; i < n; i++) {
+      i32[i] = static_cast<std::int32_t>(rng() % 2000) - 1000;
+      u8[i] = static_cast<std::uint8_t>(rng());
+      f64[i] = static_cast<double>(rng() % 500) - 250.5;
+      str[i] = std::to_string(rng() % 300);
+    }
+    REQUIRE(sort_indices(i32) == expected_indices(i32));
+    REQUIRE(sort_indices(u8) == expected_indices(u8));
+    REQUIRE(sort_indices(f64) == expected_indices(f64));
+    REQUIRE(sort_indices(str) == expected_indices(str));
+    REQUIRE(sort_indices(i32, std::greater<std::int32_t>()) ==
+            expected_indices(i32, std::greater<std::int32_t>()));
+  }
+}
+
+TEST_CASE("Sort by key Test with several value columns") {
+  struct payload {
+    std::array<char, 256> bytes;
+  };
+  std::mt19937 rng(32);
+  const std::size_t n = 20000;
+  std::vector<std::uint32_t> keys(n);
+  std::vector<payload> big(n);
+  std::vector<std::string> names(n);
+  std::vector<double> scores(n);
+  for (std::size_t i = 0; i < n; i++) {
+    keys[i] = rng() % 1000;
+    big[i].bytes.fill(static_cast<char>(i));
+    big[i].bytes[0] = static_cast<char>(keys[i]);
+    names[i] = std::to_string(i);
+    scores[i] = static_cast<double>(keys[i]) * 0.5;
+  }
+  const auto perm = expected_indices(keys);
+  const auto names0 = names;
+  sort_by_key(keys, big, names, scores);
+  REQUIRE(std::is_sorted(keys.begin(), keys.end()));
+  for (std::size_t i = 0; i < n; i++) {
+    REQUIRE(names[i] == names0[perm[i]]);
+    REQUIRE(big[i].bytes[0] == static_cast<char>(keys[i]));
+    REQUIRE(big[i].bytes[1] == static_cast<char>(perm[i]));
+    REQUIRE(scores[i] == static_cast<double>(keys[i]) * 0.5);
+  }
+
+  // 比較述語を渡す
+  std::vector<std::string> words = {"pear", "fig", "apple", "kiwi", "banana"};
+  std::vector<int> lens = {4, 3, 5, 4, 6};
+  sort_by_key(
+      words,
+      [](const std::string &x, const std::string &y) {
+        return x.size() < y.size();
+      },
+      lens);
+  REQUIRE(words == std::vector<std::string>{"fig", "pear", "kiwi", "apple",
+                                            "banana"});
+  REQUIRE(lens == std::vector<int>{3, 4, 4, 5, 6});
+
+  std::vector<int> only = {3, 1, 2}; // 値の列なし
+  sort_by_key(only);
+  REQUIRE(only == std::vector<int>{1, 2, 3});
+
+  std::vector<int> shorter(2);
+  REQUIRE_THROWS_AS(sort_by_key(only, shorter), std::invalid_argument);
+}
@@ -0,0 +1,158 @@
+#include "../sort_inputs.hpp"
+#include "sort/intro_select.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Intro select Test against std::sort") {
+  std::mt19937 rng(11);
+  for (const std::size_t n : {1, 2, 15, 16, 17, 1000, 100000}) {
+    for (const auto &input : sort_inputs::make_inputs(n, rng)) {
+      auto expect = input;
+      std::sort(expect.begin(), expect.end());
+      for (const std::size_t k : {std::size_t(0), n / 3, n / 2, n - 1}) {
+        auto v = input;
+        intro_select(v.begin(), v.begin() + k, v.end());
+        REQUIRE(v[k] == expect[k]);
+        for (std::size_t i = 0; i < k; i++) {
+          REQUIRE(!(v[k] < v[i]));
+        }
+        for (std::size_t i = k + 1; i < n; i++) {
+          REQUIRE(!(v[i] < v[k]));
+        }
+      }
+    }
+  }
+  std::vector<int> v; // 空の配列
+  intro_select(v.begin(), v.end(), v.end());
+  REQUIRE(v.empty());
+}
+
+TEST_CASE("Intro select Linear comparisons on adversarial inputs") {
+  const std::size_t n = 1 << 16;
+  std::vector<std::vector<int>> inputs;
+  std::vector<int> sawtooth(n), killer(n);
+  for (std::size_t i = 0; i < n; i++) {
+    sawtooth[i] = static_cast<int>(i % 64);
+  }
+  // 3要素中央値の先頭と中央と末尾に小さい値が集まる配列
+  for (std::size_t i = 0; i < n; i++) {
+    killer[i] = static_cast<int>(i & 1 ? n / 2 + i : i);
+  }
+  for (const auto &input : {sawtooth, killer}) {
+    auto expect = input;
+    std::sort(expect.begin(), expect.end());
+    for (const std::size_t k : {n / 4, n / 2, n - 10}) {
+      auto v = input;
+      std::size_t count = 0;
+      intro_select(v.begin(), v.begin() + k, v.end(),
+                   [&](int x, int y) { return ++count, x < y; });
+      REQUIRE(v[k] == expect[k]);
+      REQUIRE(count < 32 * n);
+    }
+  }
+}
+
+TEST_CASE("Intro select Linear comparisons against an adaptive adversary") {
+  // McIlroy, "A Killer Adversary for Quicksort": 比較されるまで値を決めず、
+  // ピボットになりそうな要素ほど小さい値に固めて分割を偏らせ続ける
+  for (const std::size_t n : {std::size_t(1) << 12, std::size_t(1) << 16}) {
+    std::vector<int> val(n, static_cast<int>(n)); // nは未定(gas)
+    int solid = 0, candidate = -1;
+    std::size_t count = 0;
+    auto cmp = [&](int x, int y) {
+      count++;
+      const int gas = static_cast<int>(n);
+      if (val[x] == gas && val[y] == gas) {
+        val[x == candidate ? x : y] = solid++;
+      }
+      if (val[x] == gas) {
+        candidate = x;
+      } else if (val[y] == gas) {
+        candidate = y;
+      }
+      return val[x] < val[y];
+    };
+    std::vector<int> v(n);
+    for (std::size_t i = 0; i < n; i++) {
+      v[i] = static_cast<int>(i);
+    }
+    intro_select(v.begin(), v.begin() + n / 2, v.end(), cmp);
+    const std::size_t selecting = count;
+    for (std::size_t i = 0; i < n / 2; i++) {
+      REQUIRE(!cmp(v[n / 2], v[i]));
+    }
+    for (std::size_t i = n / 2 + 1; i < n; i++) {
+      REQUIRE(!cmp(v[i], v[n / 2]));
+    }
+    INFO("n = " << n << ", comparisons = " << selecting);
+    REQUIRE(selecting < 24 * n);
+  }
+}
+
+TEST_CASE("Intro partial sort Test against std::partial_sort") {
+  std::mt19937 rng(12);
+  for (const std::size_t n : {0, 1, 17, 1000, 100000}) {
+    for (const auto &input : sort_inputs::make_inputs(n, rng)) {
+      for (const std::size_t m : {std::size_t(0), std::size_t(1), n / 10, n}) {
+        if (m > n) {
+          continue;
+        }
+        auto v = input, expect = input;
+        std::partial_sort(expect.begin(), expect.begin() + m, expect.end(),
+                          std::greater<int>());
+        intro_partial_sort(v.begin(), v.begin() + m, v.end(),
+                           std::greater<int>());
+        REQUIRE(std::equal(v.begin(), v.begin() + m, expect.begin()));
+      }
+    }
+  }
+  std::vector<std::string> s(3000);
+  for (auto &x : s) {
+    x = std::to_string(rng() % 500);
+  }
+  auto expect = s;
+  std::sort(expect.begin(), expect.end());
+  intro_partial_sort(s.begin(), s.begin() + 100, s.end());
+  REQUIRE(std::equal(s.begin(), s.begin() + 100, expect.begin()));
+}
+
+TEST_CASE("Top-k Test against std::sort") {
+  std::mt19937 rng(13);
+  std::vector<int> v(100000);
+  for (auto &x : v) {
+    x = static_cast<int>(rng() % 50000);
+  }
+  auto expect = v;
+  std::sort(expect.begin(), expect.end(), std::greater<int>());
+
+  top_k<int> best(100);
+  for (const int x : v) { // 1要素ずつ流し込む
+    best.push(x);
+  }
+  REQUIRE(best.size() == 100);
+  REQUIRE(best.threshold() == expect[99]);
+  const auto result = best.sorted();
+  REQUIRE(std::equal(result.begin(), result.end(), expect.begin()));
+
+  top_k<int, std::greater<int>> worst(10); // 小さい方の10個
+  worst.push(v.begin(), v.end());
+  std::sort(expect.begin(), expect.end());
+  const auto low = worst.sorted();
+  REQUIRE(std::equal(low.begin(), low.end(), expect.begin()));
+
+  top_k<int> few(5);
+  few.push(v.begin(), v.begin() + 3);
+  REQUIRE(few.size() == 3);
+  few.clear();
+  REQUIRE(few.size() == 0);
+  top_k<int> none(0);
+  none.push(v.begin(), v.end());
+  REQUIRE(none.size() == 0);
+}
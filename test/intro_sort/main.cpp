@@ -0,0 +1,214 @@
+#include "../sort_inputs.hpp"
+#include "sort/intro_sort.hpp"
+#include "sort/parallel_intro_sort.hpp"
+#include <algorithm>
+#include <bit>
+#include <boost/asio/thread_pool.hpp>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Intro sort Test against std::sort") {
+  std::mt19937 rng(5);
+  for (const std::size_t n : {0, 1, 2, 15, 16, 17, 1000, 100000}) {
+    for (auto v : sort_inputs::make_inputs(n, rng)) {
+      auto expect = v;
+      std::sort(expect.begin(), expect.end());
+      intro_sort(v.begin(), v.end());
+      REQUIRE(v == expect);
+    }
+  }
+}
+
+TEST_CASE("Intro sort Block partition Test against std::sort") {
+  std::mt19937 rng(6);
+  for (const std::size_t n : {0, 1, 2, 15, 16, 17, 100, 1000, 100000}) {
+    for (auto v : sort_inputs::make_inputs(n, rng)) {
+      auto expect = v;
+      std::sort(expect.begin(), expect.end());
+      intro_sort(v.begin(), v.end(), std::less<int>(), block_partition());
+      REQUIRE(v == expect);
+    }
+  }
+  std::vector<std::string> s(5000);
+  for (auto &x : s) {
+    x = std::to_string(rng() % 1000);
+  }
+  auto expect = s;
+  std::sort(expect.begin(), expect.end());
+  intro_sort(s.begin(), s.end(), std::less<std::string>(), block_partition());
+  REQUIRE(s == expect);
+}
+
+TEST_CASE("Intro sort Three-way partition Test with few distinct keys") {
+  struct row {
+    int region;
+    int id;
+  };
+  auto by_region = [](const row &x, const row &y) {
+    return x.region < y.region;
+  };
+  std::mt19937 rng(8);
+  for (const int k : {1, 2, 3, 300}) {
+    std::vector<row> v(200000);
+    for (int i = 0; i < static_cast<int>(v.size()); i++) {
+      v[i] = {static_cast<int>(rng() % k), i};
+    }
+    auto w = v;
+    intro_sort(v.begin(), v.end(), by_region);
+    intro_sort(w.begin(), w.end(), by_region, block_partition());
+    REQUIRE(std::is_sorted(v.begin(), v.end(), by_region));
+    REQUIRE(std::is_sorted(w.begin(), w.end(), by_region));
+  }
+  std::vector<long> v(100000);
+  for (auto &x : v) {
+    x = static_cast<long>(rng() % 5);
+  }
+  auto expect = v;
+  std::sort(expect.begin(), expect.end());
+  intro_sort(v.begin(), v.end());
+  REQUIRE(v == expect);
+}
+
+TEST_CASE("Intro sort Arithmetic types Test against std::sort") {
+  std::mt19937_64 rng(9);
+  auto check = [&](auto zero) {
+    using T = decltype(zero);
+    for (const std::size_t n : {2, 5, 8, 9, 15, 16, 1000, 100000}) {
+      std::vector<T> v(n);
+      for (auto &x : v) {
+        x = static_cast<T>(rng() % 1000) - static_cast<T>(500);
+      }
+      auto u = v, w = v;
+      auto expect = v;
+      std::sort(expect.begin(), expect.end());
+      intro_sort(v.begin(), v.end());
+      intro_sort(u.begin(), u.end(), std::less<T>(), block_partition());
+      REQUIRE(v == expect);
+      REQUIRE(u == expect);
+      std::reverse(expect.begin(), expect.end());
+      intro_sort(w.begin(), w.end(), std::greater<T>());
+      REQUIRE(w == expect);
+    }
+  };
+  check(std::int32_t());
+  check(std::uint32_t());
+  check(float());
+  check(std::int64_t());
+  check(std::uint64_t());
+  check(double());
+}
+
+TEMPLATE_TEST_CASE("Sorting network Test with signed zeros and NaN", "", float,
+                   double) {
+  using T = TestType;
+  using bits_t = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+  const T nan = std::numeric_limits<T>::quiet_NaN();
+  const T inf = std::numeric_limits<T>::infinity();
+  const std::vector<T> pool = {T(0), -T(0), T(1), T(-1), inf, -inf, nan};
+  // 比較で順序の付かない要素もビット列としては1つも失われないこと
+  auto bits = [](const std::vector<T> &v) {
+    std::vector<bits_t> b;
+    for (const T x : v) {
+      b.push_back(std::bit_cast<bits_t>(x));
+    }
+    std::sort(b.begin(), b.end());
+    return b;
+  };
+  auto check = [&](auto sort, auto cmp, bool with_nan) {
+    std::mt19937 rng(3);
+    for (int t = 0; t < 2000; t++) {
+      std::vector<T> v(rng() % 17);
+      for (auto &&x : v) {
+        x = pool[rng() % (with_nan ? pool.size() : pool.size() - 1)];
+      }
+      const auto expect = bits(v);
+      sort(v);
+      REQUIRE(bits(v) == expect);
+      if (!with_nan) {
+        REQUIRE(std::is_sorted(v.begin(), v.end(), cmp));
+      }
+    }
+  };
+  using less_t = SortingNetwork<T, std::less<T>>;
+  using greater_t = SortingNetwork<T, std::greater<T>>;
+  for (const bool with_nan : {false, true}) {
+    check([](auto &v) { less_t::sort(v.data(), v.size()); }, std::less<T>(),
+          with_nan);
+    check([](auto &v) { greater_t::sort(v.data(), v.size()); },
+          std::greater<T>(), with_nan);
+    check([](auto &v) { less_t::sort_scalar__(v.data(), v.size()); },
+          std::less<T>(), with_nan);
+    if (cpu::current().has(cpu::avx2)) {
+      check([](auto &v) { less_t::sort_avx2__(v.data(), v.size()); },
+            std::less<T>(), with_nan);
+      check([](auto &v) { greater_t::sort_avx2__(v.data(), v.size()); },
+            std::greater<T>(), with_nan);
+    }
+  }
+  check([](auto &v) { intro_sort(v.begin(), v.end()); }, std::less<T>(), false);
+}
+
+TEST_CASE("Parallel intro sort Test against std::sort") {
+  std::mt19937 rng(7);
+  boost::asio::thread_pool pool(4);
+  for (const std::size_t n : {0, 1, 1000, 100000, 1000000}) {
+    for (auto v : sort_inputs::make_inputs(n, rng)) {
+      auto expect = v;
+      std::sort(expect.begin(), expect.end(), std::greater<int>());
+      parallel_intro_sort(v.begin(), v.end(), std::greater<int>(), pool, 256);
+      REQUIRE(v == expect);
+    }
+  }
+  std::vector<int> v = sort_inputs::random(200000, rng);
+  auto expect = v;
+  std::sort(expect.begin(), expect.end());
+  parallel_intro_sort(v.begin(), v.end(), pool);
+  REQUIRE(v == expect);
+  pool.join();
+}
+
+TEST_CASE("Parallel intro sort Parallel partition Test") {
+  std::mt19937 rng(13);
+  boost::asio::thread_pool pool(4);
+  // 分割を並列に行う上の段で、偏った分割や重複の多い入力を確かめる
+  const std::size_t n = 300000;
+  std::vector<std::vector<int>> inputs = sort_inputs::make_inputs(n, rng);
+  inputs.emplace_back(n, 7); // すべて等しい
+  std::vector<int> v(n);
+  for (std::size_t i = 0; i < n; i++) {
+    v[i] = i % 100 == 0 ? static_cast<int>(i) : 0; // 最小値が大半を占める
+  }
+  inputs.push_back(v);
+  for (auto &x : v) {
+    x = static_cast<int>(rng() % 3);
+  }
+  inputs.push_back(v);
+  for (auto v : inputs) {
+    auto expect = v;
+    std::sort(expect.begin(), expect.end());
+    parallel_intro_sort(v.begin(), v.end(), std::less<int>(), pool, 64);
+    REQUIRE(v == expect);
+  }
+  pool.join();
+}
+
+TEST_CASE("Parallel intro sort Test from a pool thread") {
+  std::mt19937 rng(11);
+  std::vector<int> v = sort_inputs::random(200000, rng);
+  auto expect = v;
+  std::sort(expect.begin(), expect.end());
+  // 唯一のスレッドが呼び出し元として待つので、呼び出し元が自分で処理しなければ終わらない
+  boost::asio::thread_pool pool(1);
+  boost::asio::post(pool, [&] {
+    parallel_intro_sort(v.begin(), v.end(), std::less<int>(), pool, 256);
+  });
+  pool.join();
+  REQUIRE(v == expect);
+}
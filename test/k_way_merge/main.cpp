@@ -0,0 +1,147 @@
+#include "sort/k_way_merge.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <random>
+#include <span>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+/**< @brief 長さのばらばらなk本の整列済みの列を作る */
+template <class T>
+std::vector<std::vector<T>> make_runs(std::size_t k, std::mt19937 &rng,
+                                      std::uint32_t range) {
+  std::vector<std::vector<T>> runs(k);
+  for (auto &r : runs) {
+    r.resize(rng() % 2000);
+    for (auto &x : r) {
+      x = static_cast<T>(rng() % range) - static_cast<T>(range / 2);
+    }
+    std::sort(r.begin(), r.end());
+  }
+  return runs;
+}
+
+template <class T>
+std::vector<T> concat_sorted(const std::vector<std::vector<T>> &runs) {
+  std::vector<T> v;
+  for (const auto &r : runs) {
+    v.insert(v.end(), r.begin(), r.end());
+  }
+  std::stable_sort(v.begin(), v.end());
+  return v;
+}
+} // namespace
+
+TEST_CASE("K-way merge Test against std::stable_sort") {
+  std::mt19937 rng(51);
+  for (const std::size_t k : {0, 1, 2, 3, 7, 8, 9, 64, 100}) {
+    const auto i32 = make_runs<std::int32_t>(k, rng, 1000);
+    const auto u32 = make_runs<std::uint32_t>(k, rng, 1u << 31);
+    const auto i64 = make_runs<std::int64_t>(k, rng, 100000);
+    std::vector<std::int32_t> a;
+    std::vector<std::uint32_t> b;
+    std::vector<std::int64_t> c;
+    k_way_merge(i32, std::back_inserter(a));
+    k_way_merge(u32, std::back_inserter(b));
+    k_way_merge(i64, std::back_inserter(c));
+    REQUIRE(a == concat_sorted(i32));
+    REQUIRE(b == concat_sorted(u32));
+    REQUIRE(c == concat_sorted(i64));
+  }
+  // 最大値を含む列
+  const std::vector<std::vector<std::uint32_t>> edge = {
+      {0, 0xffffffffu}, {}, {0xffffffffu, 0xffffffffu}, {1}};
+  std::vector<std::uint32_t> out(5);
+  REQUIRE(k_way_merge(edge, out.begin()) == out.end());
+  REQUIRE(out == concat_sorted(edge));
+  std::fill(out.begin(), out.end(), 0u);
+  REQUIRE(k_way_merge(edge, out.data()) == out.data() + out.size());
+  REQUIRE(out == concat_sorted(edge));
+}
+
+TEST_CASE("K-way merge Stability and custom comparator") {
+  struct entry {
+    int key;
+    int run;
+  };
+  std::mt19937 rng(52);
+  std::vector<std::vector<entry>> runs(5);
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 300; j++) {
+      runs[i].push_back({static_cast<int>(rng() % 20), i});
+    }
+    std::sort(runs[i].begin(), runs[i].end(),
+              [](const entry &x, const entry &y) { return x.key > y.key; });
+  }
+  std::vector<entry> out;
+  k_way_merge(runs, std::back_inserter(out),
+              [](const entry &x, const entry &y) { return x.key > y.key; });
+  REQUIRE(out.size() == 1500);
+  for (std::size_t i = 1; i < out.size(); i++) {
+    REQUIRE(out[i - 1].key >= out[i].key);
+    if (out[i - 1].key == out[i].key) { // 等しいキーは列の順
+      REQUIRE(out[i - 1].run <= out[i].run);
+    }
+  }
+}
+
+TEST_CASE("K-way merge Ranges of different types") {
+  std::mt19937 rng(54);
+  const auto runs = make_runs<std::int32_t>(4, rng, 1000);
+  const std::deque<std::int32_t> d(runs[1].begin(), runs[1].end());
+  const std::list<std::int32_t> l(runs[2].begin(), runs[2].end());
+  std::vector<std::int32_t> a, b;
+  k_way_merge(std::tie(runs[0], d, l, runs[3]), std::back_inserter(a));
+  REQUIRE(a == concat_sorted(runs));
+  // 型が揃っていれば列の配列と同じ処理になる
+  k_way_merge(std::tie(runs[0], runs[1], runs[2], runs[3]),
+              std::back_inserter(b), std::less<std::int32_t>());
+  REQUIRE(b == a);
+  // 要素の型が異なれば共通の型で比べる
+  const std::vector<std::int64_t> wide(runs[0].begin(), runs[0].end());
+  std::vector<std::int64_t> c;
+  k_way_merge(std::tie(wide, d), std::back_inserter(c));
+  std::vector<std::int64_t> expect(wide);
+  expect.insert(expect.end(), d.begin(), d.end());
+  std::stable_sort(expect.begin(), expect.end());
+  REQUIRE(c == expect);
+  std::vector<std::int32_t> e;
+  REQUIRE(k_way_merge(std::tuple<>(), e.begin()) == e.begin());
+}
+
+TEST_CASE("K-way merge Lazy iterator") {
+  std::mt19937 rng(53);
+  std::vector<std::vector<std::string>> runs(6);
+  for (auto &r : runs) {
+    for (int j = 0; j < 200; j++) {
+      r.push_back(std::to_string(rng() % 1000));
+    }
+    std::sort(r.begin(), r.end());
+  }
+  std::vector<std::string> out;
+  for (const auto &s : make_k_way_merge(runs)) {
+    out.push_back(s);
+  }
+  REQUIRE(out == concat_sorted(runs));
+
+  // 先頭の10個だけを取り出す
+  std::vector<std::span<const std::string>> views(runs.begin(), runs.end());
+  auto merge = make_k_way_merge(views, std::less<std::string>());
+  auto it = merge.begin();
+  for (int i = 0; i < 10; i++, ++it) {
+    REQUIRE(*it == out[i]);
+  }
+  REQUIRE(it != merge.end());
+
+  const std::vector<std::vector<int>> none;
+  REQUIRE(make_k_way_merge(none).begin() == std::default_sentinel);
+}
@@ -0,0 +1,144 @@
+#include "container/loose_quadtree.hpp"
+#include <random>
+#include <set>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+using tree_t = container::loose_quadtree<int>;
+using point_t = tree_t::point_t;
+using aabb_t = tree_t::aabb_t;
+
+TEST_CASE("Loose quadtree Insert Erase Move Test") {
+  tree_t t(aabb_t{0.0f, 0.0f, 64.0f, 64.0f}, 8);
+  const auto a = t.insert(aabb_t{1.0f, 1.0f, 2.0f, 2.0f}, 1);
+  const auto b = t.insert(aabb_t{30.0f, 30.0f, 34.0f, 34.0f}, 2);
+  const auto c = t.insert(aabb_t{-10.0f, -10.0f, -9.0f, -9.0f}, 3); // 世界の外
+
+  std::set<int> found;
+  t.query_aabb(aabb_t{0.0f, 0.0f, 3.0f, 3.0f},
+               [&](tree_t::handle_t, int v) { found.insert(v); });
+  REQUIRE(found == std::set<int>{1});
+
+  found.clear();
+  t.query_radius(point_t{-9.5f, -9.5f}, 1.0f,
+                 [&](tree_t::handle_t, int v) { found.insert(v); });
+  REQUIRE(found == std::set<int>{3});
+
+  t.move(b, aabb_t{1.5f, 1.5f, 2.5f, 2.5f});
+  found.clear();
+  t.query_aabb(aabb_t{0.0f, 0.0f, 3.0f, 3.0f},
+               [&](tree_t::handle_t, int v) { found.insert(v); });
+  REQUIRE(found == std::set<int>{1, 2});
+
+  REQUIRE(t.erase(a) == std::make_optional(1));
+  REQUIRE(t.erase(c) == std::make_optional(3));
+  REQUIRE(t.size() == 1);
+  found.clear();
+  t.query_aabb(aabb_t{-64.0f, -64.0f, 64.0f, 64.0f},
+               [&](tree_t::handle_t, int v) { found.insert(v); });
+  REQUIRE(found == std::set<int>{2});
+}
+
+TEST_CASE("Loose quadtree Query Test against brute force") {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> pos(0.0f, 1024.0f);
+  std::uniform_real_distribution<float> ext(0.0f, 16.0f);
+  auto box = [&] {
+    const float x = pos(rng), y = pos(rng);
+    return aabb_t{x, y, x + ext(rng), y + ext(rng)};
+  };
+  constexpr std::size_t n = 1000;
+  tree_t t(aabb_t{0.0f, 0.0f, 1024.0f, 1024.0f}, n, 8, 8 * n);
+  std::vector<aabb_t> bs(n);
+  for (std::size_t i = 0; i < n; i++) {
+    bs[i] = box();
+    REQUIRE(t.insert(bs[i], static_cast<int>(i)) == i);
+  }
+  for (std::size_t i = 0; i < n; i += 2) { // 半分を動かす
+    bs[i] = box();
+    t.move(i, bs[i]);
+  }
+
+  std::vector<aabb_t> qs(32);
+  for (auto &&q : qs) {
+    q = aabb_t::from_circle(point_t{pos(rng), pos(rng)}, 40.0f);
+  }
+  std::vector<std::set<int>> found(qs.size());
+  t.query_aabb(qs.begin(), qs.end(),
+               [&](std::size_t i, tree_t::handle_t, int v) {
+                 found[i].insert(v);
+               });
+  for (std::size_t i = 0; i < qs.size(); i++) {
+    std::set<int> expected;
+    for (std::size_t j = 0; j < n; j++) {
+      if (container::overlaps(qs[i], bs[j])) {
+        expected.insert(static_cast<int>(j));
+      }
+    }
+    REQUIRE(found[i] == expected);
+  }
+
+  std::vector<point_t> cs(32);
+  for (auto &&c : cs) {
+    c = {pos(rng), pos(rng)};
+  }
+  std::vector<std::set<int>> near(cs.size());
+  t.query_radius(cs.begin(), cs.end(), 30.0f,
+                 [&](std::size_t i, tree_t::handle_t, int v) {
+                   near[i].insert(v);
+                 });
+  for (std::size_t i = 0; i < cs.size(); i++) {
+    std::set<int> expected;
+    for (std::size_t j = 0; j < n; j++) {
+      if (container::overlaps(bs[j], cs[i], 30.0f)) {
+        expected.insert(static_cast<int>(j));
+      }
+    }
+    REQUIRE(near[i] == expected);
+  }
+}
+
+TEST_CASE("Loose quadtree Node Pool Test") {
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<float> pos(0.0f, 1000.0f);
+  auto points = [&](std::size_t n) {
+    std::vector<aabb_t> bs(n);
+    for (auto &&b : bs) {
+      b = aabb_t::from_circle(point_t{pos(rng), pos(rng)}, 0.25f);
+    }
+    return bs;
+  };
+  auto all = [](const tree_t &t) {
+    std::set<int> found;
+    t.query_aabb(aabb_t{0.0f, 0.0f, 1000.0f, 1000.0f},
+                 [&](tree_t::handle_t, int v) { found.insert(v); });
+    return found;
+  };
+
+  SECTION("Default pool holds spread-out small items") {
+    tree_t t(aabb_t{0.0f, 0.0f, 1000.0f, 1000.0f});
+    const auto bs = points(32);
+    std::set<int> expected;
+    for (std::size_t i = 0; i < bs.size(); i++) {
+      t.insert(bs[i], static_cast<int>(i));
+      expected.insert(static_cast<int>(i));
+    }
+    REQUIRE(all(t) == expected);
+  }
+  SECTION("Small explicit pool stores items shallower") {
+    tree_t t(aabb_t{0.0f, 0.0f, 1000.0f, 1000.0f}, 64, 8, 16);
+    const auto bs = points(64);
+    std::set<int> expected;
+    for (std::size_t i = 0; i < bs.size(); i++) {
+      t.insert(bs[i], static_cast<int>(i));
+      expected.insert(static_cast<int>(i));
+    }
+    REQUIRE(all(t) == expected);
+    for (std::size_t i = 0; i < bs.size(); i += 2) {
+      t.move(i, aabb_t::from_circle(point_t{pos(rng), pos(rng)}, 0.25f));
+    }
+    REQUIRE(all(t) == expected);
+  }
+}
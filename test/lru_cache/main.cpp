@@ -0,0 +1,98 @@
+#include "container/lru_cache.hpp"
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+template <class Key, class T>
+using count_lru = container::lru_cache<Key, T, container::unit_weigher<Key, T>>;
+template <class Key, class T>
+using count_clock =
+    container::clock_cache<Key, T, container::unit_weigher<Key, T>>;
+
+TEST_CASE("LRU cache Get Put Erase Test") {
+  count_lru<std::string, int> c(3);
+  REQUIRE(c.put("red", 0xff0000) == std::nullopt);
+  REQUIRE(c.put("green", 0x00ff00) == std::nullopt);
+  REQUIRE(c.put("blue", 0x0000ff) == std::nullopt);
+  REQUIRE(c.get("red") == std::make_optional(0xff0000)); // redが最新になる
+  REQUIRE(c.put("white", 0xffffff) == std::nullopt);     // greenが追い出される
+  REQUIRE(c.get("green") == std::nullopt);
+  REQUIRE(c.get("blue") == std::make_optional(0x0000ff));
+  REQUIRE(c.put("blue", 0x0000fe) == std::make_optional(0x0000ff));
+  REQUIRE(c.erase("white") == std::make_optional(0xffffff));
+  REQUIRE(c.erase("white") == std::nullopt);
+  REQUIRE(c.size() == 2);
+  REQUIRE(c.hits() == 2);
+  REQUIRE(c.misses() == 1);
+  REQUIRE(c.evictions() == 1);
+}
+
+TEST_CASE("CLOCK cache Second Chance Test") {
+  count_clock<int, int> c(3);
+  c.put(1, 1);
+  c.put(2, 2);
+  c.put(3, 3);
+  REQUIRE(c.get(1) == std::make_optional(1)); // 1の参照ビットが立つ
+  c.put(4, 4); // 1は見逃され、2が追い出される
+  REQUIRE(c.contains(1));
+  REQUIRE(!c.contains(2));
+  REQUIRE(c.contains(3));
+  REQUIRE(c.contains(4));
+  REQUIRE(c.evictions() == 1);
+}
+
+TEST_CASE("LRU cache Byte Budget Test") {
+  container::lru_cache<int, std::string> c(16, 200);
+  const std::size_t w = container::byte_weigher<int, std::string>()(
+      0, std::string(64, 'x'));
+  c.put(0, std::string(64, 'a'));
+  c.put(1, std::string(64, 'b'));
+  REQUIRE(c.weight() == 2 * w);
+  c.put(2, std::string(64, 'c')); // 予算を超えるので0が追い出される
+  REQUIRE(c.weight() <= c.budget());
+  REQUIRE(!c.contains(0));
+  REQUIRE(c.contains(2));
+  c.put(3, std::string(1000, 'd')); // 予算を超える要素はキャッシュしない
+  REQUIRE(!c.contains(3));
+  REQUIRE(c.contains(2));
+}
+
+TEST_CASE("LRU cache Index Consistency Test") {
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> key(0, 255);
+  count_lru<int, int> c(64);
+  count_clock<int, int> d(64);
+  std::unordered_map<int, int> m; // 削除は追い出しと独立に確かめる
+  for (int i = 0; i < 20000; i++) {
+    const int k = key(rng);
+    switch (rng() % 3) {
+    case 0:
+      c.put(k, i);
+      d.put(k, i);
+      break;
+    case 1:
+      if (auto v = c.get(k)) {
+        REQUIRE(c.contains(k));
+      }
+      d.get(k);
+      break;
+    default:
+      c.erase(k);
+      d.erase(k);
+      REQUIRE(!c.contains(k));
+      REQUIRE(!d.contains(k));
+      break;
+    }
+    REQUIRE(c.size() <= 64);
+    REQUIRE(d.size() <= 64);
+  }
+  std::size_t found = 0;
+  for (int k = 0; k < 256; k++) {
+    found += c.contains(k);
+  }
+  REQUIRE(found == c.size());
+  REQUIRE(c.hits() + c.misses() > 0);
+}
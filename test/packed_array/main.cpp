@@ -0,0 +1,97 @@
+#include "bit/packed_array.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+TEST_CASE("Packed array Random access") {
+  std::mt19937 rng(46);
+  bit::packed_array<12> tiles(1000);
+  bit::packed_array<3> flags(1000);
+  REQUIRE(tiles.bits() == 12);
+  REQUIRE(tiles.bytes() < 1000 * sizeof(std::uint32_t) / 2);
+  std::vector<std::uint32_t> t(1000), f(1000);
+  for (int r = 0; r < 5000; r++) {
+    const std::size_t i = rng() % 1000;
+    const std::uint32_t v = rng();
+    tiles.set(i, v);
+    flags.set(i, v);
+    t[i] = v & 0xfff;
+    f[i] = v & 0x7;
+  }
+  for (std::size_t i = 0; i < 1000; i++) {
+    REQUIRE(tiles[i] == t[i]);
+    REQUIRE(flags.get(i) == f[i]);
+  }
+}
+
+TEST_CASE("Packed array Bulk unpack and pack on every width") {
+  std::mt19937 rng(47);
+  for (std::size_t w = 1; w <= 32; w++) {
+    const std::size_t n = 1000 + w;
+    bit::packed_array<> a(n, w);
+    const std::uint64_t mask = (std::uint64_t(1) << w) - 1;
+    std::vector<std::uint32_t> in(n), out(n);
+    for (auto &x : in) {
+      x = rng();
+    }
+    a.pack(0, in);
+    for (std::size_t i = 0; i < n; i++) {
+      REQUIRE(a[i] == (in[i] & mask));
+    }
+    // 8要素や語の境界にそろわない範囲
+    for (const std::size_t first : {0, 1, 3, 7, 8, 13, 64}) {
+      const std::size_t len = n - first - 5;
+      std::vector<std::uint32_t> part(len);
+      a.unpack(first, part);
+      for (std::size_t i = 0; i < len; i++) {
+        REQUIRE(part[i] == (in[first + i] & mask));
+      }
+    }
+    // 一部を書き換えても前後の要素は変わらない
+    std::vector<std::uint32_t> patch(37, ~std::uint32_t(0));
+    a.pack(11, patch);
+    a.unpack(0, out);
+    for (std::size_t i = 0; i < n; i++) {
+      REQUIRE(out[i] == (11 <= i && i < 48 ? mask : in[i] & mask));
+    }
+#if defined(BIT_PACKED_SIMD)
+    const auto f = cpu::detect();
+    std::vector<std::uint64_t> words(a.words().begin(), a.words().end());
+    if (f.has(cpu::avx2)) {
+      std::vector<std::uint32_t> simd(n - 3);
+      bit::detail::packed_unpack_avx2(words.data(), 3, w, simd.data(),
+                                      simd.size());
+      REQUIRE(std::equal(simd.begin(), simd.end(), out.begin() + 3));
+    }
+    if (f.has(cpu::bmi2)) {
+      std::vector<std::uint64_t> packed(words.size(), 0);
+      bit::detail::packed_pack_bmi2(packed.data(), 0, w, out.data(), n);
+      REQUIRE(packed == words);
+    }
+#endif
+  }
+}
+
+TEST_CASE("Packed array Resize and errors") {
+  bit::packed_array<5> a;
+  REQUIRE(a.size() == 0);
+  std::vector<std::uint32_t> none;
+  a.pack(0, none);
+  a.resize(20);
+  for (std::size_t i = 0; i < 20; i++) {
+    a.set(i, 31);
+  }
+  a.resize(7);
+  a.resize(20);
+  REQUIRE(a[6] == 31);
+  REQUIRE(a[7] == 0);
+  REQUIRE(a[19] == 0);
+  std::vector<std::uint32_t> out(5);
+  REQUIRE_THROWS_AS(a.unpack(16, out), std::out_of_range);
+  REQUIRE_THROWS_AS(a.pack(21, none), std::out_of_range);
+  REQUIRE_THROWS_AS(bit::packed_array<>(10, 0), std::invalid_argument);
+  REQUIRE_THROWS_AS(bit::packed_array<>(10, 33), std::invalid_argument);
+}
@@ -0,0 +1,77 @@
+#include "sort/radix_sort.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+template <class T, class Gen> std::vector<T> make(std::size_t n, Gen gen) {
+  std::vector<T> v(n);
+  std::generate(v.begin(), v.end(), gen);
+  return v;
+}
+
+template <class T> void check(std::vector<T> v) {
+  auto expect = v;
+  std::sort(expect.begin(), expect.end());
+  radix_sort(v.begin(), v.end());
+  REQUIRE(v == expect);
+}
+} // namespace
+
+TEST_CASE("Radix sort Integer Test against std::sort") {
+  std::mt19937_64 rng(13);
+  for (const std::size_t n : {0, 1, 2, 100, 1000, 100000}) {
+    check(make<std::uint32_t>(n, [&] { return std::uint32_t(rng()); }));
+    check(make<std::int32_t>(n, [&] { return std::int32_t(rng()); }));
+    check(make<std::uint64_t>(n, [&] { return rng(); }));
+    check(make<std::int64_t>(n, [&] { return std::int64_t(rng()); }));
+    check(make<std::int16_t>(n, [&] { return std::int16_t(rng()); }));
+    // 上位の桁がすべて等しいキー
+    check(make<std::uint64_t>(
+        n, [&] { return 0xabcd000000000000 | rng() % 1000; }));
+    check(
+        make<std::uint32_t>(n, [&] { return std::uint32_t(rng() % 3) << 8; }));
+  }
+}
+
+TEST_CASE("Radix sort Floating point Test against std::sort") {
+  std::mt19937_64 rng(17);
+  std::normal_distribution<double> dist(0.0, 1e6);
+  for (const std::size_t n : {0, 1, 1000, 100000}) {
+    check(make<float>(n, [&] { return float(dist(rng)); }));
+    check(make<double>(n, [&] { return dist(rng); }));
+  }
+  check(std::vector<double>{0.0, -1.5, std::numeric_limits<double>::infinity(),
+                            -std::numeric_limits<double>::infinity(), 2.0,
+                            -std::numeric_limits<double>::min(),
+                            std::numeric_limits<double>::min()});
+}
+
+TEST_CASE("Radix sort Key extractor Test") {
+  struct record {
+    std::uint32_t id;
+    float score;
+  };
+  std::mt19937 rng(19);
+  std::vector<record> v(5000);
+  for (std::uint32_t i = 0; i < v.size(); i++) {
+    v[i] = {i, float(rng() % 100) - 50.0f};
+  }
+  radix_sort(v.begin(), v.end(), [](const record &r) { return r.score; });
+  for (std::size_t i = 1; i < v.size(); i++) {
+    REQUIRE(v[i - 1].score <= v[i].score);
+    if (v[i - 1].score == v[i].score) { // LSDは安定
+      REQUIRE(v[i - 1].id < v[i].id);
+    }
+  }
+  radix_sort(v.begin(), v.end(),
+             [](const record &r) { return -std::int64_t(r.id); });
+  for (std::size_t i = 0; i < v.size(); i++) {
+    REQUIRE(v[i].id == v.size() - 1 - i);
+  }
+}
@@ -0,0 +1,166 @@
+#include "container/roaring_bitmap.hpp"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+std::set<std::uint32_t> to_set(const container::roaring_bitmap &r) {
+  std::set<std::uint32_t> s;
+  r.for_each([&](std::uint32_t x) { s.insert(x); });
+  return s;
+}
+
+/**< @brief 疎な要素、密な区間、連続区間を混ぜた集合を作る */
+std::set<std::uint32_t> make_set(std::mt19937 &rng) {
+  std::set<std::uint32_t> s;
+  std::uniform_int_distribution<std::uint32_t> any(0, 1U << 20);
+  for (int i = 0; i < 2000; i++) {
+    s.insert(any(rng));
+  }
+  const std::uint32_t dense = (rng() % 8) << 16;
+  for (int i = 0; i < 20000; i++) {
+    s.insert(dense | (rng() & 0xffff));
+  }
+  const std::uint32_t run = ((rng() % 8) << 16) | (rng() & 0x7fff);
+  for (std::uint32_t x = run; x < run + 30000; x++) {
+    s.insert(x);
+  }
+  return s;
+}
+} // namespace
+
+TEST_CASE("Roaring bitmap Add Remove Contains Test") {
+  container::roaring_bitmap r;
+  REQUIRE(r.empty());
+  for (std::uint32_t x = 0; x < 10000; x++) { // 配列からビットマップへ
+    r.add(x * 3);
+  }
+  r.add(0xffffffff);
+  REQUIRE(r.cardinality() == 10001);
+  REQUIRE(r.contains(2997));
+  REQUIRE(!r.contains(2998));
+  REQUIRE(r.contains(0xffffffff));
+  for (std::uint32_t x = 0; x < 9000; x++) { // ビットマップから配列へ
+    r.remove(x * 3);
+  }
+  r.remove(0xffffffff);
+  REQUIRE(r.cardinality() == 1000);
+  REQUIRE(!r.contains(0));
+  REQUIRE(r.contains(27000));
+}
+
+TEST_CASE("Roaring bitmap Set Operations Test against std::set") {
+  std::mt19937 rng(11);
+  for (int t = 0; t < 4; t++) {
+    const auto a = make_set(rng), b = make_set(rng);
+    container::roaring_bitmap ra(a.begin(), a.end()), rb(b.begin(), b.end());
+    if (t & 1) {
+      ra.run_optimize();
+    }
+    if (t & 2) {
+      rb.run_optimize();
+    }
+    REQUIRE(to_set(ra) == a);
+    REQUIRE(to_set(rb) == b);
+
+    std::set<std::uint32_t> u, i, d;
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                   std::inserter(u, u.end()));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                          std::inserter(i, i.end()));
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                        std::inserter(d, d.end()));
+    REQUIRE(to_set(ra | rb) == u);
+    REQUIRE(to_set(ra & rb) == i);
+    REQUIRE(to_set(ra - rb) == d);
+    REQUIRE((ra & rb).cardinality() == i.size());
+
+    container::roaring_bitmap rc = ra;
+    rc -= rb;
+    rc |= rb;
+    REQUIRE(to_set(rc) == u);
+    rc &= ra;
+    REQUIRE(to_set(rc) == a);
+  }
+}
+
+TEST_CASE("Roaring bitmap Run Container Test") {
+  container::roaring_bitmap r;
+  for (std::uint32_t x = 100; x < 60000; x++) {
+    r.add(x);
+  }
+  const std::size_t before = r.bytes();
+  r.run_optimize();
+  REQUIRE(r.bytes() < before);
+  REQUIRE(r.cardinality() == 59900);
+  REQUIRE(r.contains(100));
+  REQUIRE(!r.contains(99));
+  r.add(99); // 連長コンテナへの追加
+  r.remove(500);
+  REQUIRE(r.contains(99));
+  REQUIRE(!r.contains(500));
+  REQUIRE(r.cardinality() == 59900);
+}
+
+TEST_CASE("Roaring bitmap Run Container Update Test") {
+  SECTION("Adding to a sparse run chunk keeps it small") {
+    container::roaring_bitmap r;
+    for (std::uint32_t x = 0; x < 10; x++) {
+      r.add(x * 1000);
+    }
+    r.run_optimize();
+    const std::size_t before = r.bytes();
+    r.add(5);
+    REQUIRE(r.bytes() < before + 64);
+    REQUIRE(r.cardinality() == 11);
+  }
+  SECTION("Runs are extended, merged and split in place") {
+    container::roaring_bitmap r;
+    for (std::uint32_t x = 0; x < 3000; x++) {
+      if (x != 1000 && x != 2000) {
+        r.add(x);
+      }
+    }
+    r.run_optimize();
+    const std::size_t optimized = r.bytes();
+    r.add(1000); // 2つの区間を繋ぐ
+    r.add(3000); // 区間を伸ばす
+    REQUIRE(r.bytes() <= optimized);
+    r.remove(1500); // 区間を分ける
+    r.remove(0);
+    REQUIRE(r.bytes() <= optimized + 64);
+    std::set<std::uint32_t> expected;
+    for (std::uint32_t x = 1; x <= 3000; x++) {
+      if (x != 1500 && x != 2000) {
+        expected.insert(x);
+      }
+    }
+    REQUIRE(to_set(r) == expected);
+  }
+  SECTION("Matches std::set under random updates") {
+    std::mt19937 rng(5);
+    container::roaring_bitmap r;
+    std::set<std::uint32_t> s;
+    for (std::uint32_t x = 100; x < 5000; x++) {
+      r.add(x);
+      s.insert(x);
+    }
+    r.run_optimize();
+    for (int i = 0; i < 20000; i++) {
+      const std::uint32_t x = rng() % 6000;
+      if (rng() % 2) {
+        r.add(x);
+        s.insert(x);
+      } else {
+        r.remove(x);
+        s.erase(x);
+      }
+    }
+    REQUIRE(to_set(r) == s);
+    REQUIRE(r.cardinality() == s.size());
+  }
+}
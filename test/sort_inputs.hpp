@@ -0,0 +1,71 @@
+/**
+ * @brief ソートのテストで共有する入力の分布
+ * @note  各テストは必要な分布だけを関数で作るか、make_inputsでまとめて作ります。
+ */
+
+#ifndef TEST_SORT_INPUTS_HPP
+#define TEST_SORT_INPUTS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace sort_inputs {
+
+/**< @brief 乱数の配列を作る */
+inline std::vector<int> random(std::size_t n, std::mt19937 &rng) {
+  std::vector<int> v(n);
+  for (auto &x : v) {
+    x = static_cast<int>(rng());
+  }
+  return v;
+}
+
+/**< @brief 整列済みの配列を作る */
+inline std::vector<int> sorted(std::size_t n) {
+  std::vector<int> v(n);
+  for (std::size_t i = 0; i < n; i++) {
+    v[i] = static_cast<int>(i);
+  }
+  return v;
+}
+
+/**< @brief 逆順の配列を作る */
+inline std::vector<int> reversed(std::size_t n) {
+  std::vector<int> v(n);
+  for (std::size_t i = 0; i < n; i++) {
+    v[i] = static_cast<int>(n - i);
+  }
+  return v;
+}
+
+/**< @brief 値が[0, k)のk種類しかない、重複の多い配列を作る */
+inline std::vector<int> few_unique(std::size_t n, std::mt19937 &rng,
+                                   int k = 7) {
+  std::vector<int> v(n);
+  for (auto &x : v) {
+    x = static_cast<int>(rng() % static_cast<unsigned>(k));
+  }
+  return v;
+}
+
+/**< @brief 山型の配列を作る */
+inline std::vector<int> organ_pipe(std::size_t n) {
+  std::vector<int> v(n);
+  for (std::size_t i = 0; i < n; i++) {
+    v[i] = static_cast<int>(std::min(i, n - i));
+  }
+  return v;
+}
+
+/**< @brief 乱数、整列済み、逆順、重複の多い、山型の配列を作る */
+inline std::vector<std::vector<int>> make_inputs(std::size_t n,
+                                                 std::mt19937 &rng) {
+  return {random(n, rng), sorted(n), reversed(n), few_unique(n, rng),
+          organ_pipe(n)};
+}
+
+} // namespace sort_inputs
+
+#endif // TEST_SORT_INPUTS_HPP
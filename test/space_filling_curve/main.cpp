@@ -0,0 +1,111 @@
+#include "bit/space_filling_curve.hpp"
+#include "sort/indirect_sort.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+/**< @brief WikipediaのHilbert曲線xy2d(1ビットずつ処理する) */
+std::uint64_t hilbert_reference(std::uint32_t x, std::uint32_t y) {
+  std::uint64_t d = 0;
+  for (std::uint64_t s = std::uint64_t(1) << 31; s > 0; s >>= 1) {
+    const std::uint32_t rx = (x & s) != 0, ry = (y & s) != 0;
+    d += s * s * ((3 * rx) ^ ry);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = ~x;
+        y = ~y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+/**< @brief ビットを1つずつ並べたMorton順序 */
+std::uint64_t morton_reference(const std::vector<std::uint32_t> &c, int bits) {
+  std::uint64_t m = 0;
+  for (int b = 0; b < bits; b++) {
+    for (std::size_t k = 0; k < c.size(); k++) {
+      m |= std::uint64_t((c[k] >> b) & 1) << (b * c.size() + k);
+    }
+  }
+  return m;
+}
+} // namespace
+
+TEST_CASE("Space-filling curve Morton order") {
+  static_assert(bit::morton2_encode(0b11, 0b01) == 0b0111);
+  static_assert(bit::morton2_decode(0b0111)[0] == 0b11);
+  static_assert(bit::morton3_encode(1, 0, 1) == 0b101);
+  std::mt19937 rng(47);
+  for (int i = 0; i < 10000; i++) {
+    const std::uint32_t x = rng(), y = rng(), z = rng() & 0x1fffff;
+    const std::uint32_t x21 = x & 0x1fffff, y21 = y & 0x1fffff;
+    const std::uint64_t m2 = bit::morton2_encode(x, y);
+    const std::uint64_t m3 = bit::morton3_encode(x21, y21, z);
+    REQUIRE(m2 == morton_reference({x, y}, 32));
+    REQUIRE(m3 == morton_reference({x21, y21, z}, 21));
+    REQUIRE(bit::morton2_decode(m2) == std::array<std::uint32_t, 2>{x, y});
+    REQUIRE(bit::morton3_decode(m3) ==
+            std::array<std::uint32_t, 3>{x21, y21, z});
+    REQUIRE(bit::detail::spread2(x) == (m2 & bit::detail::morton2_mask));
+    REQUIRE(bit::detail::compact3(m3 >> 2) == z);
+  }
+}
+
+TEST_CASE("Space-filling curve Hilbert curve") {
+  static_assert(bit::hilbert2_encode(0, 0) == 0);
+  std::mt19937 rng(48);
+  for (int i = 0; i < 10000; i++) {
+    std::uint32_t x = rng(), y = rng();
+    if (i < 1000) { // 小さな座標
+      x &= 0xff, y &= 0xff;
+    }
+    const std::uint64_t d = bit::hilbert2_encode(x, y);
+    REQUIRE(d == hilbert_reference(x, y));
+    REQUIRE(bit::hilbert2_decode(d) == std::array<std::uint32_t, 2>{x, y});
+  }
+  // 隣り合う添字の座標は上下左右に隣り合う
+  for (std::uint64_t d = 0; d < 4096; d++) {
+    const auto p = bit::hilbert2_decode(d), q = bit::hilbert2_decode(d + 1);
+    REQUIRE(std::abs(int(p[0]) - int(q[0])) + std::abs(int(p[1]) - int(q[1])) ==
+            1);
+  }
+}
+
+TEST_CASE("Space-filling curve Bulk encoding and sorting") {
+  std::mt19937 rng(49);
+  const std::size_t n = 5000;
+  std::vector<std::uint32_t> xs(n), ys(n), zs(n);
+  for (std::size_t i = 0; i < n; i++) {
+    xs[i] = rng() % 1024, ys[i] = rng() % 1024, zs[i] = rng() % 1024;
+  }
+  std::vector<std::uint64_t> m2(n), m3(n), h2(n);
+  bit::morton2_encode(xs, ys, m2);
+  bit::morton3_encode(xs, ys, zs, m3);
+  bit::hilbert2_encode(xs, ys, h2);
+  for (std::size_t i = 0; i < n; i++) {
+    REQUIRE(m2[i] == bit::morton2_encode(xs[i], ys[i]));
+    REQUIRE(m3[i] == bit::morton3_encode(xs[i], ys[i], zs[i]));
+    REQUIRE(h2[i] == bit::hilbert2_encode(xs[i], ys[i]));
+  }
+  std::vector<std::uint64_t> scalar(n);
+  bit::detail::hilbert2_encode_scalar(xs.data(), ys.data(), scalar.data(), n);
+  REQUIRE(scalar == h2);
+
+  // 曲線の順に並べ替える
+  auto keys = h2;
+  sort_by_key(keys, xs, ys);
+  for (std::size_t i = 1; i < n; i++) {
+    REQUIRE(keys[i - 1] <= keys[i]);
+    REQUIRE(bit::hilbert2_encode(xs[i], ys[i]) == keys[i]);
+  }
+  std::vector<std::uint64_t> short_out(n - 1);
+  REQUIRE_THROWS_AS(bit::morton2_encode(xs, ys, short_out),
+                    std::invalid_argument);
+}
@@ -0,0 +1,96 @@
+#include "container/spatial_hash_grid.hpp"
+#include <random>
+#include <set>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+using grid_t = container::spatial_hash_grid<int>;
+using point_t = grid_t::point_t;
+using aabb_t = grid_t::aabb_t;
+
+TEST_CASE("Spatial hash grid Insert Erase Move Test") {
+  grid_t g(1.0f, 8);
+  const auto a = g.insert({0.5f, 0.5f}, 1);
+  const auto b = g.insert({-3.5f, 2.0f}, 2);
+  REQUIRE(g.size() == 2);
+
+  std::set<int> found;
+  g.query_radius(point_t{0.0f, 0.0f}, 1.0f,
+                 [&](grid_t::handle_t, int v) { found.insert(v); });
+  REQUIRE(found == std::set<int>{1});
+
+  g.move(b, {0.0f, -0.5f}); // セルを跨ぐ移動
+  found.clear();
+  g.query_radius(point_t{0.0f, 0.0f}, 1.0f,
+                 [&](grid_t::handle_t, int v) { found.insert(v); });
+  REQUIRE(found == std::set<int>{1, 2});
+
+  REQUIRE(g.erase(a) == std::make_optional(1));
+  found.clear();
+  g.query_aabb(aabb_t{-1.0f, -1.0f, 1.0f, 1.0f},
+               [&](grid_t::handle_t, int v) { found.insert(v); });
+  REQUIRE(found == std::set<int>{2});
+  REQUIRE(g.size() == 1);
+}
+
+TEST_CASE("Spatial hash grid Query Test against brute force") {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+  constexpr std::size_t n = 1000;
+  grid_t g(4.0f, n);
+  std::vector<point_t> ps(n);
+  for (std::size_t i = 0; i < n; i++) {
+    ps[i] = {pos(rng), pos(rng)};
+    REQUIRE(g.insert(ps[i], static_cast<int>(i)) == i);
+  }
+  for (std::size_t i = 0; i < n; i += 3) { // 一部を動かす
+    ps[i] = {pos(rng), pos(rng)};
+    g.move(i, ps[i]);
+  }
+
+  std::vector<point_t> qs(64);
+  for (auto &&q : qs) {
+    q = {pos(rng), pos(rng)};
+  }
+  constexpr float r = 6.0f;
+  std::vector<std::set<int>> found(qs.size());
+  g.query_radius(qs.begin(), qs.end(), r,
+                 [&](std::size_t i, grid_t::handle_t, int v) {
+                   found[i].insert(v);
+                 });
+  for (std::size_t i = 0; i < qs.size(); i++) {
+    std::set<int> expected;
+    for (std::size_t j = 0; j < n; j++) {
+      if (container::distance2(qs[i], ps[j]) <= r * r) {
+        expected.insert(static_cast<int>(j));
+      }
+    }
+    REQUIRE(found[i] == expected);
+  }
+
+  // 全バケットの走査に切り替わるほど大きな問い合わせ
+  std::size_t count = 0;
+  g.query_aabb(aabb_t{-100.0f, -100.0f, 100.0f, 100.0f},
+               [&](grid_t::handle_t, int) { count++; });
+  REQUIRE(count == n);
+}
+
+TEST_CASE("Spatial hash grid Huge Coordinates Test") {
+  grid_t g(1.0f, 8);
+  g.insert({1e20f, -1e20f}, 1);
+  g.insert({0.5f, 0.5f}, 2);
+  g.insert({-3e9f, 4e9f}, 3);
+
+  std::set<int> found;
+  const float inf = std::numeric_limits<float>::max();
+  g.query_aabb(aabb_t{-inf, -inf, inf, inf},
+               [&](grid_t::handle_t, int v) { found.insert(v); });
+  REQUIRE(found == std::set<int>{1, 2, 3});
+
+  found.clear();
+  g.query_radius(point_t{1e20f, -1e20f}, 1.0f,
+                 [&](grid_t::handle_t, int v) { found.insert(v); });
+  REQUIRE(found == std::set<int>{1});
+}
@@ -0,0 +1,114 @@
+#include "sort/stable_sort.hpp"
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/container/pmr/memory_resource.hpp>
+#include <boost/container/pmr/monotonic_buffer_resource.hpp>
+#include <new>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+struct record {
+  int key;
+  int seq;
+  bool operator==(const record &r) const {
+    return key == r.key && seq == r.seq;
+  }
+};
+
+bool by_key(const record &x, const record &y) { return x.key < y.key; }
+
+/**< @brief キーの重複が多いレコード列を作る */
+std::vector<record> make_records(std::size_t n, int keys, std::mt19937 &rng) {
+  std::vector<record> v(n);
+  for (std::size_t i = 0; i < n; i++) {
+    v[i] = {static_cast<int>(rng() % keys), static_cast<int>(i)};
+  }
+  return v;
+}
+
+/**< @brief 常に確保に失敗するメモリリソース */
+class failing_resource : public boost::container::pmr::memory_resource {
+protected:
+  void *do_allocate(std::size_t, std::size_t) override {
+    throw std::bad_alloc();
+  }
+  void do_deallocate(void *, std::size_t, std::size_t) override {}
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+} // namespace
+
+TEST_CASE("Stable merge sort Test against std::stable_sort") {
+  std::mt19937 rng(31);
+  failing_resource fail;
+  for (const std::size_t n : {0, 1, 2, 31, 32, 33, 1000, 100000}) {
+    for (const int keys : {1, 10, 1000000}) {
+      const auto v = make_records(n, keys, rng);
+      auto expect = v;
+      std::stable_sort(expect.begin(), expect.end(), by_key);
+      auto a = v, b = v;
+      stable_merge_sort(a.begin(), a.end(), by_key);
+      stable_merge_sort(b.begin(), b.end(), by_key, &fail); // 作業領域なし
+      REQUIRE(a == expect);
+      REQUIRE(b == expect);
+    }
+  }
+  std::vector<int> v(1000);
+  for (auto &x : v) {
+    x = static_cast<int>(rng());
+  }
+  auto expect = v;
+  std::sort(expect.begin(), expect.end());
+  stable_merge_sort(v.begin(), v.end());
+  REQUIRE(v == expect);
+}
+
+TEST_CASE("Parallel stable merge sort Test against std::stable_sort") {
+  std::mt19937 rng(32);
+  boost::asio::thread_pool pool(4);
+  failing_resource fail;
+  for (const std::size_t n : {1000, 100000, 1000000, 1234567}) {
+    for (const int keys : {3, 1000000}) {
+      const auto v = make_records(n, keys, rng);
+      auto expect = v;
+      std::stable_sort(expect.begin(), expect.end(), by_key);
+      auto a = v;
+      parallel_stable_merge_sort(a.begin(), a.end(), by_key, pool);
+      REQUIRE(a == expect);
+      if (n <= 100000) {
+        auto b = v;
+        parallel_stable_merge_sort(b.begin(), b.end(), by_key, pool, &fail);
+        REQUIRE(b == expect);
+      }
+    }
+  }
+  pool.join();
+}
+
+TEST_CASE("Parallel stable merge sort Test from a pool thread") {
+  std::mt19937 rng(33);
+  const auto v = make_records(100000, 1000, rng);
+  auto expect = v;
+  std::stable_sort(expect.begin(), expect.end(), by_key);
+  // 唯一のスレッドが呼び出し元として待つので、呼び出し元が自分で処理しなければ終わらない
+  auto a = v;
+  boost::asio::thread_pool one(1);
+  boost::asio::post(one, [&] {
+    parallel_stable_merge_sort(a.begin(), a.end(), by_key, one);
+  });
+  one.join();
+  REQUIRE(a == expect);
+  // スレッドセーフでないメモリリソースでも、確保は呼び出し元のスレッドだけで行われる
+  auto b = v;
+  boost::asio::thread_pool pool(4);
+  boost::container::pmr::monotonic_buffer_resource mono;
+  parallel_stable_merge_sort(b.begin(), b.end(), by_key, pool, &mono);
+  pool.join();
+  REQUIRE(b == expect);
+}
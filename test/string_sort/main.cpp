@@ -0,0 +1,105 @@
+#include "sort/string_sort.hpp"
+#include <algorithm>
+#include <boost/beast/core/string.hpp>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+/**< @brief 共通の接頭辞を持つURL風の文字列を作る */
+std::vector<std::string> make_urls(std::size_t n, std::mt19937 &rng) {
+  const std::vector<std::string> hosts = {
+      "https://example.com/", "https://example.com/assets/textures/",
+      "https://cdn.example.org/static/", "http://a/"};
+  std::vector<std::string> v(n);
+  for (auto &s : v) {
+    s = hosts[rng() % hosts.size()];
+    const std::size_t len = rng() % 24;
+    for (std::size_t i = 0; i < len; i++) {
+      s.push_back("abc/._0\xff"[rng() % 8]);
+    }
+  }
+  return v;
+}
+} // namespace
+
+TEST_CASE("String sort Test against std::sort") {
+  std::mt19937 rng(41);
+  for (const std::size_t n : {0, 1, 2, 16, 17, 1000, 5000, 100000}) {
+    auto v = make_urls(n, rng);
+    auto expect = v;
+    std::sort(expect.begin(), expect.end());
+    string_sort(v.begin(), v.end());
+    REQUIRE(v == expect);
+  }
+}
+
+TEST_CASE("String sort Edge cases") {
+  std::mt19937 rng(42);
+  // 空文字列、NUL文字を含む文字列、8バイト境界の前後で終わる文字列
+  std::vector<std::string> v;
+  for (int i = 0; i < 20000; i++) {
+    std::string s(rng() % 20, 'x');
+    for (auto &c : s) {
+      c = "\0\1x"[rng() % 3];
+    }
+    v.push_back(s);
+  }
+  v.push_back(std::string("a"));
+  v.push_back(std::string("a\0", 2));
+  v.push_back(std::string("a\0\0\0\0\0\0\0", 8));
+  v.push_back(std::string("a\0\0\0\0\0\0\0\0", 9));
+  v.push_back(std::string());
+  auto expect = v;
+  std::sort(expect.begin(), expect.end());
+  string_sort(v.begin(), v.end());
+  REQUIRE(v == expect);
+
+  // 長い共通の接頭辞と全て等しい文字列
+  std::vector<std::string> same(10000, std::string(300, 'p'));
+  for (std::size_t i = 0; i < same.size(); i += 3) {
+    same[i] += std::to_string(rng() % 100);
+  }
+  expect = same;
+  std::sort(expect.begin(), expect.end());
+  string_sort(same.begin(), same.end());
+  REQUIRE(same == expect);
+}
+
+TEST_CASE("String sort Very long shared prefix") {
+  // 8バイト毎に再帰すると1MBの接頭辞でスタックが溢れる
+  std::mt19937 rng(3);
+  const std::string prefix(std::size_t(4) << 20, 'q');
+  std::vector<std::string> v;
+  for (int i = 0; i < 40; i++) {
+    v.push_back(prefix + std::to_string(rng() % 1000));
+  }
+  v.push_back(prefix);
+  v.push_back(prefix.substr(0, prefix.size() - 3));
+  auto expect = v;
+  std::sort(expect.begin(), expect.end());
+  string_sort(v.begin(), v.end());
+  REQUIRE(v == expect);
+}
+
+TEST_CASE("String sort Test with string views") {
+  std::mt19937 rng(43);
+  const auto storage = make_urls(20000, rng);
+  std::vector<std::string_view> sv(storage.begin(), storage.end());
+  std::vector<boost::beast::string_view> bv;
+  for (const auto &s : storage) {
+    bv.emplace_back(s.data(), s.size());
+  }
+  auto expect = storage;
+  std::sort(expect.begin(), expect.end());
+  string_sort(sv.begin(), sv.end());
+  string_sort(bv.begin(), bv.end());
+  for (std::size_t i = 0; i < expect.size(); i++) {
+    REQUIRE(sv[i] == expect[i]);
+    REQUIRE(std::string(bv[i].data(), bv[i].size()) == expect[i]);
+  }
+}
@@ -1,4 +1,5 @@
 #include "experimental/network/utility.hpp"
+#include <vector>
 
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
@@ -18,3 +19,13 @@ TEST_CASE("Compile Time") {
     REQUIRE(net::encode(x) == std::make_pair(y, z));
   }
 }
+
+TEST_CASE("Bulk") {
+  const std::vector<std::uint8_t> bytes = {0xab, 0xcd, 0x01, 0x02, 0xff, 0x00};
+  std::vector<std::uint16_t> words(3);
+  net::decode(bytes, words);
+  REQUIRE(words == std::vector<std::uint16_t>{0xabcd, 0x0102, 0xff00});
+  std::vector<std::uint8_t> out(6);
+  net::encode(words, out);
+  REQUIRE(out == bytes);
+}
@@ -0,0 +1,197 @@
+#include "random/xorshift.hpp"
+#include "random/xorshift_batch.hpp"
+#include <cmath>
+#include <set>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+namespace {
+
+/**< @brief draw n values from every generator of g */
+std::vector<std::uint64_t> draw(xorshift &g, std::size_t n) {
+  std::vector<std::uint64_t> r;
+  for (std::size_t i = 0; i < n; i++) {
+    r.push_back(g.xorshift128());
+    r.push_back(g.xorshift64star());
+    r.push_back(g.xorshift1024star());
+    r.push_back(g.xorshift128plus());
+  }
+  return r;
+}
+
+} // namespace
+
+TEST_CASE("Jump") {
+  SECTION("Commutes with stepping") {
+    // M^J * M^k == M^k * M^J holds only when the jump is a power of M
+    xorshift a(12345), b(12345);
+    a.jump();
+    draw(a, 37);
+    draw(b, 37);
+    b.jump();
+    REQUIRE(draw(a, 100) == draw(b, 100));
+
+    xorshift c(777), d(777);
+    c.long_jump();
+    draw(c, 21);
+    draw(d, 21);
+    d.long_jump();
+    REQUIRE(draw(c, 100) == draw(d, 100));
+  }
+  SECTION("Moves the state") {
+    xorshift a(1), b(1);
+    a.jump();
+    b.long_jump();
+    xorshift c(1);
+    const auto x = draw(a, 16), y = draw(b, 16), z = draw(c, 16);
+    REQUIRE(x != z);
+    REQUIRE(y != z);
+    REQUIRE(x != y);
+  }
+  SECTION("Known answers") {
+    // the first values after the jump, computed offline as M^(2^k) by squaring
+    // the GF(2) step matrix M k times (independently of the jump polynomials)
+    xorshift a(1), b(1);
+    a.jump();
+    REQUIRE(a.xorshift128() == 0x89943f03U);                // 2^64
+    REQUIRE(a.xorshift64star() == 0xd6fa3756179c3e99ULL);   // 2^32
+    REQUIRE(a.xorshift1024star() == 0x0791b7fef845aa32ULL); // 2^512
+    REQUIRE(a.xorshift128plus() == 0x7353ff0229c72754ULL);  // 2^64
+    b.long_jump();
+    REQUIRE(b.xorshift128() == 0x560f9656U);                // 2^96
+    REQUIRE(b.xorshift64star() == 0x7abbace866d5ccbcULL);   // 2^48
+    REQUIRE(b.xorshift1024star() == 0xac9c3e932550d75cULL); // 2^768
+    REQUIRE(b.xorshift128plus() == 0xaf5922ee851dc93bULL);  // 2^96
+  }
+  SECTION("Deterministic") {
+    xorshift a(42), b(42);
+    a.jump128plus();
+    b.jump128plus();
+    REQUIRE(a.xorshift128plus() == b.xorshift128plus());
+    REQUIRE(a.xorshift1024star() == b.xorshift1024star());
+  }
+}
+
+TEST_CASE("Stream factory") {
+  const xorshift::stream_factory factory(2024);
+  const auto rngs = factory.streams(8);
+  REQUIRE(rngs.size() == 8);
+
+  SECTION("Reproducible") {
+    for (std::size_t i = 0; i < rngs.size(); i++) {
+      auto a = rngs[i];
+      auto b = factory.stream(i);
+      auto c = xorshift::stream_factory(2024).stream(i);
+      const auto x = draw(a, 64);
+      REQUIRE(x == draw(b, 64));
+      REQUIRE(x == draw(c, 64));
+    }
+  }
+  SECTION("Stream 0 is the seeded generator") {
+    auto a = rngs[0];
+    xorshift b(2024);
+    REQUIRE(draw(a, 64) == draw(b, 64));
+  }
+  SECTION("Streams are distinct") {
+    std::set<std::vector<std::uint64_t>> seen;
+    for (auto g : rngs) {
+      seen.insert(draw(g, 16));
+    }
+    REQUIRE(seen.size() == rngs.size());
+  }
+  SECTION("Groups are distinct") {
+    auto a = xorshift::stream_factory(2024, 1).stream(0);
+    auto b = rngs[0];
+    auto c = rngs[1];
+    const auto x = draw(a, 16);
+    REQUIRE(x != draw(b, 16));
+    REQUIRE(x != draw(c, 16));
+  }
+}
+
+TEMPLATE_TEST_CASE("Batch fill", "", std::uint32_t, std::uint64_t, float,
+                   double) {
+  using T = TestType;
+
+  SECTION("Matches the scalar version") {
+    for (const std::size_t n : {0, 1, 7, 8, 9, 100, 1001}) {
+      std::array<std::uint64_t, 8> a0, a1;
+      xorshift g(99);
+      for (std::size_t k = 0; k < 8; k++) {
+        a0[k] = g.xorshift64star();
+        a1[k] = g.xorshift64star();
+      }
+      auto b0 = a0, b1 = a1;
+      std::vector<T> x(n), y(n);
+      xorshift_detail::fill<T, 8>(a0.data(), a1.data(), x.data(), n);
+      xorshift_detail::fill_scalar<T, 8>(b0.data(), b1.data(), y.data(), n);
+      REQUIRE(x == y);
+      REQUIRE(a0 == b0);
+      REQUIRE(a1 == b1);
+    }
+  }
+  SECTION("Reproducible across fill sizes") {
+    xorshift_batch<4> a(5), b(5);
+    std::vector<T> x(64), y(64);
+    a.fill(std::span(x));
+    b.fill(std::span(y).first(24));
+    b.fill(std::span(y).subspan(24));
+    REQUIRE(x == y);
+  }
+  SECTION("Range") {
+    xorshift_batch<4> a(7);
+    std::vector<T> x(10000);
+    a.fill(std::span(x));
+    if constexpr (std::is_floating_point_v<T>) {
+      double sum = 0;
+      for (const T v : x) {
+        REQUIRE(v >= T(0));
+        REQUIRE(v < T(1));
+        sum += v;
+      }
+      REQUIRE(std::abs(sum / x.size() - 0.5) < 0.02);
+    } else {
+      REQUIRE(std::set<T>(x.begin(), x.end()).size() == x.size());
+    }
+  }
+}
+
+TEST_CASE("Batch lanes") {
+  SECTION("Lane 0 is xorshift128plus()") {
+    xorshift g(31);
+    xorshift_batch<4> a(g);
+    std::vector<std::uint64_t> x(400);
+    a.fill(std::span(x));
+    for (std::size_t i = 0; i < x.size(); i += 4) {
+      REQUIRE(x[i] == g.xorshift128plus());
+    }
+  }
+  SECTION("Lanes are evenly spaced over 2^64 steps") {
+    // lane 2k of 8 lanes (k * 2^62 steps) == lane k of 4 lanes
+    xorshift_batch<4> a(31);
+    xorshift_batch<8> b(31);
+    std::vector<std::uint64_t> x(400), y(800);
+    a.fill(std::span(x));
+    b.fill(std::span(y));
+    for (std::size_t i = 0; i < 100; i++) {
+      for (std::size_t k = 0; k < 4; k++) {
+        REQUIRE(x[4 * i + k] == y[8 * i + 2 * k]);
+      }
+    }
+  }
+  SECTION("Conversions") {
+    xorshift_batch<4> a(3), b(3), c(3);
+    std::vector<std::uint64_t> x(20);
+    std::vector<std::uint32_t> y(20);
+    std::vector<double> z(20);
+    a.fill(std::span(x));
+    b.fill(std::span(y));
+    c.fill(std::span(z));
+    for (std::size_t i = 0; i < x.size(); i++) {
+      REQUIRE(y[i] == static_cast<std::uint32_t>(x[i] >> 32));
+      REQUIRE(z[i] == static_cast<double>(x[i] >> 12) * 0x1.0p-52);
+    }
+  }
+}